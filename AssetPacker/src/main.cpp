@@ -0,0 +1,332 @@
+#define SDL_MAIN_HANDLED
+#include "wf_pch.h"
+#include "wf_pack_format.h"
+#include "wf_assets.h"
+#include "wf_memory.h"
+#include "wf_vfs.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+//AssetPacker: packs every file below a directory into the .wpak archive of wf_pack_format.h
+//that Vfs memory maps at runtime, paths inside are relative to the directory
+//usage: AssetPacker [--force] directory output
+//       AssetPacker --check
+//--force    pack even if the output is newer than every input
+//--check    runs the asset registry and Vfs correctness checks instead, exit code 1 if one fails
+
+using namespace Wolf;
+
+struct PackInput
+{
+	std::string path;
+	std::string name;
+	u64 size;
+};
+
+static bool Collect(const char* directory, const std::string& output, std::vector<PackInput>& inputs, std::filesystem::file_time_type& newest)
+{
+	std::error_code error;
+	const std::filesystem::path root = std::filesystem::path(directory).lexically_normal();
+	const std::filesystem::path outputPath = std::filesystem::absolute(output, error).lexically_normal();
+	for (std::filesystem::recursive_directory_iterator it(root, error), end; !error && it != end; it.increment(error))
+	{
+		if (!it->is_regular_file(error)) continue;
+		const std::filesystem::path& path = it->path();
+		//a pack written inside the directory doesn't pack itself, nor half written files
+		if (std::filesystem::absolute(path, error).lexically_normal() == outputPath || path.extension() == ".tmp") continue;
+
+		PackInput input;
+		input.path = path.string();
+		input.name = path.lexically_relative(root).generic_string();
+		input.size = it->file_size(error);
+		if (error) break;
+		const auto time = it->last_write_time(error);
+		if (!error && time > newest) newest = time;
+		inputs.push_back(std::move(input));
+	}
+	if (error)
+	{
+		fprintf(stderr, "AssetPacker: can't read %s: %s\n", directory, error.message().c_str());
+		return false;
+	}
+	return true;
+}
+
+static bool WritePadding(FILE* file, u64 from, u64 to)
+{
+	static const u8 zeros[PACK_DATA_ALIGNMENT] = {};
+	return fwrite(zeros, 1, (size_t)(to - from), file) == to - from;
+}
+
+static bool Pack(const std::vector<PackInput>& inputs, const char* output)
+{
+	//the table is sorted by hash for the runtime's binary search, names by path for stable output
+	std::vector<PackEntry> entries(inputs.size());
+	std::string names;
+	for (size_t i = 0; i < inputs.size(); i++)
+	{
+		PackEntry& entry = entries[i];
+		entry.hash = HashPackPath(inputs[i].name.c_str(), inputs[i].name.size());
+		entry.size = inputs[i].size;
+		entry.nameOffset = (u32)names.size();
+		entry.nameLength = (u32)inputs[i].name.size();
+		names += inputs[i].name;
+	}
+
+	PackFileHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = PACK_FILE_MAGIC;
+	header.version = PACK_FILE_VERSION;
+	header.entryCount = (u32)entries.size();
+	header.namesOffset = sizeof(PackFileHeader) + entries.size() * sizeof(PackEntry);
+	header.namesSize = (u32)names.size();
+
+	//contents in path order, small files of a directory end up next to each other
+	u64 offset = header.namesOffset + header.namesSize;
+	for (PackEntry& entry : entries)
+	{
+		offset = Memory::alignUp(offset, PACK_DATA_ALIGNMENT);
+		entry.offset = offset;
+		offset += entry.size;
+	}
+	header.fileSize = offset;
+
+	std::vector<size_t> order(entries.size());
+	for (size_t i = 0; i < order.size(); i++)
+		order[i] = i;
+	std::sort(order.begin(), order.end(), [&entries](size_t a, size_t b) { return entries[a].hash < entries[b].hash; });
+	std::vector<PackEntry> table(entries.size());
+	for (size_t i = 0; i < order.size(); i++)
+		table[i] = entries[order[i]];
+	for (size_t i = 1; i < table.size(); i++)
+	{
+		if (table[i].hash == table[i - 1].hash)
+			printf("AssetPacker: %s and %s have the same hash, lookups compare the names\n", inputs[order[i - 1]].name.c_str(), inputs[order[i]].name.c_str());
+	}
+
+	//written next to the output and renamed over it, a mounted pack is never seen half written
+	const std::string temporary = std::string(output) + ".tmp";
+	FILE* file = fopen(temporary.c_str(), "wb");
+	if (!file)
+	{
+		fprintf(stderr, "AssetPacker: can't write %s\n", temporary.c_str());
+		return false;
+	}
+	bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+	written = written && (table.empty() || fwrite(table.data(), sizeof(PackEntry), table.size(), file) == table.size());
+	written = written && fwrite(names.data(), 1, names.size(), file) == names.size();
+
+	u64 position = header.namesOffset + header.namesSize;
+	std::vector<u8> buffer;
+	for (size_t i = 0; i < inputs.size() && written; i++)
+	{
+		written = WritePadding(file, position, entries[i].offset);
+		position = entries[i].offset;
+
+		FILE* input = fopen(inputs[i].path.c_str(), "rb");
+		if (!input)
+		{
+			fprintf(stderr, "AssetPacker: can't read %s\n", inputs[i].path.c_str());
+			written = false;
+			break;
+		}
+		buffer.resize((size_t)entries[i].size);
+		const bool read = fread(buffer.data(), 1, buffer.size(), input) == buffer.size();
+		fclose(input);
+		if (!read)
+		{
+			fprintf(stderr, "AssetPacker: %s changed while packing\n", inputs[i].path.c_str());
+			written = false;
+			break;
+		}
+		written = written && fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+		position += entries[i].size;
+	}
+	if (fclose(file) != 0 || !written)
+	{
+		fprintf(stderr, "AssetPacker: can't write %s\n", temporary.c_str());
+		remove(temporary.c_str());
+		return false;
+	}
+	std::error_code error;
+	std::filesystem::rename(temporary, output, error);
+	if (error)
+	{
+		fprintf(stderr, "AssetPacker: can't replace %s: %s\n", output, error.message().c_str());
+		remove(temporary.c_str());
+		return false;
+	}
+
+	printf("%s  %zu files  %.2f MB\n", output, inputs.size(), (f64)header.fileSize / (1024.0 * 1024.0));
+	return true;
+}
+
+//every load waits until the other streaming thread runs the other one, then loads it as a dependency
+static std::atomic<u32> cycleLoaders{ 0 };
+static void* LoadCycleAsset(AssetLoadContext& context, const char* path);
+static const AssetType CYCLE_ASSET = { "cycle", LoadCycleAsset, [](void* data) { delete (u32*)data; }, nullptr };
+
+static void* LoadCycleAsset(AssetLoadContext& context, const char* path)
+{
+	cycleLoaders.fetch_add(1);
+	const auto start = std::chrono::steady_clock::now();
+	while (cycleLoaders.load() < 2 && std::chrono::steady_clock::now() - start < std::chrono::seconds(2))
+		std::this_thread::yield();
+
+	const bool first = std::filesystem::path(path).filename() == "a";
+	if (!context.LoadDependency(CYCLE_ASSET, first ? "b" : "a")) return nullptr;
+	return new u32(first ? 1 : 2);
+}
+
+static bool CheckDependencyCycle()
+{
+	//a -> b on one streaming thread, b -> a on the other: the load that closes the cycle fails
+	//instead of waiting for the other forever, and the one waiting on it fails with it
+	AssetRegistry* assets = new AssetRegistry();
+	const AssetId a = assets->LoadAsync(CYCLE_ASSET, "a");
+	const AssetId b = assets->LoadAsync(CYCLE_ASSET, "b");
+	const auto start = std::chrono::steady_clock::now();
+	while (assets->GetPendingLoadCount() && std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+	{
+		assets->ApplyLoads();
+		std::this_thread::yield();
+	}
+	if (assets->GetPendingLoadCount())
+	{
+		//the streaming threads are stuck, the registry can't be destroyed
+		printf("%-32s FAIL (deadlocked)\n", "assets.cycle_across_threads");
+		return false;
+	}
+
+	const bool overlapped = cycleLoaders.load() >= 2;
+	const bool failed = assets->GetState(a) == AssetState::Failed && assets->GetState(b) == AssetState::Failed;
+	delete assets;
+	printf("%-32s %s (%s, %s)\n", "assets.cycle_across_threads", overlapped && failed ? "ok" : "FAIL",
+		overlapped ? "loaded on two threads" : "loads didn't overlap", failed ? "both failed" : "not both failed");
+	return overlapped && failed;
+}
+
+static bool WriteText(const std::filesystem::path& path, const char* text)
+{
+	FILE* file = fopen(path.string().c_str(), "wb");
+	if (!file) return false;
+	const bool written = fputs(text, file) >= 0;
+	return fclose(file) == 0 && written;
+}
+
+static bool PackDirectory(const std::filesystem::path& directory, const std::filesystem::path& output)
+{
+	std::vector<PackInput> inputs;
+	std::filesystem::file_time_type newest = std::filesystem::file_time_type::min();
+	if (!Collect(directory.string().c_str(), output.string(), inputs, newest)) return false;
+	std::sort(inputs.begin(), inputs.end(), [](const PackInput& a, const PackInput& b) { return a.name < b.name; });
+	return Pack(inputs, output.string().c_str());
+}
+
+static bool ViewEquals(const FileView& view, const char* text)
+{
+	return view.IsOpen() && view.GetSize() == strlen(text) && memcmp(view.GetData(), text, view.GetSize()) == 0;
+}
+
+static bool CheckAboveRoot(const std::filesystem::path& root)
+{
+	//.. can move around inside the mounts but never out of them
+	std::error_code error;
+	std::filesystem::create_directories(root / "data" / "sub", error);
+	bool ok = !error && WriteText(root / "data" / "a.txt", "inside") && WriteText(root / "outside.txt", "outside");
+	Vfs vfs;
+	ok = ok && vfs.MountDirectory((root / "data").string().c_str());
+	FileView view;
+	u32 wrong = 0;
+	wrong += !vfs.Open("sub/../a.txt", view) || !ViewEquals(view, "inside");
+	wrong += vfs.Open("../outside.txt", view) || vfs.Exists("../outside.txt");
+	wrong += vfs.Open("sub/../../outside.txt", view) || vfs.Exists("sub/../../outside.txt");
+	wrong += vfs.Open("..", view);
+	//a name starting with dots is a name
+	wrong += !WriteText(root / "data" / "..b", "dots") || !vfs.Open("..b", view) || !ViewEquals(view, "dots");
+	printf("%-32s %s (%u wrong)\n", "vfs.above_root", ok && !wrong ? "ok" : "FAIL", wrong);
+	return ok && !wrong;
+}
+
+static bool CheckRemapPack(const std::filesystem::path& root)
+{
+	//a repacked file is seen once the pack is remapped, views into the old mapping stay valid
+	std::error_code error;
+	std::filesystem::create_directories(root / "pack", error);
+	const std::filesystem::path pack = root / "test.wpak";
+	bool ok = !error && WriteText(root / "pack" / "a.txt", "old") && PackDirectory(root / "pack", pack);
+	Vfs vfs;
+	ok = ok && vfs.MountPack(pack.string().c_str());
+	FileView before;
+	FileView after;
+	u32 wrong = 0;
+	wrong += !vfs.Open("a.txt", before) || !ViewEquals(before, "old");
+	ok = ok && WriteText(root / "pack" / "a.txt", "new data") && PackDirectory(root / "pack", pack);
+	wrong += !vfs.RemapPack(pack.string().c_str());
+	wrong += !vfs.Open("a.txt", after) || !ViewEquals(after, "new data") || !ViewEquals(before, "old");
+	wrong += vfs.RemapPack((root / "pack" / "a.txt").string().c_str());
+	printf("%-32s %s (%u wrong)\n", "vfs.remap_pack", ok && !wrong ? "ok" : "FAIL", wrong);
+	return ok && !wrong;
+}
+
+static int RunChecks()
+{
+	std::error_code error;
+	const std::filesystem::path root = std::filesystem::temp_directory_path(error) / "wf_assetpacker_check";
+	std::filesystem::remove_all(root, error);
+
+	bool ok = CheckDependencyCycle();
+	ok &= CheckAboveRoot(root);
+	ok &= CheckRemapPack(root);
+	std::filesystem::remove_all(root, error);
+	return ok ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+	bool force = false;
+	const char* directory = nullptr;
+	const char* output = nullptr;
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--check")) return RunChecks();
+		if (!strcmp(argv[i], "--force")) force = true;
+		else if (!directory) directory = argv[i];
+		else if (!output) output = argv[i];
+		else
+		{
+			fprintf(stderr, "AssetPacker: unexpected argument %s\n", argv[i]);
+			return 1;
+		}
+	}
+	if (!directory || !output)
+	{
+		fprintf(stderr, "usage: AssetPacker [--force] directory output | AssetPacker --check\n");
+		return 1;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	std::vector<PackInput> inputs;
+	std::filesystem::file_time_type newest = std::filesystem::file_time_type::min();
+	if (!Collect(directory, output, inputs, newest)) return 1;
+	std::sort(inputs.begin(), inputs.end(), [](const PackInput& a, const PackInput& b) { return a.name < b.name; });
+
+	//a removed file doesn't make the pack older, use --force after deleting assets
+	std::error_code error;
+	const auto outputTime = std::filesystem::last_write_time(output, error);
+	if (!force && !error && outputTime >= newest)
+	{
+		printf("%s is up to date\n", output);
+		return 0;
+	}
+
+	if (!Pack(inputs, output)) return 1;
+	const f64 ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+	printf("packed in %.1f ms\n", ms);
+	return 0;
+}
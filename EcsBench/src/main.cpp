@@ -0,0 +1,945 @@
+#define SDL_MAIN_HANDLED
+#include "wf_pch.h"
+#include "wf_ecs.h"
+#include "wf_math.h"
+#include "wf_memory.h"
+#include "wf_profiler.h"
+#include "wf_transform.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+//EcsBench: iteration and structural change throughput of wf_ecs.h, TransformHierarchy updates
+//usage: EcsBench [--count N] [--reps N] [--threads N] [--filter substring] [--check]
+//timings are reported in ns per entity, setup work of a benchmark is not timed
+//--check runs the World, TransformHierarchy, JobSystem, profiler and memory budget correctness checks instead of timing, exit code 1 if one fails
+
+using namespace Wolf;
+
+struct Position { Vec3 value; };
+struct Velocity { Vec3 value; };
+struct Health { f32 value; };
+struct Tag { u32 value; };
+//not trivially copyable, moved with its move constructor
+struct Name { std::string value; };
+
+struct BenchConfig
+{
+	u32 count = 262144;
+	u32 reps = 15;
+	u32 threads = 0;
+	const char* filter = nullptr;
+	bool check = false;
+};
+
+static BenchConfig config;
+static volatile f32 sink;
+
+static f64 Percentile(const std::vector<f64>& sorted, f64 p)
+{
+	size_t i = (size_t)(p * sorted.size());
+	if (i >= sorted.size()) i = sorted.size() - 1;
+	return sorted[i];
+}
+
+//setup runs before every repetition and isn't timed
+template<typename S, typename F>
+static void Bench(const char* name, u32 count, S&& setup, F&& body)
+{
+	if (config.filter && !strstr(name, config.filter)) return;
+
+	typedef std::chrono::steady_clock Clock;
+
+	std::vector<f64> samples;
+	samples.reserve(config.reps);
+	//one untimed warmup
+	for (u32 r = 0; r < config.reps + 1; r++)
+	{
+		setup();
+		Clock::time_point start = Clock::now();
+		body();
+		const f64 ns = std::chrono::duration<f64, std::nano>(Clock::now() - start).count();
+		if (r > 0) samples.push_back(ns / count);
+	}
+	std::sort(samples.begin(), samples.end());
+
+	printf("%-32s %8u  min %8.3f  p50 %8.3f  p90 %8.3f ns/entity  %7.2f M/s\n",
+		name, count, samples.front(), Percentile(samples, 0.5), Percentile(samples, 0.9), 1000.0 / Percentile(samples, 0.5));
+}
+
+//reference for the iteration numbers: one heap object per entity reached through a pointer
+struct GameObject
+{
+	Vec3 position;
+	Vec3 velocity;
+	f32 health;
+	u8 padding[64];
+};
+
+static void Populate(World& world, std::vector<Entity>& entities, u32 count)
+{
+	std::mt19937 rng(count);
+	std::uniform_real_distribution<f32> dist(-1.0f, 1.0f);
+	entities.clear();
+	for (u32 i = 0; i < count; i++)
+	{
+		const Vec3 position(dist(rng), dist(rng), dist(rng));
+		const Vec3 velocity(dist(rng), dist(rng), dist(rng));
+		//a few archetypes so queries have to match more than one
+		switch (i & 3)
+		{
+		case 0: entities.push_back(world.Create(Position{ position }, Velocity{ velocity })); break;
+		case 1: entities.push_back(world.Create(Position{ position }, Velocity{ velocity }, Health{ 100.0f })); break;
+		case 2: entities.push_back(world.Create(Position{ position }, Velocity{ velocity }, Tag{ i })); break;
+		default: entities.push_back(world.Create(Position{ position }, Velocity{ velocity }, Health{ 100.0f }, Tag{ i })); break;
+		}
+	}
+}
+
+//count nodes under count / 64 roots, each one the child of a random earlier node
+static void BuildHierarchy(TransformHierarchy& hierarchy, std::vector<TransformId>& ids, u32 count, u32 seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<f32> dist(-1.0f, 1.0f);
+	const u32 roots = count / 64 ? count / 64 : 1;
+	ids.clear();
+	for (u32 i = 0; i < count; i++)
+	{
+		ids.push_back(hierarchy.Create(i < roots ? TransformId::Null() : ids[rng() % i]));
+		const Vec3 axis = Vec3(dist(rng), dist(rng), dist(rng) + 2.0f).normalized();
+		hierarchy.SetLocal(ids.back(), Vec3(dist(rng), dist(rng), dist(rng)) * 10.0f, Quaternion(axis, dist(rng) * PI),
+			Vec3(1.0f + 0.5f * dist(rng), 1.0f + 0.5f * dist(rng), 1.0f + 0.5f * dist(rng)));
+	}
+}
+
+static void RunAll(JobSystem& jobs)
+{
+	const u32 count = config.count;
+	const f32 dt = 1.0f / 60.0f;
+	auto noSetup = []() {};
+
+	{
+		std::mt19937 rng(count);
+		std::vector<std::unique_ptr<GameObject>> storage;
+		std::vector<GameObject*> objects;
+		for (u32 i = 0; i < count; i++)
+		{
+			storage.emplace_back(new GameObject());
+			storage.back()->velocity = Vec3(0.1f, 0.2f, 0.3f);
+		}
+		//allocation order isn't update order in a real game
+		for (auto& object : storage) objects.push_back(object.get());
+		std::shuffle(objects.begin(), objects.end(), rng);
+
+		Bench("baseline.pointers", count, noSetup, [&]() {
+			for (GameObject* object : objects)
+				object->position += object->velocity * dt;
+			sink = objects[0]->position.x;
+		});
+	}
+
+	World world;
+	std::vector<Entity> entities;
+	Populate(world, entities, count);
+	printf("%u entities, %u archetypes, %u chunks\n", world.GetEntityCount(), world.GetArchetypeCount(), world.GetChunkCount());
+
+	Bench("iterate.position_velocity", count, noSetup, [&]() {
+		world.Each<Position, Velocity>([dt](Entity, Position& position, Velocity& velocity) {
+			position.value += velocity.value * dt;
+		});
+	});
+
+	Bench("iterate.health", count / 2, noSetup, [&]() {
+		world.Each<Health>([](Entity, Health& health) { health.value -= 0.5f; });
+	});
+
+	Bench("iterate.parallel", count, noSetup, [&]() {
+		world.ParallelEach<Position, Velocity>(jobs, [dt](Entity, Position& position, Velocity& velocity) {
+			position.value += velocity.value * dt;
+		});
+	});
+
+	Bench("get.random", count, noSetup, [&]() {
+		f32 sum = 0.0f;
+		for (u32 i = 0; i < count; i++)
+			sum += world.Get<Position>(entities[(i * 7919) % count])->value.x;
+		sink = sum;
+	});
+
+	//add/remove move the entity between archetypes, the add is measured after a remove and the other way around
+	Bench("structural.add", count, [&]() {
+		for (Entity entity : entities) world.Remove<Health>(entity);
+	}, [&]() {
+		for (Entity entity : entities) world.Add(entity, Health{ 50.0f });
+	});
+
+	Bench("structural.remove", count, [&]() {
+		for (Entity entity : entities) world.Add(entity, Health{ 50.0f });
+	}, [&]() {
+		for (Entity entity : entities) world.Remove<Health>(entity);
+	});
+
+	CommandBuffer commands;
+	Bench("commands.add_playback", count, [&]() {
+		for (Entity entity : entities) world.Remove<Health>(entity);
+		for (Entity entity : entities) commands.Add(entity, Health{ 50.0f });
+	}, [&]() {
+		world.Playback(commands);
+	});
+
+	Bench("churn.destroy_create", count, noSetup, [&]() {
+		for (u32 i = 0; i < count; i++)
+		{
+			world.Destroy(entities[i]);
+			entities[i] = world.Create(Position{ Vec3(0.0f, 0.0f, 0.0f) }, Velocity{ Vec3(1.0f, 0.0f, 0.0f) });
+		}
+	});
+
+	TransformHierarchy hierarchy;
+	std::vector<TransformId> nodes;
+	BuildHierarchy(hierarchy, nodes, count, count);
+	hierarchy.Update();
+	printf("%u transforms, %u levels\n", hierarchy.GetCount(), hierarchy.GetLevelCount());
+
+	//every root moved, the whole hierarchy is recomputed
+	const u32 roots = count / 64 ? count / 64 : 1;
+	auto moveRoots = [&]() {
+		for (u32 i = 0; i < roots; i++)
+			hierarchy.SetLocalPosition(nodes[i], hierarchy.GetLocalPosition(nodes[i]) + Vec3(0.01f, 0.0f, 0.0f));
+	};
+	Bench("transform.update_all", count, moveRoots, [&]() { hierarchy.Update(); });
+	Bench("transform.update_all_parallel", count, moveRoots, [&]() { hierarchy.Update(jobs); });
+
+	//1 in 64 nodes moved, their subtrees follow
+	auto moveSome = [&]() {
+		for (u32 i = 0; i < count; i += 64)
+			hierarchy.SetLocalPosition(nodes[(i * 7919) % count], Vec3((f32)i, 0.0f, 0.0f));
+	};
+	Bench("transform.update_sparse", count, moveSome, [&]() { hierarchy.Update(); });
+	Bench("transform.update_sparse_parallel", count, moveSome, [&]() { hierarchy.Update(jobs); });
+}
+
+struct CheckJob
+{
+	std::atomic<u32>* runs;
+	u32 index;
+
+	static void Execute(void* data)
+	{
+		CheckJob* job = (CheckJob*)data;
+		job->runs[job->index].fetch_add(1, std::memory_order_relaxed);
+	}
+};
+
+//keeps the only worker busy so the main thread's deque and job slots fill up
+struct BlockerJob
+{
+	std::atomic<bool> started{ false };
+	std::atomic<bool> release{ false };
+
+	static void Execute(void* data)
+	{
+		BlockerJob* blocker = (BlockerJob*)data;
+		blocker->started.store(true);
+		while (!blocker->release.load())
+			std::this_thread::yield();
+	}
+};
+
+static u32 CountWrongRuns(const std::vector<std::atomic<u32>>& runs)
+{
+	u32 wrong = 0;
+	for (const std::atomic<u32>& run : runs)
+		wrong += run.load() != 1;
+	return wrong;
+}
+
+//what the World should hold, checked against it after every operation
+struct ReferenceEntity
+{
+	Entity entity;
+	u32 mask;
+	Vec3 position;
+	f32 health;
+	u32 tag;
+	std::string name;
+};
+
+enum ReferenceComponent : u32
+{
+	REF_POSITION = 1 << 0,
+	REF_HEALTH = 1 << 1,
+	REF_TAG = 1 << 2,
+	REF_NAME = 1 << 3,
+};
+
+static u64 EntityKey(Entity entity)
+{
+	return ((u64)entity.index << 32) | entity.generation;
+}
+
+template<typename T, typename V>
+static u32 CompareComponent(World& world, const ReferenceEntity& reference, u32 bit, V T::* member, const V& expected)
+{
+	const T* component = world.Get<T>(reference.entity);
+	if (world.Has<T>(reference.entity) != ((reference.mask & bit) != 0)) return 1;
+	if ((component != nullptr) != ((reference.mask & bit) != 0)) return 1;
+	return component && !(component->*member == expected);
+}
+
+//Each has to visit the component Get returns, a stale record or entity array after a swap back shows here
+template<typename T>
+static u32 CompareEach(World& world, const std::vector<ReferenceEntity>& live, u32 bit)
+{
+	u32 wrong = 0;
+	u32 visited = 0;
+	world.Each<T>([&](Entity entity, T& component) {
+		visited++;
+		wrong += world.Get<T>(entity) != &component;
+	});
+	u32 expected = 0;
+	for (const ReferenceEntity& reference : live)
+		expected += (reference.mask & bit) != 0;
+	return wrong + (visited != expected);
+}
+
+static u32 CompareWorld(World& world, const std::vector<ReferenceEntity>& live, const std::vector<Entity>& dead, std::mt19937& rng)
+{
+	u32 wrong = world.GetEntityCount() != (u32)live.size();
+	for (const ReferenceEntity& reference : live)
+	{
+		if (!world.IsAlive(reference.entity))
+		{
+			wrong++;
+			continue;
+		}
+		wrong += CompareComponent(world, reference, REF_POSITION, &Position::value, reference.position);
+		wrong += CompareComponent(world, reference, REF_HEALTH, &Health::value, reference.health);
+		wrong += CompareComponent(world, reference, REF_TAG, &Tag::value, reference.tag);
+		wrong += CompareComponent(world, reference, REF_NAME, &Name::value, reference.name);
+	}
+	wrong += CompareEach<Position>(world, live, REF_POSITION);
+	wrong += CompareEach<Health>(world, live, REF_HEALTH);
+	wrong += CompareEach<Tag>(world, live, REF_TAG);
+	wrong += CompareEach<Name>(world, live, REF_NAME);
+	//stale handles stay dead even when their index is in use again
+	for (u32 i = 0; i < 32 && !dead.empty(); i++)
+	{
+		const Entity entity = dead[rng() % dead.size()];
+		wrong += world.IsAlive(entity) || world.Get<Position>(entity) != nullptr;
+	}
+	return wrong;
+}
+
+static void AddReference(std::vector<ReferenceEntity>& live, std::unordered_set<u64>& deadKeys, Entity entity, u32& wrong)
+{
+	//a reused index comes back with a new generation
+	wrong += entity.IsNull() || deadKeys.count(EntityKey(entity)) != 0;
+	live.push_back(ReferenceEntity{ entity, 0, Vec3(0.0f, 0.0f, 0.0f), 0.0f, 0, std::string() });
+}
+
+static void KillReference(std::vector<ReferenceEntity>& live, u32 i, std::vector<Entity>& dead, std::unordered_set<u64>& deadKeys)
+{
+	dead.push_back(live[i].entity);
+	deadKeys.insert(EntityKey(live[i].entity));
+	live[i] = std::move(live.back());
+	live.pop_back();
+}
+
+//random creates, destroys, adds and removes, directly and through a CommandBuffer, on a few
+//thousand entities so archetypes span several chunks and swap back crosses chunks
+static bool CheckWorldRandomOps()
+{
+	const u32 steps = 20000;
+	const u32 population = 3000;
+	std::mt19937 rng(777);
+	std::uniform_real_distribution<f32> dist(-100.0f, 100.0f);
+
+	World world;
+	CommandBuffer commands;
+	std::vector<ReferenceEntity> live;
+	std::vector<Entity> dead;
+	std::unordered_set<u64> deadKeys;
+	u32 nextTag = 1;
+	u32 wrong = 0;
+	u32 failedStep = 0;
+
+	for (u32 step = 0; step < steps; step++)
+	{
+		const u32 op = rng() % 16;
+		//below half the population destroys turn into creates, then it hovers under the population
+		const bool create = op < 4 ? live.size() < population : op < 6 && live.size() < population / 2;
+		if (live.empty() || create)
+		{
+			const Vec3 position(dist(rng), dist(rng), dist(rng));
+			const Entity entity = (rng() & 1) ? world.Create(Position{ position }, Tag{ nextTag }) : world.Create();
+			AddReference(live, deadKeys, entity, wrong);
+			if (world.Has<Position>(entity))
+			{
+				live.back().mask = REF_POSITION | REF_TAG;
+				live.back().position = position;
+				live.back().tag = nextTag;
+			}
+			nextTag++;
+		}
+		else if (op < 6)
+		{
+			const u32 i = rng() % live.size();
+			world.Destroy(live[i].entity);
+			KillReference(live, i, dead, deadKeys);
+		}
+		else if (op < 10)
+		{
+			ReferenceEntity& reference = live[rng() % live.size()];
+			switch (rng() % 4)
+			{
+			case 0: reference.position = Vec3(dist(rng), dist(rng), dist(rng)); world.Add(reference.entity, Position{ reference.position }); reference.mask |= REF_POSITION; break;
+			case 1: reference.health = dist(rng); world.Add(reference.entity, Health{ reference.health }); reference.mask |= REF_HEALTH; break;
+			case 2: reference.tag = nextTag++; world.Add(reference.entity, Tag{ reference.tag }); reference.mask |= REF_TAG; break;
+			default: reference.name = "entity " + std::to_string(step); world.Add(reference.entity, Name{ reference.name }); reference.mask |= REF_NAME; break;
+			}
+		}
+		else if (op < 13)
+		{
+			ReferenceEntity& reference = live[rng() % live.size()];
+			switch (rng() % 4)
+			{
+			case 0: world.Remove<Position>(reference.entity); reference.mask &= ~REF_POSITION; break;
+			case 1: world.Remove<Health>(reference.entity); reference.mask &= ~REF_HEALTH; break;
+			case 2: world.Remove<Tag>(reference.entity); reference.mask &= ~REF_TAG; break;
+			default: world.Remove<Name>(reference.entity); reference.mask &= ~REF_NAME; break;
+			}
+		}
+		else
+		{
+			//each entity touched once per buffer, the buffer's creates are found by their tag afterwards
+			std::unordered_set<u32> touched;
+			std::vector<u32> destroyed;
+			std::unordered_set<u32> createdTags;
+			const u32 count = 1 + rng() % 8;
+			for (u32 c = 0; c < count; c++)
+			{
+				const u32 i = rng() % live.size();
+				if (!touched.insert(i).second) continue;
+				ReferenceEntity& reference = live[i];
+				switch (rng() % 5)
+				{
+				case 0: commands.Destroy(reference.entity); destroyed.push_back(i); break;
+				case 1: reference.health = dist(rng); commands.Add(reference.entity, Health{ reference.health }); reference.mask |= REF_HEALTH; break;
+				case 2: reference.tag = nextTag++; commands.Add(reference.entity, Tag{ reference.tag }); reference.mask |= REF_TAG; break;
+				case 3: commands.Remove<Position>(reference.entity); reference.mask &= ~REF_POSITION; break;
+				default: commands.Remove<Health>(reference.entity); reference.mask &= ~REF_HEALTH; break;
+				}
+				if (rng() % 3 == 0)
+				{
+					createdTags.insert(nextTag);
+					commands.Create(Position{ Vec3((f32)nextTag, 0.0f, 0.0f) }, Tag{ nextTag });
+					nextTag++;
+				}
+			}
+			world.Playback(commands);
+			wrong += !commands.IsEmpty();
+
+			std::sort(destroyed.begin(), destroyed.end());
+			for (u32 d = (u32)destroyed.size(); d-- > 0;)
+				KillReference(live, destroyed[d], dead, deadKeys);
+			world.Each<Tag>([&](Entity entity, Tag& tag) {
+				if (!createdTags.erase(tag.value)) return;
+				AddReference(live, deadKeys, entity, wrong);
+				live.back().mask = REF_POSITION | REF_TAG;
+				live.back().position = Vec3((f32)tag.value, 0.0f, 0.0f);
+				live.back().tag = tag.value;
+			});
+			wrong += (u32)createdTags.size();
+		}
+
+		wrong += CompareWorld(world, live, dead, rng);
+		if (wrong)
+		{
+			failedStep = step;
+			break;
+		}
+	}
+
+	printf("%-32s %s (%u wrong, %u live, %u destroyed, %u chunks", "world.random_ops", wrong ? "FAIL" : "ok",
+		wrong, (u32)live.size(), (u32)dead.size(), world.GetChunkCount());
+	if (wrong) printf(", first at step %u", failedStep);
+	printf(")\n");
+	return wrong == 0;
+}
+
+//float world matrices 14 levels deep against the double precision reference
+static const f64 TRANSFORM_ERROR_BOUND = 5e-5;
+
+//world matrices from the local transforms and the parents the hierarchy reports, in double precision
+static f64 CompareWorldMatrices(const TransformHierarchy& hierarchy, const std::vector<TransformId>& ids)
+{
+	std::vector<std::array<f64, 16>> references(ids.size());
+	std::vector<u8> done(ids.size(), 0);
+	std::vector<u32> indexOf;
+	for (u32 i = 0; i < (u32)ids.size(); i++)
+	{
+		if (ids[i].index >= indexOf.size()) indexOf.resize(ids[i].index + 1, 0);
+		indexOf[ids[i].index] = i;
+	}
+
+	f64 error = 0.0;
+	std::vector<u32> chain;
+	for (u32 i = 0; i < (u32)ids.size(); i++)
+	{
+		//walk up to the first computed ancestor, then down again
+		chain.clear();
+		for (u32 node = i; !done[node];)
+		{
+			chain.push_back(node);
+			const TransformId parent = hierarchy.GetParent(ids[node]);
+			if (parent.IsNull()) break;
+			node = indexOf[parent.index];
+		}
+		for (u32 c = (u32)chain.size(); c-- > 0;)
+		{
+			const u32 node = chain[c];
+			const Quaternion& rotation = hierarchy.GetLocalRotation(ids[node]);
+			const Vec3& scale = hierarchy.GetLocalScale(ids[node]);
+			const Vec3 rows[3] = { rotation.right() * scale.x, rotation.up() * scale.y, rotation.forward() * scale.z };
+			const Vec3& position = hierarchy.GetLocalPosition(ids[node]);
+			f64 local[16] = {};
+			for (u32 r = 0; r < 3; r++)
+				for (u32 k = 0; k < 3; k++)
+					local[r * 4 + k] = rows[r].values[k];
+			local[12] = position.x; local[13] = position.y; local[14] = position.z; local[15] = 1.0;
+
+			const TransformId parent = hierarchy.GetParent(ids[node]);
+			std::array<f64, 16>& world = references[node];
+			if (parent.IsNull())
+				std::copy(local, local + 16, world.begin());
+			else
+			{
+				const std::array<f64, 16>& parentWorld = references[indexOf[parent.index]];
+				for (u32 r = 0; r < 4; r++)
+					for (u32 k = 0; k < 4; k++)
+						world[r * 4 + k] = local[r * 4 + 0] * parentWorld[k] + local[r * 4 + 1] * parentWorld[4 + k] +
+							local[r * 4 + 2] * parentWorld[8 + k] + local[r * 4 + 3] * parentWorld[12 + k];
+			}
+			done[node] = 1;
+		}
+
+		const Mat44f& actual = hierarchy.GetWorldMatrix(ids[i]);
+		for (u32 j = 0; j < 16; j++)
+			error = std::max(error, fabs(actual.values[j] - references[i][j]) / std::max(1.0, fabs(references[i][j])));
+	}
+	return error;
+}
+
+static u32 SubtreeSize(const TransformHierarchy& hierarchy, const std::vector<TransformId>& ids, TransformId root)
+{
+	u32 size = 0;
+	for (TransformId id : ids)
+	{
+		for (TransformId node = id; !node.IsNull(); node = hierarchy.GetParent(node))
+		{
+			if (node != root) continue;
+			size++;
+			break;
+		}
+	}
+	return size;
+}
+
+static u32 NodeDepth(const TransformHierarchy& hierarchy, TransformId node)
+{
+	u32 depth = 0;
+	for (TransformId parent = hierarchy.GetParent(node); !parent.IsNull(); parent = hierarchy.GetParent(parent))
+		depth++;
+	return depth;
+}
+
+static bool CheckTransformDirty()
+{
+	//moving one inner node recomputes exactly its subtree, and only that changes
+	TransformHierarchy hierarchy;
+	std::vector<TransformId> ids;
+	BuildHierarchy(hierarchy, ids, 4096, 11);
+	hierarchy.Update();
+	const u32 initialUpdate = hierarchy.GetLastUpdateCount();
+	hierarchy.Update();
+	const u32 idleUpdate = hierarchy.GetLastUpdateCount();
+
+	//the inner node with the largest subtree under a root
+	TransformId moved = TransformId::Null();
+	u32 movedSize = 0;
+	for (TransformId id : ids)
+	{
+		if (NodeDepth(hierarchy, id) != 1) continue;
+		const u32 size = SubtreeSize(hierarchy, ids, id);
+		if (size > movedSize) { moved = id; movedSize = size; }
+	}
+
+	std::vector<Mat44f> before;
+	for (TransformId id : ids) before.push_back(hierarchy.GetWorldMatrix(id));
+	hierarchy.SetLocalPosition(moved, hierarchy.GetLocalPosition(moved) + Vec3(5.0f, -3.0f, 1.0f));
+	hierarchy.Update();
+	const u32 movedUpdate = hierarchy.GetLastUpdateCount();
+
+	u32 wrongChanged = 0;
+	for (u32 i = 0; i < (u32)ids.size(); i++)
+	{
+		const bool inSubtree = SubtreeSize(hierarchy, { ids[i] }, moved) == 1;
+		const bool changed = memcmp(&before[i], &hierarchy.GetWorldMatrix(ids[i]), sizeof(Mat44f)) != 0;
+		wrongChanged += inSubtree != changed;
+	}
+	const f64 error = CompareWorldMatrices(hierarchy, ids);
+
+	const bool ok = initialUpdate == ids.size() && idleUpdate == 0 && movedUpdate == movedSize && movedSize > 1 && wrongChanged == 0 && error < TRANSFORM_ERROR_BOUND;
+	printf("%-32s %s (%u of %u subtree nodes updated, %u wrong, error %.2e)\n", "transform.dirty_propagation", ok ? "ok" : "FAIL",
+		movedUpdate, movedSize, wrongChanged, error);
+	return ok;
+}
+
+static bool CheckTransformReparent()
+{
+	//deep subtrees moved under roots and roots moved under deep leaves change the depth of every node below
+	TransformHierarchy hierarchy;
+	std::vector<TransformId> ids;
+	BuildHierarchy(hierarchy, ids, 2048, 12);
+	hierarchy.Update();
+	std::mt19937 rng(12);
+
+	u32 wrong = 0;
+	u32 depthChanges = 0;
+	for (u32 round = 0; round < 64; round++)
+	{
+		const TransformId node = ids[rng() % ids.size()];
+		const TransformId parent = (round & 1) ? TransformId::Null() : ids[rng() % ids.size()];
+		const bool cycle = !parent.IsNull() && (parent == node || SubtreeSize(hierarchy, { parent }, node) == 1);
+		const u32 depth = NodeDepth(hierarchy, node);
+		//a parent inside the node's own subtree is refused
+		if (hierarchy.SetParent(node, parent) == cycle)
+		{
+			wrong++;
+			continue;
+		}
+		if (cycle) continue;
+		wrong += hierarchy.GetParent(node) != parent;
+		depthChanges += NodeDepth(hierarchy, node) != depth;
+		hierarchy.Update();
+		wrong += CompareWorldMatrices(hierarchy, ids) >= TRANSFORM_ERROR_BOUND;
+	}
+
+	const bool ok = wrong == 0 && depthChanges > 0;
+	printf("%-32s %s (%u wrong, %u depth changes, %u levels)\n", "transform.reparent", ok ? "ok" : "FAIL", wrong, depthChanges, hierarchy.GetLevelCount());
+	return ok;
+}
+
+static bool CheckTransformParallel()
+{
+	//the same edits on two hierarchies, one updated on the calling thread and one over the jobs
+	JobSystem jobs;
+	jobs.StartUp(4);
+	TransformHierarchy serial;
+	TransformHierarchy parallel;
+	std::vector<TransformId> serialIds;
+	std::vector<TransformId> parallelIds;
+	const u32 count = 32768;
+	BuildHierarchy(serial, serialIds, count, 13);
+	BuildHierarchy(parallel, parallelIds, count, 13);
+
+	std::mt19937 rng(13);
+	std::uniform_real_distribution<f32> dist(-10.0f, 10.0f);
+	u32 wrong = 0;
+	f64 error = 0.0;
+	for (u32 frame = 0; frame < 32; frame++)
+	{
+		//from a few nodes to most of them, so both the list and the sweep paths run
+		const u32 edits = 1u << (frame % 16);
+		for (u32 e = 0; e < edits; e++)
+		{
+			const u32 i = rng() % count;
+			const Vec3 position(dist(rng), dist(rng), dist(rng));
+			serial.SetLocalPosition(serialIds[i], position);
+			parallel.SetLocalPosition(parallelIds[i], position);
+		}
+		if (frame % 8 == 7)
+		{
+			const u32 node = rng() % count;
+			const u32 parent = rng() % count;
+			serial.SetParent(serialIds[node], serialIds[parent]);
+			parallel.SetParent(parallelIds[node], parallelIds[parent]);
+		}
+		serial.Update();
+		parallel.Update(jobs);
+		wrong += serial.GetLastUpdateCount() != parallel.GetLastUpdateCount();
+		for (u32 i = 0; i < count; i++)
+			wrong += memcmp(&serial.GetWorldMatrix(serialIds[i]), &parallel.GetWorldMatrix(parallelIds[i]), sizeof(Mat44f)) != 0;
+		error = std::max(error, CompareWorldMatrices(parallel, parallelIds));
+	}
+	jobs.ShutDown();
+
+	const bool ok = wrong == 0 && error < TRANSFORM_ERROR_BOUND;
+	printf("%-32s %s (%u matrices differ, error %.2e)\n", "transform.parallel_matches_serial", ok ? "ok" : "FAIL", wrong, error);
+	return ok;
+}
+
+static bool CheckJobsRunOnce()
+{
+	//more jobs than a thread has slots, the ones past that run inline but every job runs once
+	JobSystem jobs;
+	jobs.StartUp(1);
+	BlockerJob blocker;
+	JobCounter blockerCounter;
+	jobs.Run(&BlockerJob::Execute, &blocker, &blockerCounter);
+	while (!blocker.started.load())
+		std::this_thread::yield();
+
+	const u32 count = JobSystem::JOBS_PER_THREAD * 3;
+	std::vector<std::atomic<u32>> runs(count);
+	std::vector<CheckJob> data(count);
+	JobCounter counter;
+	for (u32 i = 0; i < count; i++)
+	{
+		data[i] = CheckJob{ runs.data(), i };
+		jobs.Run(&CheckJob::Execute, &data[i], &counter);
+	}
+	blocker.release.store(true);
+	jobs.Wait(counter);
+	jobs.Wait(blockerCounter);
+	jobs.ShutDown();
+
+	const u32 wrong = CountWrongRuns(runs);
+	printf("%-32s %s (%u of %u jobs didn't run exactly once)\n", "jobs.more_than_capacity", wrong ? "FAIL" : "ok", wrong, count);
+	return wrong == 0;
+}
+
+struct OtherSystemJob
+{
+	JobSystem* own;
+	JobSystem* other;
+	std::atomic<u32>* runs;
+	std::atomic<u32>* wrongIndex;
+
+	static void Execute(void* data)
+	{
+		OtherSystemJob* job = (OtherSystemJob*)data;
+		//the main thread is 0 in both systems, a worker of one is a foreign thread for the other
+		const s32 index = job->own->GetThreadIndex();
+		if (index < 0 || job->other->GetThreadIndex() != (index == 0 ? 0 : -1)) job->wrongIndex->fetch_add(1);
+		CheckJob check{ job->runs, 0 };
+		JobCounter counter;
+		job->other->Run(&CheckJob::Execute, &check, &counter);
+		job->other->Wait(counter);
+	}
+};
+
+static bool CheckTwoSystems()
+{
+	JobSystem first;
+	JobSystem second;
+	first.StartUp(2);
+	second.StartUp(2);
+	u32 wrongIndex = first.GetThreadIndex() != 0 || second.GetThreadIndex() != 0;
+
+	//both systems fed from the main thread
+	const u32 count = 20000;
+	std::vector<std::atomic<u32>> runs(count * 2);
+	std::vector<CheckJob> data(count * 2);
+	JobCounter firstCounter;
+	JobCounter secondCounter;
+	for (u32 i = 0; i < count * 2; i++)
+	{
+		data[i] = CheckJob{ runs.data(), i };
+		if (i & 1) second.Run(&CheckJob::Execute, &data[i], &secondCounter);
+		else first.Run(&CheckJob::Execute, &data[i], &firstCounter);
+	}
+	first.Wait(firstCounter);
+	second.Wait(secondCounter);
+
+	//a job of the first system using the second one
+	std::atomic<u32> nestedRuns{ 0 };
+	std::atomic<u32> nestedWrongIndex{ 0 };
+	OtherSystemJob nested{ &first, &second, &nestedRuns, &nestedWrongIndex };
+	JobCounter nestedCounter;
+	first.Run(&OtherSystemJob::Execute, &nested, &nestedCounter);
+	first.Wait(nestedCounter);
+	wrongIndex += nestedRuns.load() != 1;
+	second.ShutDown();
+	first.ShutDown();
+
+	const u32 wrong = CountWrongRuns(runs) + wrongIndex + nestedWrongIndex.load();
+	printf("%-32s %s (%u wrong runs or thread indices)\n", "jobs.two_systems", wrong ? "FAIL" : "ok", wrong);
+	return wrong == 0;
+}
+
+static bool CheckRunAfterFull()
+{
+	//RunAfter past MAX_CONTINUATIONS fails right away instead of waiting for the dependency
+	JobSystem jobs;
+	jobs.StartUp(1);
+	BlockerJob blocker;
+	JobCounter dependency;
+	jobs.Run(&BlockerJob::Execute, &blocker, &dependency);
+
+	const u32 count = JobSystem::MAX_CONTINUATIONS + 16;
+	std::vector<std::atomic<u32>> runs(count);
+	std::vector<CheckJob> data(count);
+	JobCounter counter;
+	u32 queued = 0;
+	u32 wrong = 0;
+	for (u32 i = 0; i < count; i++)
+	{
+		data[i] = CheckJob{ runs.data(), i };
+		if (jobs.RunAfter(dependency, Job{ &CheckJob::Execute, &data[i], nullptr }, &counter)) queued++;
+		else data[i].Execute(&data[i]);
+	}
+	//still blocked, so nothing waited for it
+	wrong += blocker.release.load() || dependency.IsDone();
+	blocker.release.store(true);
+	jobs.Wait(counter);
+	jobs.Wait(dependency);
+	jobs.ShutDown();
+
+	wrong += CountWrongRuns(runs) + (queued != JobSystem::MAX_CONTINUATIONS);
+	printf("%-32s %s (%u queued of %u, %u wrong)\n", "jobs.run_after_full", wrong ? "FAIL" : "ok", queued, count, wrong);
+	return wrong == 0;
+}
+
+//the budget warning has to reach the log in builds that keep WF_LOGWARNING
+static bool CheckMemoryBudget()
+{
+	std::error_code error;
+	const std::filesystem::path logPath = std::filesystem::temp_directory_path(error) / "wf_ecsbench_check.log";
+	const std::string logName = logPath.string();
+	LoggerConfig logConfig;
+	logConfig.console = false;
+	logConfig.filePath = logName.c_str();
+	Logger::StartUp(logConfig);
+
+	const u64 bytes = 4 * 1024 * 1024;
+	Memory::SetBudget(MemoryTag::Audio, bytes / 2);
+	Memory::Track(MemoryTag::Audio, bytes);
+	Memory::EndFrame();
+	Memory::Untrack(MemoryTag::Audio, bytes);
+	Memory::SetBudget(MemoryTag::Audio, 0);
+
+	//the per frame count behind Application's heap allocation warning
+#ifdef WF_TRACK_HEAP
+	Memory::EndFrame();
+	delete new u64(0);
+	Memory::EndFrame();
+	const bool heapCounted = Memory::GetFrameAllocationCount() == 1;
+#else
+	const bool heapCounted = true;
+#endif
+	Logger::ShutDown();
+
+	std::string log;
+	if (FILE* file = fopen(logName.c_str(), "rb"))
+	{
+		char buffer[1024];
+		size_t read;
+		while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+			log.append(buffer, read);
+		fclose(file);
+	}
+	std::filesystem::remove(logPath, error);
+	std::filesystem::remove(logName + ".1", error);
+
+	const bool warned = log.find("memory budget exceeded: Audio") != std::string::npos;
+	const bool ok = warned == (WF_LOG_LEVEL <= WF_LOG_LEVEL_WARNING) && heapCounted;
+	printf("%-32s %s (warning %s, frame heap count %s)\n", "memory.budget_warning", ok ? "ok" : "FAIL",
+		warned ? "logged" : "compiled out", heapCounted ? "ok" : "wrong");
+	return ok;
+}
+
+static void ProfiledThread()
+{
+	WF_PROFILE_SCOPE("check");
+}
+
+static bool CheckProfilerThreads()
+{
+	//short lived threads one after the other reuse the buffers of the exited ones
+	const u32 rejectedBefore = Profiler::GetRejectedThreads();
+	for (u32 i = 0; i < Profiler::MAX_THREADS * 3; i++)
+		std::thread(ProfiledThread).join();
+	const u32 sequentialRejected = Profiler::GetRejectedThreads() - rejectedBefore;
+
+	//more threads alive at once than the limit, the extra ones are counted
+	const u32 extra = 4;
+	std::atomic<u32> arrived{ 0 };
+	std::atomic<bool> release{ false };
+	std::vector<std::thread> threads;
+	for (u32 i = 0; i < Profiler::MAX_THREADS + extra; i++)
+	{
+		threads.emplace_back([&]() {
+			ProfiledThread();
+			arrived.fetch_add(1);
+			while (!release.load()) std::this_thread::yield();
+		});
+	}
+	while (arrived.load() < Profiler::MAX_THREADS + extra) std::this_thread::yield();
+	release.store(true);
+	for (std::thread& thread : threads) thread.join();
+	const u32 concurrentRejected = Profiler::GetRejectedThreads() - rejectedBefore;
+
+	//and once they are gone there is room again
+	for (u32 i = 0; i < Profiler::MAX_THREADS; i++)
+		std::thread(ProfiledThread).join();
+	const u32 afterRejected = Profiler::GetRejectedThreads() - rejectedBefore;
+	Profiler::NewFrame();
+
+	//threads that profiled earlier in this process may still hold a buffer
+	const bool ok = sequentialRejected == 0 && concurrentRejected >= extra && concurrentRejected <= extra + 1 && afterRejected == concurrentRejected;
+	printf("%-32s %s (%u rejected in sequence, %u with %u alive, %u after)\n", "profiler.thread_buffers", ok ? "ok" : "FAIL",
+		sequentialRejected, concurrentRejected, Profiler::MAX_THREADS + extra, afterRejected - concurrentRejected);
+	return ok;
+}
+
+static int RunChecks()
+{
+	bool ok = CheckWorldRandomOps();
+	ok &= CheckTransformDirty();
+	ok &= CheckTransformReparent();
+	ok &= CheckTransformParallel();
+	ok &= CheckJobsRunOnce();
+	ok &= CheckTwoSystems();
+	ok &= CheckRunAfterFull();
+	ok &= CheckProfilerThreads();
+	ok &= CheckMemoryBudget();
+	return ok ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--count") && i + 1 < argc) config.count = (u32)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--reps") && i + 1 < argc) config.reps = (u32)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--threads") && i + 1 < argc) config.threads = (u32)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--filter") && i + 1 < argc) config.filter = argv[++i];
+		else if (!strcmp(argv[i], "--check")) config.check = true;
+		else
+		{
+			printf("usage: %s [--count N] [--reps N] [--threads N] [--filter substring] [--check]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (config.check) return RunChecks();
+	if (config.reps == 0) config.reps = 1;
+	if (config.count < 4) config.count = 4;
+
+	JobSystem jobs;
+	jobs.StartUp(config.threads);
+	printf("EcsBench threads: %u  reps: %u\n", jobs.GetThreadCount(), config.reps);
+	RunAll(jobs);
+	jobs.ShutDown();
+	return 0;
+}
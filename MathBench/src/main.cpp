@@ -0,0 +1,936 @@
+#define SDL_MAIN_HANDLED
+#include "wf_pch.h"
+#include "wf_math.h"
+#include "wf_math_batch.h"
+#include "wf_math_fast.h"
+#include "wf_culling.h"
+#include "wf_packing.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <random>
+#include <vector>
+
+//MathBench: microbenchmarks for wf_math.h
+//usage: MathBench [--reps N] [--warmup N] [--filter substring] [--json path|-] [--accuracy]
+//--accuracy checks the Math::Fast error bounds and the SIMD paths against the scalar ones instead of
+//timing, exit code 1 if one is exceeded
+//every benchmark runs over `count` elements per repetition, timings are reported in ns per element
+
+using namespace Wolf;
+
+struct BenchConfig
+{
+	u32 warmup = 3;
+	u32 reps = 31;
+	f64 minRepNs = 200000.0; //small sets are repeated inside a rep until it takes at least this long
+	const char* filter = nullptr;
+	const char* jsonPath = nullptr;
+	bool accuracy = false;
+};
+
+struct BenchResult
+{
+	std::string name;
+	std::string layout;
+	u32 count;
+	u32 inner;
+	f64 min, p50, p90, p99, mean;
+};
+
+static BenchConfig config;
+static std::vector<BenchResult> results;
+static volatile f32 sink;
+static FILE* textOut = stdout; //the human readable table goes to stderr when the json goes to stdout
+
+static f64 Percentile(const std::vector<f64>& sorted, f64 p)
+{
+	size_t i = (size_t)(p * sorted.size());
+	if (i >= sorted.size()) i = sorted.size() - 1;
+	return sorted[i];
+}
+
+template<typename F>
+static void Bench(const char* name, const char* layout, u32 count, F&& body)
+{
+	if (config.filter && !strstr(name, config.filter)) return;
+
+	typedef std::chrono::steady_clock Clock;
+
+	f64 warmupNs = 0.0;
+	for (u32 i = 0; i < config.warmup; i++)
+	{
+		Clock::time_point start = Clock::now();
+		body();
+		warmupNs = std::chrono::duration<f64, std::nano>(Clock::now() - start).count();
+	}
+
+	u32 inner = 1;
+	if (warmupNs > 0.0 && warmupNs < config.minRepNs)
+		inner = (u32)(config.minRepNs / warmupNs) + 1;
+
+	std::vector<f64> samples;
+	samples.reserve(config.reps);
+	for (u32 r = 0; r < config.reps; r++)
+	{
+		Clock::time_point start = Clock::now();
+		for (u32 i = 0; i < inner; i++)
+			body();
+		const f64 ns = std::chrono::duration<f64, std::nano>(Clock::now() - start).count();
+		samples.push_back(ns / ((f64)inner * count));
+	}
+	std::sort(samples.begin(), samples.end());
+
+	BenchResult result;
+	result.name = name;
+	result.layout = layout;
+	result.count = count;
+	result.inner = inner;
+	result.min = samples.front();
+	result.p50 = Percentile(samples, 0.5);
+	result.p90 = Percentile(samples, 0.9);
+	result.p99 = Percentile(samples, 0.99);
+	result.mean = 0.0;
+	for (f64 s : samples) result.mean += s;
+	result.mean /= samples.size();
+	results.push_back(result);
+
+	fprintf(textOut, "%-32s %-8s %8u  min %8.3f  p50 %8.3f  p90 %8.3f  p99 %8.3f ns/elem\n",
+		name, layout, count, result.min, result.p50, result.p90, result.p99);
+}
+
+static const char* SimdBackend()
+{
+#if defined(WF_SIMD_AVX)
+	return "avx";
+#elif defined(WF_SIMD_SSE)
+	return "sse";
+#else
+	return "none";
+#endif
+}
+
+static void WriteJson(FILE* file)
+{
+	fprintf(file, "{\n");
+	fprintf(file, "  \"simd\": \"%s\",\n", SimdBackend());
+	fprintf(file, "  \"warmup\": %u,\n  \"reps\": %u,\n", config.warmup, config.reps);
+	fprintf(file, "  \"results\": [\n");
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BenchResult& r = results[i];
+		fprintf(file, "    { \"name\": \"%s\", \"layout\": \"%s\", \"count\": %u, \"inner\": %u, "
+			"\"min_ns\": %.4f, \"p50_ns\": %.4f, \"p90_ns\": %.4f, \"p99_ns\": %.4f, \"mean_ns\": %.4f }%s\n",
+			r.name.c_str(), r.layout.c_str(), r.count, r.inner, r.min, r.p50, r.p90, r.p99, r.mean,
+			i + 1 < results.size() ? "," : "");
+	}
+	fprintf(file, "  ]\n}\n");
+}
+
+struct DataSet
+{
+	std::vector<Vec3> vecs;
+	std::vector<Vec3> vecsOut;
+	std::vector<f32> xs, ys, zs;
+	std::vector<f32> outX, outY, outZ, outW;
+	std::vector<Mat44f> mats;
+	std::vector<Mat44f> affine;
+	std::vector<Mat44f> rigid;
+	std::vector<Mat44f> matsOut;
+	std::vector<Quaternion> quatsA, quatsB, quatsOut;
+	std::vector<f32> weights;
+	std::vector<u32> visibleMask;
+	std::vector<u16> halfs;
+	std::vector<OctNormal> normals;
+
+	DataSet(u32 count)
+	{
+		std::mt19937 rng(count);
+		std::uniform_real_distribution<f32> dist(-1.0f, 1.0f);
+		std::uniform_real_distribution<f32> unit(0.0f, 1.0f);
+
+		vecs.resize(count); vecsOut.resize(count);
+		xs.resize(count); ys.resize(count); zs.resize(count);
+		outX.resize(count); outY.resize(count); outZ.resize(count); outW.resize(count);
+		mats.resize(count); affine.resize(count); rigid.resize(count); matsOut.resize(count);
+		quatsA.resize(count); quatsB.resize(count); quatsOut.resize(count);
+		weights.resize(count);
+		visibleMask.resize((count + 31) / 32);
+		halfs.resize(count); normals.resize(count);
+
+		for (u32 i = 0; i < count; i++)
+		{
+			vecs[i] = Vec3(dist(rng) * 10.0f, dist(rng) * 10.0f, dist(rng) * 10.0f + 20.0f);
+			xs[i] = vecs[i].x; ys[i] = vecs[i].y; zs[i] = vecs[i].z;
+
+			Mat44f rot, trans, scale;
+			rot.setRotation(dist(rng) * 180.0f, dist(rng) * 180.0f, dist(rng) * 180.0f);
+			trans.setTranslation(dist(rng) * 100.0f, dist(rng) * 100.0f, dist(rng) * 100.0f);
+			scale.setScale(Vec3(1.0f + unit(rng), 1.0f + unit(rng), 1.0f + unit(rng)));
+			rigid[i] = rot * trans;
+			affine[i] = scale * rigid[i];
+			for (u32 j = 0; j < 16; j++)
+				mats[i].values[j] = dist(rng) + ((j % 5 == 0) ? 4.0f : 0.0f);
+
+			quatsA[i].fromMatrix(rot);
+			quatsA[i].normalize();
+			quatsB[i] = Quaternion(dist(rng), dist(rng), dist(rng), dist(rng));
+			quatsB[i].normalize();
+			weights[i] = unit(rng);
+		}
+	}
+};
+
+static void RunAll(u32 count)
+{
+	DataSet d(count);
+	Mat44f viewProj, view, proj;
+	view.setLookAt(Vec3(0.0f, 5.0f, -10.0f), Vec3(0.0f, 0.0f, 20.0f), Vec3(0.0f, 1.0f, 0.0f));
+	proj.setPerspective(60.0f, 16.0f / 9.0f, 0.1f, 1000.0f);
+	viewProj = view * proj;
+
+	Bench("vec3.normalize", "aos", count, [&]() {
+		for (u32 i = 0; i < count; i++) d.vecsOut[i] = d.vecs[i].normalized();
+		sink = d.vecsOut[count - 1].x;
+	});
+
+	Bench("fast.normalize", "aos", count, [&]() {
+		for (u32 i = 0; i < count; i++) d.vecsOut[i] = Math::Fast::normalized(d.vecs[i]);
+		sink = d.vecsOut[count - 1].x;
+	});
+
+	Bench("math.sinf", "soa", count, [&]() {
+		for (u32 i = 0; i < count; i++) d.outX[i] = sinf(d.xs[i]);
+		sink = d.outX[count - 1];
+	});
+
+	Bench("fast.sin", "soa", count, [&]() {
+		for (u32 i = 0; i < count; i++) d.outX[i] = Math::Fast::sin(d.xs[i]);
+		sink = d.outX[count - 1];
+	});
+
+	Bench("math.atan2f", "soa", count, [&]() {
+		for (u32 i = 0; i < count; i++) d.outX[i] = atan2f(d.ys[i], d.xs[i]);
+		sink = d.outX[count - 1];
+	});
+
+	Bench("fast.atan2", "soa", count, [&]() {
+		for (u32 i = 0; i < count; i++) d.outX[i] = Math::Fast::atan2(d.ys[i], d.xs[i]);
+		sink = d.outX[count - 1];
+	});
+
+	Bench("math.expf", "soa", count, [&]() {
+		for (u32 i = 0; i < count; i++) d.outX[i] = expf(d.xs[i]);
+		sink = d.outX[count - 1];
+	});
+
+	Bench("fast.exp", "soa", count, [&]() {
+		for (u32 i = 0; i < count; i++) d.outX[i] = Math::Fast::exp(d.xs[i]);
+		sink = d.outX[count - 1];
+	});
+
+	Bench("mat44.multiply", "aos", count, [&]() {
+		for (u32 i = 0; i < count; i++) d.matsOut[i] = d.mats[i] * d.mats[count - 1 - i];
+		sink = d.matsOut[count - 1].values[5];
+	});
+
+	Bench("mat44.multiplyScalar", "aos", count, [&]() {
+		for (u32 i = 0; i < count; i++) Mat44f::multiplyScalar(d.mats[i], d.mats[count - 1 - i], d.matsOut[i]);
+		sink = d.matsOut[count - 1].values[5];
+	});
+
+	Bench("mat44.inverse", "aos", count, [&]() {
+		for (u32 i = 0; i < count; i++) { d.matsOut[i] = d.mats[i]; d.matsOut[i].inverse(); }
+		sink = d.matsOut[count - 1].values[5];
+	});
+
+	Bench("mat44.inverseGaussJordan", "aos", count, [&]() {
+		for (u32 i = 0; i < count; i++) { d.matsOut[i] = d.mats[i]; d.matsOut[i].inverseGaussJordan(); }
+		sink = d.matsOut[count - 1].values[5];
+	});
+
+	//the same affine matrices through every path, inverse() takes the affine one when it is faster
+	Bench("mat44.inverseAffine", "aos", count, [&]() {
+		for (u32 i = 0; i < count; i++) { d.matsOut[i] = d.affine[i]; d.matsOut[i].inverseAffine(); }
+		sink = d.matsOut[count - 1].values[5];
+	});
+
+	Bench("mat44.inverseAffineScalar", "aos", count, [&]() {
+		for (u32 i = 0; i < count; i++) { d.matsOut[i] = d.affine[i]; d.matsOut[i].inverseAffineScalar(); }
+		sink = d.matsOut[count - 1].values[5];
+	});
+
+	Bench("mat44.inverseGeneral.affine", "aos", count, [&]() {
+		for (u32 i = 0; i < count; i++) { d.matsOut[i] = d.affine[i]; d.matsOut[i].inverseGeneral(); }
+		sink = d.matsOut[count - 1].values[5];
+	});
+
+	Bench("mat44.inverse.affine", "aos", count, [&]() {
+		for (u32 i = 0; i < count; i++) { d.matsOut[i] = d.affine[i]; d.matsOut[i].inverse(); }
+		sink = d.matsOut[count - 1].values[5];
+	});
+
+	Bench("mat44.inverseRigid", "aos", count, [&]() {
+		for (u32 i = 0; i < count; i++) { d.matsOut[i] = d.rigid[i]; d.matsOut[i].inverseRigid(); }
+		sink = d.matsOut[count - 1].values[5];
+	});
+
+	Bench("mat44.inverseRigidScalar", "aos", count, [&]() {
+		for (u32 i = 0; i < count; i++) { d.matsOut[i] = d.rigid[i]; d.matsOut[i].inverseRigidScalar(); }
+		sink = d.matsOut[count - 1].values[5];
+	});
+
+	Bench("mat44.inverseGeneral.rigid", "aos", count, [&]() {
+		for (u32 i = 0; i < count; i++) { d.matsOut[i] = d.rigid[i]; d.matsOut[i].inverseGeneral(); }
+		sink = d.matsOut[count - 1].values[5];
+	});
+
+	Bench("mat44.transformPoint", "aos", count, [&]() {
+		const Mat44f& m = d.rigid[0];
+		for (u32 i = 0; i < count; i++)
+		{
+			const Vec4 r = m * Vec4(d.vecs[i].x, d.vecs[i].y, d.vecs[i].z, 1.0f);
+			d.vecsOut[i] = Vec3(r.x, r.y, r.z);
+		}
+		sink = d.vecsOut[count - 1].x;
+	});
+
+	Bench("batch.transformPoints", "aos", count, [&]() {
+		TransformPoints(d.rigid[0], d.vecs.data(), d.vecsOut.data(), count);
+		sink = d.vecsOut[count - 1].x;
+	});
+
+	Bench("batch.transformPoints", "soa", count, [&]() {
+		TransformPoints(d.rigid[0], d.xs.data(), d.ys.data(), d.zs.data(), d.outX.data(), d.outY.data(), d.outZ.data(), count);
+		sink = d.outX[count - 1];
+	});
+
+	Bench("batch.transformAndProject", "soa", count, [&]() {
+		TransformAndProject(viewProj, d.xs.data(), d.ys.data(), d.zs.data(), d.outX.data(), d.outY.data(), d.outZ.data(), d.outW.data(), count);
+		sink = d.outX[count - 1];
+	});
+
+	Frustum frustum(viewProj);
+	Bench("frustum.intersectsSphere", "aos", count, [&]() {
+		u32 visible = 0;
+		for (u32 i = 0; i < count; i++) visible += frustum.intersects(Sphere(d.vecs[i], d.weights[i])) ? 1 : 0;
+		sink = (f32)visible;
+	});
+
+	Bench("batch.cullSpheres", "soa", count, [&]() {
+		sink = (f32)CullSpheres(frustum, d.xs.data(), d.ys.data(), d.zs.data(), d.weights.data(), count, d.visibleMask.data());
+	});
+
+	Bench("frustum.intersectsAABB", "aos", count, [&]() {
+		u32 visible = 0;
+		for (u32 i = 0; i < count; i++)
+		{
+			const Vec3 e(d.weights[i], d.weights[i], d.weights[i]);
+			visible += frustum.intersects(AABB(d.vecs[i] - e, d.vecs[i] + e)) ? 1 : 0;
+		}
+		sink = (f32)visible;
+	});
+
+	Bench("batch.cullAABBs", "soa", count, [&]() {
+		sink = (f32)CullAABBs(frustum, d.xs.data(), d.ys.data(), d.zs.data(), d.weights.data(), d.weights.data(), d.weights.data(), count, d.visibleMask.data());
+	});
+
+	Bench("batch.packHalfs", "soa", count, [&]() {
+		PackHalfs(d.xs.data(), d.halfs.data(), count);
+		sink = (f32)d.halfs[count - 1];
+	});
+
+	Bench("batch.unpackHalfs", "soa", count, [&]() {
+		UnpackHalfs(d.halfs.data(), d.outX.data(), count);
+		sink = d.outX[count - 1];
+	});
+
+	Bench("batch.packNormals", "aos", count, [&]() {
+		PackNormals(d.vecs.data(), d.normals.data(), count);
+		sink = (f32)d.normals[count - 1].x;
+	});
+
+	Bench("batch.unpackNormals", "aos", count, [&]() {
+		UnpackNormals(d.normals.data(), d.vecsOut.data(), count);
+		sink = d.vecsOut[count - 1].x;
+	});
+
+	Bench("quat.normalize", "aos", count, [&]() {
+		for (u32 i = 0; i < count; i++) { d.quatsOut[i] = d.quatsB[i]; d.quatsOut[i].normalize(); }
+		sink = d.quatsOut[count - 1].w;
+	});
+
+	Bench("quat.slerp", "aos", count, [&]() {
+		for (u32 i = 0; i < count; i++) d.quatsOut[i] = Qslerp(d.quatsA[i], d.quatsB[i], d.weights[i]);
+		sink = d.quatsOut[count - 1].w;
+	});
+
+	Bench("batch.blendQuaternions.slerp", "aos", count, [&]() {
+		BlendQuaternions(d.quatsA.data(), d.quatsB.data(), d.weights.data(), d.quatsOut.data(), count, QuatBlendMode::Slerp);
+		sink = d.quatsOut[count - 1].w;
+	});
+
+	Bench("batch.blendQuaternions.nlerp", "aos", count, [&]() {
+		BlendQuaternions(d.quatsA.data(), d.quatsB.data(), d.weights.data(), d.quatsOut.data(), count, QuatBlendMode::Nlerp);
+		sink = d.quatsOut[count - 1].w;
+	});
+
+	Bench("quat.toMatrix", "aos", count, [&]() {
+		for (u32 i = 0; i < count; i++) d.quatsA[i].toMatrix(d.matsOut[i]);
+		sink = d.matsOut[count - 1].values[5];
+	});
+
+	Bench("quat.fromMatrix", "aos", count, [&]() {
+		for (u32 i = 0; i < count; i++) d.quatsOut[i].fromMatrix(d.rigid[i]);
+		sink = d.quatsOut[count - 1].w;
+	});
+}
+
+static bool ReportAccuracy(const char* name, const char* kind, f64 maxError, f64 bound)
+{
+	const bool ok = maxError <= bound;
+	fprintf(textOut, "%-20s %s error %.3e  bound %.3e  %s\n", name, kind, maxError, bound, ok ? "ok" : "EXCEEDED");
+	return ok;
+}
+
+//max error of fn against ref over `samples` uniform inputs in [lo, hi]
+template<typename F, typename R>
+static bool CheckAccuracy(const char* name, f64 bound, bool relative, f64 lo, f64 hi, F&& fn, R&& ref)
+{
+	const u32 samples = 1000000;
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<f64> dist(lo, hi);
+
+	f64 maxError = 0.0;
+	for (u32 i = 0; i < samples; i++)
+	{
+		const f32 x = (f32)dist(rng);
+		const f64 expected = ref((f64)x);
+		f64 error = fabs((f64)fn(x) - expected);
+		if (relative) error /= fabs(expected);
+		if (error > maxError) maxError = error;
+	}
+
+	return ReportAccuracy(name, relative ? "rel" : "abs", maxError, bound);
+}
+
+//pack -> unpack through the batch converters, the scalar tail is covered by the odd count
+static bool CheckPacking()
+{
+	const u32 count = 100003;
+	std::mt19937 rng(1234);
+	std::normal_distribution<f32> normal;
+	std::uniform_real_distribution<f32> dist(-50.0f, 50.0f);
+	bool ok = true;
+
+	std::vector<f32> floats(count), floatsOut(count);
+	std::vector<u16> halfs(count);
+	for (u32 i = 0; i < count; i++) floats[i] = dist(rng) * (f32)(1 << (i % 10)) * 1e-3f;
+	PackHalfs(floats.data(), halfs.data(), count);
+	UnpackHalfs(halfs.data(), floatsOut.data(), count);
+	f64 maxError = 0.0;
+	for (u32 i = 0; i < count; i++)
+		if (fabsf(floats[i]) >= 6.1035e-5f) maxError = std::max(maxError, fabs((f64)floatsOut[i] - floats[i]) / fabs((f64)floats[i]));
+	ok &= ReportAccuracy("pack.half", "rel", maxError, 4.9e-4);
+
+	std::vector<Vec3> vecs(count), vecsOut(count);
+	std::vector<OctNormal> normals(count);
+	for (u32 i = 0; i < count; i++) vecs[i] = Vec3(normal(rng), normal(rng), normal(rng)).normalized();
+	PackNormals(vecs.data(), normals.data(), count);
+	UnpackNormals(normals.data(), vecsOut.data(), count);
+	maxError = 0.0;
+	for (u32 i = 0; i < count; i++)
+		maxError = std::max(maxError, atan2((f64)Vec3::cross(vecs[i], vecsOut[i]).mod(), (f64)Vec3::dot(vecs[i], vecsOut[i])));
+	ok &= ReportAccuracy("pack.normal", "rad", maxError, 7e-5);
+
+	std::vector<Vec4> tangents(count), tangentsOut(count);
+	std::vector<u32> packedTangents(count);
+	for (u32 i = 0; i < count; i++) tangents[i] = Vec4(vecs[i].x, vecs[i].y, vecs[i].z, (i & 1) ? 1.0f : -1.0f);
+	PackTangents(tangents.data(), packedTangents.data(), count);
+	UnpackTangents(packedTangents.data(), tangentsOut.data(), count);
+	maxError = 0.0;
+	for (u32 i = 0; i < count; i++)
+	{
+		maxError = std::max(maxError, (f64)fabsf(tangentsOut[i].x - tangents[i].x));
+		maxError = std::max(maxError, (f64)fabsf(tangentsOut[i].y - tangents[i].y));
+		maxError = std::max(maxError, (f64)fabsf(tangentsOut[i].z - tangents[i].z));
+		if (tangentsOut[i].w != tangents[i].w) maxError = 1.0;
+	}
+	ok &= ReportAccuracy("pack.tangent", "abs", maxError, 1e-3);
+
+	std::vector<PackedPosition> positions(count);
+	AABB bounds(Vec3(FLT_MAX, FLT_MAX, FLT_MAX), Vec3(-FLT_MAX, -FLT_MAX, -FLT_MAX));
+	for (u32 i = 0; i < count; i++)
+	{
+		vecs[i] = Vec3(dist(rng), dist(rng) * 0.1f, dist(rng) + 200.0f);
+		bounds.expand(vecs[i]);
+	}
+	PackPositions(vecs.data(), bounds, positions.data(), count);
+	UnpackPositions(positions.data(), bounds, vecsOut.data(), count);
+	const Vec3 extents = bounds.extents();
+	maxError = 0.0;
+	for (u32 i = 0; i < count; i++)
+		for (u32 c = 0; c < 3; c++)
+			maxError = std::max(maxError, (f64)fabsf(vecsOut[i].values[c] - vecs[i].values[c]) / extents.values[c]);
+	ok &= ReportAccuracy("pack.position", "ext", maxError, 1.6e-5);
+	return ok;
+}
+
+//largest element difference, relative for elements above 1
+static f64 MatrixError(const Mat44f& a, const f64* reference)
+{
+	f64 error = 0.0;
+	for (u32 j = 0; j < 16; j++)
+		error = std::max(error, fabs((f64)a.values[j] - reference[j]) / std::max(1.0, fabs(reference[j])));
+	return error;
+}
+
+//inverseAffineScalar in double precision
+static void InverseAffineReference(const Mat44f& matrix, f64* out)
+{
+	f64 m[4][4];
+	for (u32 i = 0; i < 4; i++)
+		for (u32 j = 0; j < 4; j++)
+			m[i][j] = matrix.m[i][j];
+	f64 r[3][3];
+	r[0][0] = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+	r[1][0] = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+	r[2][0] = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+	r[0][1] = m[0][2] * m[2][1] - m[0][1] * m[2][2];
+	r[1][1] = m[0][0] * m[2][2] - m[0][2] * m[2][0];
+	r[2][1] = m[0][1] * m[2][0] - m[0][0] * m[2][1];
+	r[0][2] = m[0][1] * m[1][2] - m[0][2] * m[1][1];
+	r[1][2] = m[0][2] * m[1][0] - m[0][0] * m[1][2];
+	r[2][2] = m[0][0] * m[1][1] - m[0][1] * m[1][0];
+	const f64 det = m[0][0] * r[0][0] + m[0][1] * r[1][0] + m[0][2] * r[2][0];
+	for (u32 i = 0; i < 3; i++)
+	{
+		for (u32 j = 0; j < 3; j++)
+			out[i * 4 + j] = r[i][j] / det;
+		out[i * 4 + 3] = 0.0;
+	}
+	for (u32 j = 0; j < 3; j++)
+		out[12 + j] = -(m[3][0] * out[j] + m[3][1] * out[4 + j] + m[3][2] * out[8 + j]);
+	out[15] = 1.0;
+}
+
+static void RandomTransforms(std::mt19937& rng, Mat44f& rigid, Mat44f& affine)
+{
+	std::uniform_real_distribution<f32> dist(-1.0f, 1.0f);
+	std::uniform_real_distribution<f32> unit(0.0f, 1.0f);
+	Mat44f rot, trans, scale;
+	rot.setRotation(dist(rng) * 180.0f, dist(rng) * 180.0f, dist(rng) * 180.0f);
+	trans.setTranslation(dist(rng) * 100.0f, dist(rng) * 100.0f, dist(rng) * 100.0f);
+	scale.setScale(Vec3(0.1f + 4.0f * unit(rng), 0.1f + 4.0f * unit(rng), 0.1f + 4.0f * unit(rng)));
+	rigid = rot * trans;
+	affine = scale * rigid;
+}
+
+//the SIMD affine and rigid inverses against a double precision inverse. The scalar versions
+//reach the same 2.5e-5 and 1.6e-5 (scales down to 0.1, rigid also takes the float rotation as orthonormal)
+static bool CheckInverses()
+{
+	const u32 count = 100000;
+	std::mt19937 rng(1234);
+	f64 affineError = 0.0;
+	f64 rigidError = 0.0;
+	for (u32 i = 0; i < count; i++)
+	{
+		Mat44f rigid, affine;
+		RandomTransforms(rng, rigid, affine);
+		f64 reference[16];
+		InverseAffineReference(affine, reference);
+		affine.inverseAffine();
+		affineError = std::max(affineError, MatrixError(affine, reference));
+		InverseAffineReference(rigid, reference);
+		rigid.inverseRigid();
+		rigidError = std::max(rigidError, MatrixError(rigid, reference));
+	}
+	bool ok = ReportAccuracy("mat44.inverseAffine", "rel", affineError, 4e-5);
+	ok &= ReportAccuracy("mat44.inverseRigid", "rel", rigidError, 3e-5);
+	return ok;
+}
+
+//general 4x4 inverse in double precision, Gauss-Jordan with partial pivoting
+static void InverseReference(const Mat44f& matrix, f64* out)
+{
+	f64 a[4][8];
+	for (u32 i = 0; i < 4; i++)
+		for (u32 j = 0; j < 4; j++)
+		{
+			a[i][j] = matrix.m[i][j];
+			a[i][j + 4] = i == j ? 1.0 : 0.0;
+		}
+	for (u32 col = 0; col < 4; col++)
+	{
+		u32 pivot = col;
+		for (u32 i = col + 1; i < 4; i++)
+			if (fabs(a[i][col]) > fabs(a[pivot][col])) pivot = i;
+		if (pivot != col)
+			for (u32 j = 0; j < 8; j++) std::swap(a[col][j], a[pivot][j]);
+		const f64 rcp = 1.0 / a[col][col];
+		for (u32 j = 0; j < 8; j++) a[col][j] *= rcp;
+		for (u32 i = 0; i < 4; i++)
+		{
+			if (i == col) continue;
+			const f64 f = a[i][col];
+			for (u32 j = 0; j < 8; j++) a[i][j] -= f * a[col][j];
+		}
+	}
+	for (u32 i = 0; i < 4; i++)
+		for (u32 j = 0; j < 4; j++)
+			out[i * 4 + j] = a[i][j + 4];
+}
+
+//the SIMD multiply, transforms and general inverse against the scalar code and double precision references.
+//inverseGaussJordan (partial pivoting, rows not scaled, float elimination) reaches 1.5e-2 on the
+//same view projection matrices
+static bool CheckSimdMatrix()
+{
+	const u32 count = 100000;
+	std::mt19937 rng(4321);
+	std::uniform_real_distribution<f32> dist(-1.0f, 1.0f);
+	Mat44f proj;
+	proj.setPerspective(60.0f, 16.0f / 9.0f, 0.1f, 1000.0f);
+	f64 multiplyError = 0.0;
+	f64 pointError = 0.0;
+	f64 vectorError = 0.0;
+	f64 inverseError[2] = {};
+	for (u32 i = 0; i < count; i++)
+	{
+		Mat44f rigid, affine;
+		RandomTransforms(rng, rigid, affine);
+		const Mat44f viewProj = affine * proj;
+
+		f64 reference[16];
+		Mat44f scalar;
+		Mat44f::multiplyScalar(affine, proj, scalar);
+		for (u32 j = 0; j < 16; j++) reference[j] = scalar.values[j];
+		multiplyError = std::max(multiplyError, MatrixError(viewProj, reference));
+
+		const f64 v[4] = { dist(rng) * 100.0, dist(rng) * 100.0, dist(rng) * 100.0, 1.0 };
+		const Vec4 point = viewProj * Vec4((f32)v[0], (f32)v[1], (f32)v[2], 1.0f);
+		const Vec3 vector = affine * Vec3((f32)v[0], (f32)v[1], (f32)v[2]);
+		for (u32 j = 0; j < 4; j++)
+		{
+			//relative to the sum of term magnitudes, cancellation is not the transform's fault
+			f64 p = 0.0, pScale = 0.0;
+			f64 d = 0.0, dScale = 0.0;
+			for (u32 k = 0; k < 4; k++)
+			{
+				p += v[k] * viewProj.m[k][j];
+				pScale += fabs(v[k] * viewProj.m[k][j]);
+				if (k == 3) continue;
+				d += v[k] * affine.m[k][j];
+				dScale += fabs(v[k] * affine.m[k][j]);
+			}
+			pointError = std::max(pointError, fabs((&point.x)[j] - p) / std::max(1.0, pScale));
+			if (j < 3) vectorError = std::max(vectorError, fabs(vector.values[j] - d) / std::max(1.0, dScale));
+		}
+
+		const Mat44f matrices[2] = { affine, viewProj };
+		for (u32 j = 0; j < 2; j++)
+		{
+			Mat44f inverse = matrices[j];
+			InverseReference(matrices[j], reference);
+			inverse.inverseGeneral();
+			inverseError[j] = std::max(inverseError[j], MatrixError(inverse, reference));
+		}
+	}
+	bool ok = ReportAccuracy("mat44.multiply", "rel", multiplyError, 0.0);
+	ok &= ReportAccuracy("mat44.transformPoint", "rel", pointError, 1e-6);
+	ok &= ReportAccuracy("mat44.transformVector", "rel", vectorError, 1e-6);
+	ok &= ReportAccuracy("mat44.inverseGeneral.affine", "rel", inverseError[0], 4e-5);
+	ok &= ReportAccuracy("mat44.inverseGeneral.proj", "rel", inverseError[1], 3e-4);
+	return ok;
+}
+
+//the batch transforms against Mat44f * Vec4 one point at a time, the count isn't a multiple of 4
+//so the scalar remainder runs too. Errors are relative to the summed term magnitudes
+static bool CheckBatchTransforms()
+{
+	const u32 count = 100003;
+	std::mt19937 rng(99);
+	std::uniform_real_distribution<f32> dist(-100.0f, 100.0f);
+	Mat44f rigid, affine, proj;
+	RandomTransforms(rng, rigid, affine);
+	proj.setPerspective(60.0f, 16.0f / 9.0f, 0.1f, 1000.0f);
+	const Mat44f viewProj = affine * proj;
+
+	std::vector<f32> xs(count), ys(count), zs(count);
+	std::vector<Vec3> vecs(count);
+	for (u32 i = 0; i < count; i++)
+	{
+		xs[i] = dist(rng); ys[i] = dist(rng); zs[i] = dist(rng);
+		vecs[i] = Vec3(xs[i], ys[i], zs[i]);
+	}
+	std::vector<f32> outX(count), outY(count), outZ(count), outW(count);
+	std::vector<Vec3> vecsOut(count);
+
+	auto scalar = [&](const Mat44f& m, u32 i, f32 w, u32 c, f64& scale) {
+		const Vec4 r = m * Vec4(xs[i], ys[i], zs[i], w);
+		scale = fabs(xs[i] * m.m[0][c]) + fabs(ys[i] * m.m[1][c]) + fabs(zs[i] * m.m[2][c]) + fabs(w * m.m[3][c]);
+		scale = std::max(1.0, scale);
+		return (f64)(&r.x)[c];
+	};
+
+	f64 soaError = 0.0, stridedError = 0.0, directionError = 0.0, projectError = 0.0;
+	TransformPoints(affine, xs.data(), ys.data(), zs.data(), outX.data(), outY.data(), outZ.data(), count);
+	TransformPoints(affine, vecs.data(), vecsOut.data(), count);
+	for (u32 i = 0; i < count; i++)
+	{
+		const f32* soa[3] = { &outX[i], &outY[i], &outZ[i] };
+		for (u32 c = 0; c < 3; c++)
+		{
+			f64 scale;
+			const f64 expected = scalar(affine, i, 1.0f, c, scale);
+			soaError = std::max(soaError, fabs(*soa[c] - expected) / scale);
+			stridedError = std::max(stridedError, fabs(vecsOut[i].values[c] - expected) / scale);
+		}
+	}
+
+	TransformDirections(affine, xs.data(), ys.data(), zs.data(), outX.data(), outY.data(), outZ.data(), count);
+	for (u32 i = 0; i < count; i++)
+	{
+		const f32* soa[3] = { &outX[i], &outY[i], &outZ[i] };
+		for (u32 c = 0; c < 3; c++)
+		{
+			f64 scale;
+			const f64 expected = scalar(affine, i, 0.0f, c, scale);
+			directionError = std::max(directionError, fabs(*soa[c] - expected) / scale);
+		}
+	}
+
+	//compared in clip space with the batch's own w, NDC blows up near w = 0
+	TransformAndProject(viewProj, xs.data(), ys.data(), zs.data(), outX.data(), outY.data(), outZ.data(), outW.data(), count);
+	for (u32 i = 0; i < count; i++)
+	{
+		const f32* ndc[3] = { &outX[i], &outY[i], &outZ[i] };
+		f64 scale;
+		const f64 w = scalar(viewProj, i, 1.0f, 3, scale);
+		projectError = std::max(projectError, fabs(outW[i] - w) / scale);
+		for (u32 c = 0; c < 3; c++)
+		{
+			const f64 expected = scalar(viewProj, i, 1.0f, c, scale);
+			projectError = std::max(projectError, fabs((f64)*ndc[c] * outW[i] - expected) / scale);
+		}
+	}
+
+	bool ok = ReportAccuracy("batch.transformSoA", "rel", soaError, 3.6e-7);
+	ok &= ReportAccuracy("batch.transformVec3", "rel", stridedError, 3.6e-7);
+	ok &= ReportAccuracy("batch.directions", "rel", directionError, 3.6e-7);
+	ok &= ReportAccuracy("batch.project", "rel", projectError, 6e-7);
+	return ok;
+}
+
+static Quaternion RandomRotation(std::mt19937& rng)
+{
+	std::normal_distribution<f32> gauss;
+	Quaternion q(gauss(rng), gauss(rng), gauss(rng), gauss(rng));
+	q.normalize();
+	return q;
+}
+
+//BlendQuaternions against slerp and nlerp in double precision, and Qslerp on the same pairs
+static bool CheckBatchBlend()
+{
+	const u32 count = 1000003;
+	std::mt19937 rng(2024);
+	std::uniform_real_distribution<f32> unit(0.0f, 1.0f);
+	std::vector<Quaternion> a(count), b(count), out(count);
+	std::vector<f32> weights(count);
+	for (u32 i = 0; i < count; i++)
+	{
+		a[i] = RandomRotation(rng);
+		b[i] = RandomRotation(rng);
+		weights[i] = unit(rng);
+	}
+
+	auto reference = [&](u32 i, bool slerp, f64* result) {
+		f64 dot = 0.0;
+		for (u32 c = 0; c < 4; c++) dot += (f64)a[i].q[c] * b[i].q[c];
+		const f64 sign = dot < 0.0 ? -1.0 : 1.0;
+		dot = std::min(1.0, dot * sign);
+		const f64 t = weights[i];
+		f64 wa = 1.0 - t, wb = t;
+		const f64 angle = acos(dot);
+		if (slerp && angle > 1e-9)
+		{
+			wa = sin((1.0 - t) * angle) / sin(angle);
+			wb = sin(t * angle) / sin(angle);
+		}
+		f64 length = 0.0;
+		for (u32 c = 0; c < 4; c++)
+		{
+			result[c] = a[i].q[c] * wa + b[i].q[c] * wb * sign;
+			length += result[c] * result[c];
+		}
+		if (!slerp)
+			for (u32 c = 0; c < 4; c++) result[c] /= sqrt(length);
+	};
+
+	f64 slerpError = 0.0, nlerpError = 0.0, qslerpError = 0.0;
+	BlendQuaternions(a.data(), b.data(), weights.data(), out.data(), count, QuatBlendMode::Slerp);
+	for (u32 i = 0; i < count; i++)
+	{
+		f64 expected[4];
+		reference(i, true, expected);
+		const Quaternion scalar = Qslerp(a[i], b[i], weights[i]);
+		for (u32 c = 0; c < 4; c++)
+		{
+			slerpError = std::max(slerpError, fabs(out[i].q[c] - expected[c]));
+			qslerpError = std::max(qslerpError, fabs(scalar.q[c] - expected[c]));
+		}
+	}
+
+	BlendQuaternions(a.data(), b.data(), weights.data(), out.data(), count, QuatBlendMode::Nlerp);
+	for (u32 i = 0; i < count; i++)
+	{
+		f64 expected[4];
+		reference(i, false, expected);
+		for (u32 c = 0; c < 4; c++)
+			nlerpError = std::max(nlerpError, fabs(out[i].q[c] - expected[c]));
+	}
+
+	bool ok = ReportAccuracy("batch.slerp", "abs", slerpError, 3e-5);
+	ok &= ReportAccuracy("batch.nlerp", "abs", nlerpError, 4e-7);
+	ok &= ReportAccuracy("Qslerp", "abs", qslerpError, 5e-4);
+	return ok;
+}
+
+//CullSpheres/CullAABBs against Frustum::intersects one object at a time. Half the objects are
+//placed on a plane (exactly for spheres, within rounding for boxes), where a different operation
+//order would flip the answer
+static bool CheckCulling()
+{
+	const u32 count = 100003;
+	std::mt19937 rng(31);
+	std::uniform_real_distribution<f32> dist(-1.0f, 1.0f);
+	std::uniform_real_distribution<f32> unit(0.0f, 1.0f);
+	std::vector<f32> xs(count), ys(count), zs(count), radius(count), ex(count), ey(count), ez(count);
+	std::vector<u32> mask((count + 31) / 32);
+	u32 sphereWrong = 0, boxWrong = 0, visible = 0;
+
+	for (u32 round = 0; round < 8; round++)
+	{
+		Mat44f rigid, affine, proj;
+		RandomTransforms(rng, rigid, affine);
+		proj.setPerspective(30.0f + 60.0f * unit(rng), 16.0f / 9.0f, 0.1f, 200.0f);
+		const Frustum frustum(rigid * proj);
+
+		std::vector<Sphere> spheres(count);
+		std::vector<AABB> boxes(count);
+		for (u32 i = 0; i < count; i++)
+		{
+			Vec3 center(dist(rng) * 200.0f, dist(rng) * 200.0f, dist(rng) * 200.0f);
+			const Vec3 extents(unit(rng) * 10.0f, unit(rng) * 10.0f, unit(rng) * 10.0f);
+			f32 r = unit(rng) * 10.0f;
+			if (i & 1)
+			{
+				const Plane& plane = frustum.planes[rng() % Frustum::PLANE_COUNT];
+				r = fabsf(plane.distance(center));
+				center = center - plane.normal * (plane.distance(center) + r);
+				r = -plane.distance(center);
+				if (r < 0.0f) r = 0.0f;
+			}
+			spheres[i] = Sphere(center, r);
+			boxes[i] = AABB(center - extents, center + extents);
+
+			xs[i] = center.x; ys[i] = center.y; zs[i] = center.z;
+			radius[i] = r;
+		}
+
+		CullSpheres(frustum, xs.data(), ys.data(), zs.data(), radius.data(), count, mask.data());
+		for (u32 i = 0; i < count; i++)
+		{
+			const bool expected = frustum.intersects(spheres[i]);
+			sphereWrong += IsVisible(mask.data(), i) != expected;
+			visible += expected;
+		}
+
+		//the scalar test works on center() and extents(), the batch gets the same values
+		for (u32 i = 0; i < count; i++)
+		{
+			const Vec3 center = boxes[i].center();
+			const Vec3 extents = boxes[i].extents();
+			xs[i] = center.x; ys[i] = center.y; zs[i] = center.z;
+			ex[i] = extents.x; ey[i] = extents.y; ez[i] = extents.z;
+		}
+		CullAABBs(frustum, xs.data(), ys.data(), zs.data(), ex.data(), ey.data(), ez.data(), count, mask.data());
+		for (u32 i = 0; i < count; i++)
+			boxWrong += IsVisible(mask.data(), i) != frustum.intersects(boxes[i]);
+	}
+
+	fprintf(textOut, "%-20s %u of %u differ from Frustum::intersects (%u visible)  %s\n", "cull.spheres", sphereWrong, count * 8, visible, sphereWrong ? "EXCEEDED" : "ok");
+	fprintf(textOut, "%-20s %u of %u differ from Frustum::intersects  %s\n", "cull.aabbs", boxWrong, count * 8, boxWrong ? "EXCEEDED" : "ok");
+	return sphereWrong == 0 && boxWrong == 0;
+}
+
+static bool RunAccuracy()
+{
+	bool ok = true;
+	ok &= CheckAccuracy("fast.rsqrt", 3e-7, true, 1e-6, 1e6, [](f32 x) { return Math::Fast::rsqrt(x); }, [](f64 x) { return 1.0 / sqrt(x); });
+	ok &= CheckAccuracy("fast.sqrt", 3e-7, true, 1e-6, 1e6, [](f32 x) { return Math::Fast::sqrt(x); }, [](f64 x) { return sqrt(x); });
+	ok &= CheckAccuracy("fast.sin", 3e-7, false, -1e4, 1e4, [](f32 x) { return Math::Fast::sin(x); }, [](f64 x) { return sin(x); });
+	ok &= CheckAccuracy("fast.cos", 3e-7, false, -1e4, 1e4, [](f32 x) { return Math::Fast::cos(x); }, [](f64 x) { return cos(x); });
+	ok &= CheckAccuracy("fast.atan", 1.5e-5, false, -100.0, 100.0, [](f32 x) { return Math::Fast::atan(x); }, [](f64 x) { return atan(x); });
+	ok &= CheckAccuracy("fast.atan2", 1.5e-5, false, -PI, PI,
+		[](f32 a) { return Math::Fast::atan2(sinf(a) * 3.0f, cosf(a) * 3.0f); },
+		[](f64 a) { return atan2((f64)(sinf((f32)a) * 3.0f), (f64)(cosf((f32)a) * 3.0f)); });
+	ok &= CheckAccuracy("fast.acos", 7e-5, false, -1.0, 1.0, [](f32 x) { return Math::Fast::acos(x); }, [](f64 x) { return acos(x); });
+	ok &= CheckAccuracy("fast.exp", 3e-7, true, -87.0, 88.0, [](f32 x) { return Math::Fast::exp(x); }, [](f64 x) { return exp(x); });
+	ok &= CheckAccuracy("fast.log", 6e-7, false, 1e-6, 1e6, [](f32 x) { return Math::Fast::log(x); }, [](f64 x) { return log(x); });
+	ok &= CheckAccuracy("fast.normalized", 4e-7, false, -100.0, 100.0,
+		[](f32 x) { return Math::Fast::normalized(Vec3(x, 1.0f - x * 0.5f, 0.25f * x + 3.0f)).mod(); },
+		[](f64) { return 1.0; });
+	ok &= CheckPacking();
+	ok &= CheckInverses();
+	ok &= CheckSimdMatrix();
+	ok &= CheckBatchTransforms();
+	ok &= CheckBatchBlend();
+	ok &= CheckCulling();
+	return ok;
+}
+
+int main(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--reps") && i + 1 < argc) config.reps = (u32)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--warmup") && i + 1 < argc) config.warmup = (u32)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--filter") && i + 1 < argc) config.filter = argv[++i];
+		else if (!strcmp(argv[i], "--json") && i + 1 < argc) config.jsonPath = argv[++i];
+		else if (!strcmp(argv[i], "--accuracy")) config.accuracy = true;
+		else
+		{
+			printf("usage: %s [--reps N] [--warmup N] [--filter substring] [--json path|-] [--accuracy]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (config.reps == 0) config.reps = 1;
+
+	if (config.accuracy)
+		return RunAccuracy() ? 0 : 1;
+
+	if (config.jsonPath && !strcmp(config.jsonPath, "-")) textOut = stderr;
+	fprintf(textOut, "MathBench simd: %s  warmup: %u  reps: %u\n", SimdBackend(), config.warmup, config.reps);
+
+	const u32 sizes[] = { 256, 16384, 262144 };
+	for (u32 count : sizes)
+		RunAll(count);
+
+	if (config.jsonPath)
+	{
+		FILE* file = strcmp(config.jsonPath, "-") ? fopen(config.jsonPath, "w") : stdout;
+		if (!file)
+		{
+			printf("can't open %s\n", config.jsonPath);
+			return 1;
+		}
+		WriteJson(file);
+		if (file != stdout) fclose(file);
+	}
+
+	return 0;
+}
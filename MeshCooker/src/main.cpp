@@ -0,0 +1,786 @@
+#define SDL_MAIN_HANDLED
+#include "wf_pch.h"
+#include "wf_mesh_format.h"
+#include "wf_mesh_optimizer.h"
+#include "wf_text_parser.h"
+#include "wf_packing.h"
+#include "wf_memory.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <unordered_map>
+#include <vector>
+
+//MeshCooker: reads an OBJ or ASE text mesh with TextParser and writes the .wmesh container of
+//wf_mesh_format.h that CookedMesh memory maps at runtime
+//usage: MeshCooker [--split] [--packed] [--index32] [--tipsify] [--overdraw] [--raw] [--force] input output
+//--split     one vertex stream per attribute instead of a single interleaved one
+//--packed    snorm16 positions relative to the bounds, octahedral normals, half texture coordinates
+//--index32   32 bit indices even when 16 bits are enough
+//--tipsify   Tipsify vertex cache ordering instead of Forsyth's
+//--overdraw  also sort the triangles of each submesh in clusters facing out first
+//--raw       keep the vertices and triangles as the source has them
+//--force     cook even if the output is newer than the input and was cooked with the same options
+//OBJ submeshes are the usemtl materials, ASE ones the objects. ASE is converted from the Z up of
+//3ds Max to Y up. Missing normals are generated, smooth across the faces at the same position.
+//Identical vertices are then welded, the triangles of each submesh ordered for the vertex cache
+//and the vertices for fetch, the ACMR/ATVR of the source and cooked orders are printed.
+
+using namespace Wolf;
+
+struct CookOptions
+{
+	bool split = false;
+	bool packed = false;
+	bool index32 = false;
+	bool tipsify = false;
+	bool overdraw = false;
+	bool raw = false;
+	bool force = false;
+	const char* input = nullptr;
+	const char* output = nullptr;
+};
+
+struct Vertex
+{
+	Vec3 position;
+	Vec3 normal;
+	Vec2 texCoord;
+};
+
+struct Submesh
+{
+	std::string name;
+	std::vector<u32> indices;
+};
+
+struct SourceMesh
+{
+	std::vector<Vertex> vertices;
+	//1 where the source gave the vertex a normal
+	std::vector<u8> hasNormal;
+	std::vector<Submesh> submeshes;
+	bool hasTexCoords = false;
+};
+
+static u32 FindSubmesh(SourceMesh& mesh, std::string_view name)
+{
+	for (u32 i = 0; i < (u32)mesh.submeshes.size(); i++)
+	{
+		if (mesh.submeshes[i].name == name) return i;
+	}
+	mesh.submeshes.push_back(Submesh());
+	mesh.submeshes.back().name = std::string(name.substr(0, MESH_MAX_NAME - 1));
+	return (u32)mesh.submeshes.size() - 1;
+}
+
+static u32 AddVertex(SourceMesh& mesh, const Vertex& vertex, bool hasNormal)
+{
+	mesh.vertices.push_back(vertex);
+	mesh.hasNormal.push_back(hasNormal ? 1 : 0);
+	return (u32)mesh.vertices.size() - 1;
+}
+
+static std::string_view Trim(std::string_view text)
+{
+	while (!text.empty() && (u8)text.front() <= ' ') text.remove_prefix(1);
+	while (!text.empty() && (u8)text.back() <= ' ') text.remove_suffix(1);
+	return text;
+}
+
+//OBJ indices start at 1, negative ones count back from the last element so far
+static bool ResolveObjIndex(s64 index, size_t count, u32& resolved)
+{
+	const s64 value = index < 0 ? (s64)count + index : index - 1;
+	if (index == 0 || value < 0 || value >= (s64)count) return false;
+	resolved = (u32)value;
+	return true;
+}
+
+struct ObjCorner
+{
+	u32 position;
+	u32 texCoord;
+	u32 normal;
+
+	bool operator==(const ObjCorner& other) const { return position == other.position && texCoord == other.texCoord && normal == other.normal; }
+};
+
+struct ObjCornerHash
+{
+	size_t operator()(const ObjCorner& corner) const
+	{
+		u64 hash = corner.position * 0x9E3779B97F4A7C15ull;
+		hash ^= (corner.texCoord + 0x632BE59BD9B4E019ull) + (hash << 6) + (hash >> 2);
+		hash ^= (corner.normal + 0x85157AF5ull) + (hash << 6) + (hash >> 2);
+		return (size_t)hash;
+	}
+};
+
+static bool LoadObj(const char* path, SourceMesh& mesh)
+{
+	TextParser parser;
+	if (!parser.Open(path))
+	{
+		fprintf(stderr, "MeshCooker: can't open %s\n", path);
+		return false;
+	}
+
+	std::vector<Vec3> positions;
+	std::vector<Vec2> texCoords;
+	std::vector<Vec3> normals;
+	//the same position/texcoord/normal triple is the same vertex
+	std::unordered_map<ObjCorner, u32, ObjCornerHash> corners;
+	std::vector<u32> polygon;
+	u32 submesh = FindSubmesh(mesh, "default");
+	TextParser line;
+	while (!parser.AtEnd())
+	{
+		const std::string_view text = parser.NextLine();
+		line.SetText(text.data(), text.size());
+		const std::string_view keyword = line.NextToken();
+		if (keyword == "v")
+		{
+			const f32 x = line.NextFloat();
+			const f32 y = line.NextFloat();
+			positions.push_back(Vec3(x, y, line.NextFloat()));
+		}
+		else if (keyword == "vt")
+		{
+			const f32 u = line.NextFloat();
+			texCoords.push_back(Vec2(u, line.NextFloat()));
+		}
+		else if (keyword == "vn")
+		{
+			const f32 x = line.NextFloat();
+			const f32 y = line.NextFloat();
+			normals.push_back(Vec3(x, y, line.NextFloat()));
+		}
+		else if (keyword == "f")
+		{
+			polygon.clear();
+			for (std::string_view token = line.NextToken(); !token.empty(); token = line.NextToken())
+			{
+				//v, v/vt, v//vn or v/vt/vn
+				const char* p = token.data();
+				const char* end = token.data() + token.size();
+				ObjCorner corner{ 0, ~0u, ~0u };
+				s64 index;
+				size_t used = ParseInt(p, end, index);
+				bool valid = used && ResolveObjIndex(index, positions.size(), corner.position);
+				p += used;
+				if (valid && p < end && *p == '/')
+				{
+					p++;
+					used = ParseInt(p, end, index);
+					if (used) valid = ResolveObjIndex(index, texCoords.size(), corner.texCoord);
+					p += used;
+					if (valid && p < end && *p == '/')
+					{
+						p++;
+						used = ParseInt(p, end, index);
+						valid = used && ResolveObjIndex(index, normals.size(), corner.normal);
+						p += used;
+					}
+				}
+				if (!valid || p != end)
+				{
+					fprintf(stderr, "MeshCooker: bad face corner %.*s in %s\n", (int)token.size(), token.data(), path);
+					return false;
+				}
+
+				auto found = corners.find(corner);
+				if (found == corners.end())
+				{
+					Vertex vertex;
+					vertex.position = positions[corner.position];
+					if (corner.normal != ~0u) vertex.normal = normals[corner.normal];
+					if (corner.texCoord != ~0u)
+					{
+						vertex.texCoord = texCoords[corner.texCoord];
+						mesh.hasTexCoords = true;
+					}
+					found = corners.emplace(corner, AddVertex(mesh, vertex, corner.normal != ~0u)).first;
+				}
+				polygon.push_back(found->second);
+			}
+			//convex polygons as fans
+			std::vector<u32>& indices = mesh.submeshes[submesh].indices;
+			for (size_t i = 2; i < polygon.size(); i++)
+			{
+				indices.push_back(polygon[0]);
+				indices.push_back(polygon[i - 1]);
+				indices.push_back(polygon[i]);
+			}
+		}
+		else if (keyword == "usemtl")
+		{
+			submesh = FindSubmesh(mesh, Trim(std::string_view(line.GetText() + line.GetPosition(), line.GetSize() - line.GetPosition())));
+		}
+		//o, g, s, mtllib and comments don't change the geometry
+	}
+	return true;
+}
+
+//3ds Max is Z up, a rotation so the winding stays
+static Vec3 AseToYUp(f32 x, f32 y, f32 z)
+{
+	return Vec3(x, z, -y);
+}
+
+struct AseFace
+{
+	u32 positions[3];
+	u32 texCoords[3];
+	Vec3 normals[3];
+	u32 normalCount;
+	bool hasTexCoords;
+};
+
+//"A:" followed by the index, or "A:12" in one token
+static bool ReadAseCorner(TextParser& parser, u32& index)
+{
+	const std::string_view label = parser.NextToken();
+	s64 value;
+	const size_t used = label.size() > 2 ? ParseInt(label.data() + 2, label.data() + label.size(), value) : 0;
+	if (!used)
+	{
+		const std::string_view number = parser.NextToken();
+		if (!ParseInt(number.data(), number.data() + number.size(), value)) return false;
+	}
+	index = (u32)value;
+	return value >= 0;
+}
+
+static bool LoadAse(const char* path, SourceMesh& mesh)
+{
+	TextParser parser;
+	if (!parser.Open(path))
+	{
+		fprintf(stderr, "MeshCooker: can't open %s\n", path);
+		return false;
+	}
+
+	//per object, indices restart in every *GEOMOBJECT
+	std::vector<Vec3> positions;
+	std::vector<Vec2> texCoords;
+	std::vector<AseFace> faces;
+	std::string name = "object";
+	u32 normalFace = ~0u;
+	bool valid = true;
+
+	auto flush = [&]()
+	{
+		if (!faces.empty())
+		{
+			std::vector<u32>& indices = mesh.submeshes[FindSubmesh(mesh, name)].indices;
+			for (const AseFace& face : faces)
+			{
+				if (face.positions[0] >= positions.size() || face.positions[1] >= positions.size() || face.positions[2] >= positions.size())
+				{
+					valid = false;
+					continue;
+				}
+				//corners don't share vertices, normals and texture coordinates are per face corner
+				for (u32 corner = 0; corner < 3; corner++)
+				{
+					Vertex vertex;
+					vertex.position = positions[face.positions[corner]];
+					if (face.normalCount == 3) vertex.normal = face.normals[corner];
+					if (face.hasTexCoords && face.texCoords[corner] < texCoords.size())
+					{
+						vertex.texCoord = texCoords[face.texCoords[corner]];
+						mesh.hasTexCoords = true;
+					}
+					indices.push_back(AddVertex(mesh, vertex, face.normalCount == 3));
+				}
+			}
+		}
+		positions.clear();
+		texCoords.clear();
+		faces.clear();
+		normalFace = ~0u;
+	};
+
+	for (std::string_view token = parser.NextToken(); !token.empty() && valid; token = parser.NextToken())
+	{
+		if (token == "*GEOMOBJECT")
+		{
+			flush();
+			name = "object";
+		}
+		else if (token == "*NODE_NAME")
+		{
+			const std::string_view quoted = parser.NextQuoted();
+			if (quoted.data()) name = std::string(quoted);
+		}
+		else if (token == "*MESH_VERTEX")
+		{
+			const u32 index = (u32)parser.NextInt();
+			const f32 x = parser.NextFloat();
+			const f32 y = parser.NextFloat();
+			const f32 z = parser.NextFloat();
+			if (index >= positions.size()) positions.resize((size_t)index + 1);
+			positions[index] = AseToYUp(x, y, z);
+		}
+		else if (token == "*MESH_FACE")
+		{
+			//"12:" then the corners
+			const std::string_view label = parser.NextToken();
+			s64 index;
+			if (!ParseInt(label.data(), label.data() + label.size(), index) || index < 0)
+			{
+				valid = false;
+				break;
+			}
+			if ((size_t)index >= faces.size()) faces.resize((size_t)index + 1, AseFace{});
+			AseFace& face = faces[(size_t)index];
+			valid = ReadAseCorner(parser, face.positions[0]) && ReadAseCorner(parser, face.positions[1]) && ReadAseCorner(parser, face.positions[2]);
+		}
+		else if (token == "*MESH_TVERT")
+		{
+			const u32 index = (u32)parser.NextInt();
+			const f32 u = parser.NextFloat();
+			const f32 v = parser.NextFloat();
+			if (index >= texCoords.size()) texCoords.resize((size_t)index + 1);
+			texCoords[index] = Vec2(u, v);
+		}
+		else if (token == "*MESH_TFACE")
+		{
+			const u32 index = (u32)parser.NextInt();
+			if (index >= faces.size()) faces.resize((size_t)index + 1, AseFace{});
+			AseFace& face = faces[index];
+			for (u32 corner = 0; corner < 3; corner++)
+				face.texCoords[corner] = (u32)parser.NextInt();
+			face.hasTexCoords = true;
+		}
+		else if (token == "*MESH_FACENORMAL")
+		{
+			normalFace = (u32)parser.NextInt();
+			if (normalFace < faces.size()) faces[normalFace].normalCount = 0;
+		}
+		else if (token == "*MESH_VERTEXNORMAL")
+		{
+			//the three corners of the last face normal, in order
+			parser.NextInt();
+			const f32 x = parser.NextFloat();
+			const f32 y = parser.NextFloat();
+			const f32 z = parser.NextFloat();
+			if (normalFace < faces.size() && faces[normalFace].normalCount < 3)
+				faces[normalFace].normals[faces[normalFace].normalCount++] = AseToYUp(x, y, z);
+		}
+	}
+	if (!valid)
+	{
+		fprintf(stderr, "MeshCooker: %s has a face with a bad vertex index\n", path);
+		return false;
+	}
+	flush();
+	return true;
+}
+
+//area weighted, so small slivers don't bend the normals of big faces. Summed per position value:
+//exporters often write the positions of every face again, and the texture seams split vertices
+static void GenerateNormals(SourceMesh& mesh)
+{
+	if (std::find(mesh.hasNormal.begin(), mesh.hasNormal.end(), 0) == mesh.hasNormal.end()) return;
+
+	std::vector<Vec3> positions;
+	positions.reserve(mesh.vertices.size());
+	for (const Vertex& vertex : mesh.vertices)
+		positions.push_back(vertex.position);
+	std::vector<u32> positionIndices(positions.size());
+	const u32 positionCount = WeldVertices(positionIndices.data(), positions.data(), (u32)positions.size(), sizeof(Vec3));
+
+	std::vector<Vec3> sums(positionCount);
+	for (const Submesh& submesh : mesh.submeshes)
+	{
+		for (size_t i = 0; i + 2 < submesh.indices.size(); i += 3)
+		{
+			const u32 a = submesh.indices[i];
+			const u32 b = submesh.indices[i + 1];
+			const u32 c = submesh.indices[i + 2];
+			const Vec3 normal = Vec3::cross(positions[b] - positions[a], positions[c] - positions[a]);
+			sums[positionIndices[a]] = sums[positionIndices[a]] + normal;
+			sums[positionIndices[b]] = sums[positionIndices[b]] + normal;
+			sums[positionIndices[c]] = sums[positionIndices[c]] + normal;
+		}
+	}
+	for (size_t i = 0; i < mesh.vertices.size(); i++)
+	{
+		if (mesh.hasNormal[i]) continue;
+		const Vec3& sum = sums[positionIndices[i]];
+		mesh.vertices[i].normal = sum.sqrmod() > 0.0f ? sum.normalized() : Vec3(0.0f, 1.0f, 0.0f);
+	}
+}
+
+static void PrintCacheStats(const char* label, const SourceMesh& mesh)
+{
+	std::vector<u32> indices;
+	for (const Submesh& submesh : mesh.submeshes)
+		indices.insert(indices.end(), submesh.indices.begin(), submesh.indices.end());
+	const VertexCacheStats stats = AnalyzeVertexCache(indices.data(), (u32)indices.size(), (u32)mesh.vertices.size());
+	printf("  %-7s %9u vertices  %9u transformed  ACMR %.3f  ATVR %.3f\n", label, (u32)mesh.vertices.size(), stats.transformed, stats.acmr, stats.atvr);
+}
+
+//submeshes share the vertices, so welding and the fetch order are over the whole mesh and the
+//cache order per submesh
+static void Optimize(SourceMesh& mesh, const CookOptions& options)
+{
+	PrintCacheStats("source", mesh);
+
+	static_assert(sizeof(Vertex) == 32, "vertices are welded on their bytes, no padding");
+	std::vector<u32> remap(mesh.vertices.size());
+	const u32 unique = WeldVertices(remap.data(), mesh.vertices.data(), (u32)mesh.vertices.size(), sizeof(Vertex));
+	std::vector<Vertex> welded(unique);
+	RemapVertices(welded.data(), mesh.vertices.data(), (u32)mesh.vertices.size(), sizeof(Vertex), remap.data());
+	mesh.vertices.swap(welded);
+	mesh.hasNormal.clear();
+
+	std::vector<Vec3> positions;
+	if (options.overdraw)
+	{
+		positions.reserve(unique);
+		for (const Vertex& vertex : mesh.vertices)
+			positions.push_back(vertex.position);
+	}
+	std::vector<u32> indices;
+	for (Submesh& submesh : mesh.submeshes)
+	{
+		u32* data = submesh.indices.data();
+		const u32 count = (u32)submesh.indices.size();
+		RemapIndices(data, data, count, remap.data());
+		if (options.tipsify) OptimizeVertexCacheTipsify(data, data, count, unique);
+		else OptimizeVertexCache(data, data, count, unique);
+		if (options.overdraw) OptimizeOverdraw(data, data, count, positions.data(), unique);
+		indices.insert(indices.end(), submesh.indices.begin(), submesh.indices.end());
+	}
+
+	const u32 used = OptimizeVertexFetch(remap.data(), indices.data(), (u32)indices.size(), unique);
+	std::vector<Vertex> fetched(used);
+	RemapVertices(fetched.data(), mesh.vertices.data(), unique, sizeof(Vertex), remap.data());
+	mesh.vertices.swap(fetched);
+	size_t first = 0;
+	for (Submesh& submesh : mesh.submeshes)
+	{
+		memcpy(submesh.indices.data(), indices.data() + first, submesh.indices.size() * sizeof(u32));
+		first += submesh.indices.size();
+	}
+
+	PrintCacheStats("cooked", mesh);
+}
+
+static void Grow(f32 boundsMin[3], f32 boundsMax[3], const Vec3& p)
+{
+	for (u32 axis = 0; axis < 3; axis++)
+	{
+		boundsMin[axis] = p.values[axis] < boundsMin[axis] ? p.values[axis] : boundsMin[axis];
+		boundsMax[axis] = p.values[axis] > boundsMax[axis] ? p.values[axis] : boundsMax[axis];
+	}
+}
+
+static void ResetBounds(f32 boundsMin[3], f32 boundsMax[3])
+{
+	for (u32 axis = 0; axis < 3; axis++)
+	{
+		boundsMin[axis] = FLT_MAX;
+		boundsMax[axis] = -FLT_MAX;
+	}
+}
+
+static void AddAttribute(MeshFileHeader& header, MeshAttribute attribute, VertexFormat format, bool split)
+{
+	MeshAttributeDesc& desc = header.attributes[header.attributeCount++];
+	desc.attribute = attribute;
+	desc.format = format;
+	const u32 size = GetVertexFormatSize(format);
+	if (split)
+	{
+		desc.stream = header.streamCount++;
+		desc.offset = 0;
+		header.streams[desc.stream].stride = size;
+	}
+	else
+	{
+		if (header.streamCount == 0) header.streamCount = 1;
+		desc.stream = 0;
+		desc.offset = header.streams[0].stride;
+		header.streams[0].stride += size;
+	}
+}
+
+static void EncodeAttribute(const MeshAttributeDesc& desc, const Vertex& vertex, const AABB& bounds, u8* out)
+{
+	switch (desc.format)
+	{
+	case VertexFormat::Float32x3:
+	{
+		const Vec3& value = desc.attribute == MeshAttribute::Position ? vertex.position : vertex.normal;
+		memcpy(out, value.values, 12);
+		break;
+	}
+	case VertexFormat::Float32x2:
+		memcpy(out, &vertex.texCoord, 8);
+		break;
+	case VertexFormat::Snorm16x4:
+	{
+		const PackedPosition packed = Pack::packPosition(vertex.position, bounds);
+		const s16 values[4] = { packed.x, packed.y, packed.z, 0 };
+		memcpy(out, values, 8);
+		break;
+	}
+	case VertexFormat::Snorm16x2:
+	{
+		const OctNormal packed = Pack::encodeNormal(vertex.normal);
+		memcpy(out, &packed, 4);
+		break;
+	}
+	case VertexFormat::Half16x2:
+	{
+		const u16 values[2] = { Pack::floatToHalf(vertex.texCoord.x), Pack::floatToHalf(vertex.texCoord.y) };
+		memcpy(out, values, 4);
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+static VertexFormat GetFormat(MeshAttribute attribute, const CookOptions& options)
+{
+	switch (attribute)
+	{
+	case MeshAttribute::Position: return options.packed ? VertexFormat::Snorm16x4 : VertexFormat::Float32x3;
+	case MeshAttribute::Normal: return options.packed ? VertexFormat::Snorm16x2 : VertexFormat::Float32x3;
+	case MeshAttribute::TexCoord: return options.packed ? VertexFormat::Half16x2 : VertexFormat::Float32x2;
+	default: return VertexFormat::Count;
+	}
+}
+
+static u32 GetIndexSize(u32 vertexCount, const CookOptions& options)
+{
+	return !options.index32 && vertexCount <= 65536 ? 2 : 4;
+}
+
+static u32 GetCookFlags(const CookOptions& options)
+{
+	if (options.raw) return MESH_COOK_RAW;
+	return (options.tipsify ? (u32)MESH_COOK_TIPSIFY : 0u) | (options.overdraw ? (u32)MESH_COOK_OVERDRAW : 0u);
+}
+
+//the output has to be newer than the input and laid out the way the options ask for
+static bool IsUpToDate(const CookOptions& options)
+{
+	std::error_code error;
+	const auto outputTime = std::filesystem::last_write_time(options.output, error);
+	if (error) return false;
+	const auto inputTime = std::filesystem::last_write_time(options.input, error);
+	if (error || outputTime < inputTime) return false;
+
+	MeshFileHeader header;
+	FILE* file = fopen(options.output, "rb");
+	if (!file) return false;
+	const bool read = fread(&header, sizeof(header), 1, file) == 1;
+	fclose(file);
+	if (!read || header.magic != MESH_FILE_MAGIC || header.version != MESH_FILE_VERSION) return false;
+	if (header.attributeCount == 0 || header.attributeCount > MESH_MAX_ATTRIBUTES) return false;
+	if (header.cookFlags != GetCookFlags(options)) return false;
+	if (header.indexSize != GetIndexSize(header.vertexCount, options)) return false;
+	if (header.streamCount != (options.split ? header.attributeCount : 1)) return false;
+	for (u32 i = 0; i < header.attributeCount; i++)
+	{
+		if (header.attributes[i].format != GetFormat(header.attributes[i].attribute, options)) return false;
+	}
+	return true;
+}
+
+static bool Cook(const CookOptions& options)
+{
+	std::string extension = std::filesystem::path(options.input).extension().string();
+	for (char& c : extension)
+		c = (char)tolower((u8)c);
+
+	SourceMesh mesh;
+	if (extension == ".obj")
+	{
+		if (!LoadObj(options.input, mesh)) return false;
+	}
+	else if (extension == ".ase")
+	{
+		if (!LoadAse(options.input, mesh)) return false;
+	}
+	else
+	{
+		fprintf(stderr, "MeshCooker: %s isn't an .obj or .ase file\n", options.input);
+		return false;
+	}
+	if (mesh.vertices.empty())
+	{
+		fprintf(stderr, "MeshCooker: %s has no faces\n", options.input);
+		return false;
+	}
+	GenerateNormals(mesh);
+	if (!options.raw) Optimize(mesh, options);
+
+	MeshFileHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = MESH_FILE_MAGIC;
+	header.version = MESH_FILE_VERSION;
+	header.cookFlags = GetCookFlags(options);
+	header.vertexCount = (u32)mesh.vertices.size();
+	header.indexSize = GetIndexSize(header.vertexCount, options);
+
+	ResetBounds(header.boundsMin, header.boundsMax);
+	for (const Vertex& vertex : mesh.vertices)
+		Grow(header.boundsMin, header.boundsMax, vertex.position);
+	const AABB bounds(Vec3(header.boundsMin), Vec3(header.boundsMax));
+
+	AddAttribute(header, MeshAttribute::Position, GetFormat(MeshAttribute::Position, options), options.split);
+	AddAttribute(header, MeshAttribute::Normal, GetFormat(MeshAttribute::Normal, options), options.split);
+	if (mesh.hasTexCoords)
+		AddAttribute(header, MeshAttribute::TexCoord, GetFormat(MeshAttribute::TexCoord, options), options.split);
+
+	//empty materials are dropped, the rest follow each other in the index buffer
+	std::vector<MeshSubmesh> submeshes;
+	for (const Submesh& source : mesh.submeshes)
+	{
+		if (source.indices.empty()) continue;
+		MeshSubmesh submesh;
+		memset(&submesh, 0, sizeof(submesh));
+		submesh.firstIndex = header.indexCount;
+		submesh.indexCount = (u32)source.indices.size();
+		ResetBounds(submesh.boundsMin, submesh.boundsMax);
+		u32 firstVertex = ~0u;
+		u32 lastVertex = 0;
+		for (u32 index : source.indices)
+		{
+			firstVertex = index < firstVertex ? index : firstVertex;
+			lastVertex = index > lastVertex ? index : lastVertex;
+			Grow(submesh.boundsMin, submesh.boundsMax, mesh.vertices[index].position);
+		}
+		submesh.firstVertex = firstVertex;
+		submesh.vertexCount = lastVertex - firstVertex + 1;
+		memcpy(submesh.name, source.name.c_str(), source.name.size() + 1);
+		submeshes.push_back(submesh);
+		header.indexCount += submesh.indexCount;
+	}
+	header.submeshCount = (u32)submeshes.size();
+
+	u64 offset = sizeof(MeshFileHeader);
+	header.submeshOffset = offset;
+	offset += submeshes.size() * sizeof(MeshSubmesh);
+	for (u32 stream = 0; stream < header.streamCount; stream++)
+	{
+		offset = Memory::alignUp(offset, MESH_DATA_ALIGNMENT);
+		header.streams[stream].offset = offset;
+		header.streams[stream].size = (u64)header.streams[stream].stride * header.vertexCount;
+		offset += header.streams[stream].size;
+	}
+	offset = Memory::alignUp(offset, MESH_DATA_ALIGNMENT);
+	header.indexOffset = offset;
+	header.fileSize = offset + (u64)header.indexCount * header.indexSize;
+
+	std::vector<u8> file((size_t)header.fileSize, 0);
+	memcpy(file.data(), &header, sizeof(header));
+	if (!submeshes.empty()) memcpy(file.data() + header.submeshOffset, submeshes.data(), submeshes.size() * sizeof(MeshSubmesh));
+	for (u32 i = 0; i < header.attributeCount; i++)
+	{
+		const MeshAttributeDesc& desc = header.attributes[i];
+		const MeshStreamDesc& stream = header.streams[desc.stream];
+		u8* out = file.data() + stream.offset + desc.offset;
+		for (const Vertex& vertex : mesh.vertices)
+		{
+			EncodeAttribute(desc, vertex, bounds, out);
+			out += stream.stride;
+		}
+	}
+	u8* indexOut = file.data() + header.indexOffset;
+	for (const Submesh& source : mesh.submeshes)
+	{
+		for (u32 index : source.indices)
+		{
+			if (header.indexSize == 2)
+			{
+				const u16 narrow = (u16)index;
+				memcpy(indexOut, &narrow, 2);
+			}
+			else memcpy(indexOut, &index, 4);
+			indexOut += header.indexSize;
+		}
+	}
+
+	if (!ValidateMeshFile(file.data(), file.size()))
+	{
+		fprintf(stderr, "MeshCooker: internal error, the container for %s doesn't validate\n", options.input);
+		return false;
+	}
+
+	//written next to the output and renamed over it, hot reload never sees a half written file
+	const std::string temporary = std::string(options.output) + ".tmp";
+	FILE* output = fopen(temporary.c_str(), "wb");
+	if (!output)
+	{
+		fprintf(stderr, "MeshCooker: can't write %s\n", temporary.c_str());
+		return false;
+	}
+	const bool written = fwrite(file.data(), 1, file.size(), output) == file.size();
+	if (fclose(output) != 0 || !written)
+	{
+		fprintf(stderr, "MeshCooker: can't write %s\n", temporary.c_str());
+		remove(temporary.c_str());
+		return false;
+	}
+	std::error_code error;
+	std::filesystem::rename(temporary, options.output, error);
+	if (error)
+	{
+		fprintf(stderr, "MeshCooker: can't replace %s: %s\n", options.output, error.message().c_str());
+		remove(temporary.c_str());
+		return false;
+	}
+
+	printf("%s -> %s  %u vertices  %u triangles  %u submeshes  %u bit indices  %s %s  %.2f MB\n", options.input, options.output,
+		header.vertexCount, header.indexCount / 3, header.submeshCount, header.indexSize * 8,
+		options.split ? "split" : "interleaved", options.packed ? "packed" : "float", (f64)header.fileSize / (1024.0 * 1024.0));
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	CookOptions options;
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--split")) options.split = true;
+		else if (!strcmp(argv[i], "--packed")) options.packed = true;
+		else if (!strcmp(argv[i], "--index32")) options.index32 = true;
+		else if (!strcmp(argv[i], "--tipsify")) options.tipsify = true;
+		else if (!strcmp(argv[i], "--overdraw")) options.overdraw = true;
+		else if (!strcmp(argv[i], "--raw")) options.raw = true;
+		else if (!strcmp(argv[i], "--force")) options.force = true;
+		else if (!options.input) options.input = argv[i];
+		else if (!options.output) options.output = argv[i];
+		else
+		{
+			fprintf(stderr, "MeshCooker: unexpected argument %s\n", argv[i]);
+			return 1;
+		}
+	}
+	if (!options.input || !options.output)
+	{
+		fprintf(stderr, "usage: MeshCooker [--split] [--packed] [--index32] [--tipsify] [--overdraw] [--raw] [--force] input output\n");
+		return 1;
+	}
+
+	if (!options.force && IsUpToDate(options))
+	{
+		printf("%s is up to date\n", options.output);
+		return 0;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	if (!Cook(options)) return 1;
+	const f64 ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+	printf("cooked in %.1f ms\n", ms);
+	return 0;
+}
@@ -0,0 +1,324 @@
+#define SDL_MAIN_HANDLED
+#include "wf_pch.h"
+#include "wf_text_parser.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <random>
+#include <sys/stat.h>
+#include <vector>
+
+//ParserBench: wf_text_parser.h against the old heap copying TextParser on a generated OBJ file
+//usage: ParserBench [--size MB] [--file path] [--reps N] [--filter substring] [--check]
+//--check compares ParseFloat with strtod on edge cases and random numbers instead, exit code 1 if one differs
+//the file is generated once and kept (delete it or pass another path to change the size),
+//the first repetition warms the file cache and isn't counted
+
+using namespace Wolf;
+
+struct BenchConfig
+{
+	u32 sizeMB = 256;
+	u32 reps = 3;
+	std::string file;
+	const char* filter = nullptr;
+	bool check = false;
+};
+
+static BenchConfig config;
+static volatile f64 sink;
+
+//the old parser as it was, one file read into a heap copy, getword rescanning and upper casing
+//through a std::string, atof for every number and countword restarting from the top
+class LegacyTextParser
+{
+public:
+	~LegacyTextParser() { delete[] data; }
+
+	bool create(const char* name)
+	{
+		struct stat info;
+		if (stat(name, &info) != 0) return false;
+		FILE* f = fopen(name, "rb");
+		if (!f) return false;
+		size = (u32)info.st_size;
+		data = new char[size];
+		sl = 0;
+		const bool read = fread(data, size, 1, f) == 1;
+		fclose(f);
+		return read;
+	}
+
+	char* getword()
+	{
+		u32 p0 = sl;
+		if (p0 >= size) return nullptr;
+		while (!legal(data[p0]) && p0 < size) p0++;
+		if (p0 >= size) return nullptr;
+		u32 p1 = p0 + 1;
+		while (p1 < size && legal(data[p1])) p1++;
+		for (u32 i = p0; i < p1; i++)
+		{
+			if (data[i] <= 'z' && data[i] >= 'a') data[i] += 'A' - 'a';
+			word[i - p0] = data[i];
+		}
+		word[p1 - p0] = '\0';
+		sl = p1;
+		std::string s(word);
+		std::transform(s.begin(), s.end(), s.begin(), toupper);
+		strcpy(word, s.c_str());
+		return word;
+	}
+
+	double getfloat() { return atof(getword()); }
+	int getint() { return atoi(getword()); }
+
+	int countword(const char* s)
+	{
+		const u32 length = (u32)strlen(s);
+		int res = 0;
+		u32 i = 0;
+		while (i < size)
+		{
+			u32 si = 0;
+			while (i < size && toupper(data[i]) == toupper(s[si])) { i++; si++; }
+			res += si == length;
+			i += si + 1;
+		}
+		return res;
+	}
+
+private:
+	static bool legal(char c) { return c > 32; }
+
+	char* data = nullptr;
+	u32 sl = 0;
+	u32 size = 0;
+	char word[256];
+};
+
+static f64 Percentile(const std::vector<f64>& sorted, f64 p)
+{
+	size_t i = (size_t)(p * sorted.size());
+	if (i >= sorted.size()) i = sorted.size() - 1;
+	return sorted[i];
+}
+
+template<typename F>
+static void Bench(const char* name, u64 bytes, F&& body)
+{
+	if (config.filter && !strstr(name, config.filter)) return;
+
+	typedef std::chrono::steady_clock Clock;
+	std::vector<f64> samples;
+	for (u32 r = 0; r < config.reps + 1; r++)
+	{
+		Clock::time_point start = Clock::now();
+		body();
+		const f64 ms = std::chrono::duration<f64, std::milli>(Clock::now() - start).count();
+		if (r > 0) samples.push_back(ms);
+	}
+	std::sort(samples.begin(), samples.end());
+	const f64 p50 = Percentile(samples, 0.5);
+	printf("%-28s min %9.1f  p50 %9.1f ms  %8.1f MB/s\n", name, samples.front(), p50, (f64)bytes / (1024.0 * 1024.0) / (p50 / 1000.0));
+}
+
+//vertices, texture coordinates, normals and triangles in the proportions of an exported mesh
+static bool Generate(const std::string& path, u64 bytes)
+{
+	FILE* file = fopen(path.c_str(), "wb");
+	if (!file) return false;
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<f32> position(-100.0f, 100.0f);
+	std::uniform_real_distribution<f32> unit(-1.0f, 1.0f);
+	std::uniform_int_distribution<u32> index(1, 100000);
+	fprintf(file, "# ParserBench mesh\no Generated\n");
+	u64 written = 0;
+	char line[256];
+	while (written < bytes)
+	{
+		int length = snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.6f %.6f %.6f\n",
+			position(rng), position(rng), position(rng), unit(rng) * 0.5f + 0.5f, unit(rng) * 0.5f + 0.5f, unit(rng), unit(rng), unit(rng));
+		length += snprintf(line + length, sizeof(line) - length, "f %u/%u/%u %u/%u/%u %u/%u/%u\n",
+			index(rng), index(rng), index(rng), index(rng), index(rng), index(rng), index(rng), index(rng), index(rng));
+		fwrite(line, 1, (size_t)length, file);
+		written += (u64)length;
+	}
+	return fclose(file) == 0;
+}
+
+//sum of everything the mesh holds, both parsers have to agree on it
+struct MeshTotals
+{
+	f64 sum = 0.0;
+	u64 faces = 0;
+};
+
+static MeshTotals ParseLegacy(const char* path)
+{
+	MeshTotals totals;
+	LegacyTextParser parser;
+	if (!parser.create(path)) return totals;
+	for (char* word = parser.getword(); word; word = parser.getword())
+	{
+		//words come back upper cased
+		if (!strcmp(word, "V") || !strcmp(word, "VN")) totals.sum += parser.getfloat() + parser.getfloat() + parser.getfloat();
+		else if (!strcmp(word, "VT")) totals.sum += parser.getfloat() + parser.getfloat();
+		else if (!strcmp(word, "F"))
+		{
+			totals.sum += parser.getint() + parser.getint() + parser.getint();
+			totals.faces++;
+		}
+	}
+	return totals;
+}
+
+static MeshTotals ParseMapped(const char* path)
+{
+	MeshTotals totals;
+	TextParser parser;
+	if (!parser.Open(path)) return totals;
+	for (std::string_view word = parser.NextToken(); !word.empty(); word = parser.NextToken())
+	{
+		if (word == "v" || word == "vn") totals.sum += parser.NextDouble() + parser.NextDouble() + parser.NextDouble();
+		else if (word == "vt") totals.sum += parser.NextDouble() + parser.NextDouble();
+		else if (word == "f")
+		{
+			//the vertex index of every corner, ParseInt stops at the '/'
+			totals.sum += parser.NextInt() + parser.NextInt() + parser.NextInt();
+			totals.faces++;
+		}
+	}
+	return totals;
+}
+
+//same bits as strtod (the program runs in the C locale) and the whole text used
+static bool ParsesLikeStrtod(const char* text)
+{
+	const size_t length = strlen(text);
+	f64 value = -1.0;
+	char* strtodEnd;
+	const f64 expected = strtod(text, &strtodEnd);
+	return ParseFloat(text, text + length, value) == (size_t)(strtodEnd - text) && memcmp(&value, &expected, sizeof(f64)) == 0;
+}
+
+static bool CheckParseFloat()
+{
+	//overflow, underflow to 0, subnormals and the boundaries between them
+	static const char* edges[] =
+	{
+		"0", "-0", "1e-400", "-1e-400", "1e400", "-1e400", "1e-310", "-1e-310", "4.9e-324", "5e-324",
+		"2.4703282292062327e-324", "2.4703282292062328e-324", "2.2250738585072011e-308", "2.2250738585072014e-308",
+		"1.7976931348623157e308", "1.7976931348623158e308", "1.7976931348623159e308", "123456789012345678901234567890e-340",
+		"0.000000000000000000000000000000000000000000000000001e-280", "1e22", "1e23", "9007199254740993", "inf", "-nan",
+	};
+	u32 wrong = 0;
+	for (const char* text : edges)
+	{
+		if (ParsesLikeStrtod(text)) continue;
+		if (wrong++ < 8) printf("  ParseFloat(\"%s\") differs from strtod\n", text);
+	}
+
+	//every binary64 bit pattern class, subnormals included, round trips through %.17g, and
+	//random decimals across the whole exponent range round like strtod
+	std::mt19937_64 rng(1234);
+	const u32 count = 1000000;
+	char text[64];
+	for (u32 i = 0; i < count; i++)
+	{
+		if (i & 1)
+		{
+			u64 bits = rng();
+			if (i & 2) bits &= 0x800fffffffffffffull;
+			f64 value;
+			memcpy(&value, &bits, sizeof(f64));
+			if (value != value) continue;
+			snprintf(text, sizeof(text), "%.17g", value);
+		}
+		else snprintf(text, sizeof(text), "%llu.%llue%d", (unsigned long long)(rng() % 100000000000ull), (unsigned long long)(rng() % 1000000000ull), (s32)(rng() % 700) - 350);
+		if (ParsesLikeStrtod(text)) continue;
+		if (wrong++ < 8) printf("  ParseFloat(\"%s\") differs from strtod\n", text);
+	}
+	printf("%-32s %s (%u of %u differ)\n", "parse.float", wrong ? "FAIL" : "ok", wrong, count + (u32)(sizeof(edges) / sizeof(edges[0])));
+	return wrong == 0;
+}
+
+int main(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--size") && i + 1 < argc) config.sizeMB = (u32)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--file") && i + 1 < argc) config.file = argv[++i];
+		else if (!strcmp(argv[i], "--reps") && i + 1 < argc) config.reps = (u32)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--filter") && i + 1 < argc) config.filter = argv[++i];
+		else if (!strcmp(argv[i], "--check")) config.check = true;
+		else
+		{
+			fprintf(stderr, "usage: ParserBench [--size MB] [--file path] [--reps N] [--filter substring] [--check]\n");
+			return 1;
+		}
+	}
+	if (config.check) return CheckParseFloat() ? 0 : 1;
+	if (config.reps == 0) config.reps = 1;
+	if (config.file.empty())
+		config.file = (std::filesystem::temp_directory_path() / ("parser_bench_" + std::to_string(config.sizeMB) + "mb.obj")).string();
+
+	std::error_code error;
+	if (!std::filesystem::exists(config.file, error))
+	{
+		printf("generating %s\n", config.file.c_str());
+		if (!Generate(config.file, (u64)config.sizeMB * 1024 * 1024))
+		{
+			fprintf(stderr, "ParserBench: can't write %s\n", config.file.c_str());
+			return 1;
+		}
+	}
+	const u64 bytes = std::filesystem::file_size(config.file, error);
+	printf("%s  %.1f MB\n\n", config.file.c_str(), (f64)bytes / (1024.0 * 1024.0));
+	const char* path = config.file.c_str();
+
+	//same file, same numbers: the fast float path has to round like strtod
+	const MeshTotals legacy = ParseLegacy(path);
+	const MeshTotals mapped = ParseMapped(path);
+	if (legacy.faces != mapped.faces || legacy.sum != mapped.sum)
+	{
+		fprintf(stderr, "ParserBench: results differ, legacy %.17g %llu, mapped %.17g %llu\n",
+			legacy.sum, (unsigned long long)legacy.faces, mapped.sum, (unsigned long long)mapped.faces);
+		return 1;
+	}
+
+	Bench("obj legacy", bytes, [path] { sink = ParseLegacy(path).sum; });
+	Bench("obj mapped", bytes, [path] { sink = ParseMapped(path).sum; });
+
+	Bench("open legacy", bytes, [path] { LegacyTextParser parser; sink = parser.create(path); });
+	Bench("open mapped", bytes, [path] { TextParser parser; sink = parser.Open(path); });
+
+	//sizing the arrays before parsing: one rescan per word against one pass for all of them
+	Bench("count legacy", bytes, [path]
+	{
+		LegacyTextParser parser;
+		parser.create(path);
+		sink = parser.countword("v ") + parser.countword("vt ") + parser.countword("vn ") + parser.countword("f ");
+	});
+	Bench("count mapped", bytes, [path]
+	{
+		TextParser parser;
+		parser.Open(path);
+		const std::string_view words[] = { "v", "vt", "vn", "f" };
+		u32 counts[4];
+		parser.CountTokens(words, 4, counts);
+		sink = counts[0] + counts[1] + counts[2] + counts[3];
+	});
+
+	Bench("tokens mapped", bytes, [path]
+	{
+		TextParser parser;
+		parser.Open(path);
+		u64 total = 0;
+		for (std::string_view word = parser.NextToken(); !word.empty(); word = parser.NextToken())
+			total += word.size();
+		sink = (f64)total;
+	});
+	return 0;
+}
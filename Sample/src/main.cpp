@@ -1,66 +1,182 @@
 #include "wf_pch.h"
 #include <iostream>
+#ifndef WF_HEADLESS
 #include "sdl_window.h"
+#endif
+#include "headless_window.h"
+#include "application.h"
 #include "wf_debug.h"
+#include "wf_profiler.h"
+#include "wf_memory.h"
 
-bool show_demo_window = true;
-bool close = false;
-
-int main(int argc, char* argv[])
+class SampleApp : public Wolf::Application
 {
-    std::cout << "HELLO WORLD" << std::endl;
-    Wolf::SDL_WINDOW* window = new Wolf::SDL_WINDOW("Wolf3D", 800, 600, SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
-	SDL_GLContext glcontext = SDL_GL_CreateContext(window->sdl_window);
-	WF_ASSERT(false, "a");
-	WF_ASSERT_ALWAYS(false, "b");
+public:
+	SampleApp(Wolf::Window* a_window, const Wolf::FrameSchedulerConfig& config)
+		: Application(a_window, config)
+#ifndef WF_HEADLESS
+		, sdlWindow(a_window->IsHeadless() ? nullptr : (Wolf::SDL_WINDOW*)a_window)
+#endif
+	{}
 
-	if (!gladLoadGLLoader((GLADloadproc)SDL_GL_GetProcAddress))
+	void StartUp() override
 	{
-		WF_LOGERROR("Failed initializing GLAD opengl context");
-		return -1;
-	}
-	int interval = SDL_GL_SetSwapInterval(0);
+		//headless runs only simulate, no GL context or ImGui
+#ifndef WF_HEADLESS
+		if (!sdlWindow) return;
 
-	int windowWidth, windowHeight;
-	SDL_GetWindowSize(window->sdl_window, &windowWidth, &windowHeight);
-	glViewport(0, 0, windowWidth, windowHeight);
+		glcontext = SDL_GL_CreateContext(sdlWindow->sdl_window);
+		if (!gladLoadGLLoader((GLADloadproc)SDL_GL_GetProcAddress))
+		{
+			WF_LOGERROR("Failed initializing GLAD opengl context");
+			needsShutDown = true;
+			return;
+		}
+		//the scheduler limits the frame rate, vsync would fight it
+		window->SetVSync(false);
 
-	//IMGUI
-	IMGUI_CHECKVERSION();
-	ImGui::CreateContext();
-	ImGuiIO& io = ImGui::GetIO(); (void)io;
-	ImGui::StyleColorsDark();
+		//IMGUI, its allocations are charged to the ImGui tag
+		IMGUI_CHECKVERSION();
+		ImGui::SetAllocatorFunctions(
+			[](size_t size, void*) { return Wolf::Memory::Allocate(size, Wolf::MemoryTag::ImGui); },
+			[](void* memory, void*) { Wolf::Memory::Free(memory); });
+		Wolf::Memory::SetBudget(Wolf::MemoryTag::ImGui, 16 * 1024 * 1024);
+		ImGui::CreateContext();
+		ImGuiIO& io = ImGui::GetIO(); (void)io;
+		ImGui::StyleColorsDark();
 
-	io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;       // Enable Keyboard Controls
-	//io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;           // Enable Docking
-	//io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;         // Enable Multi-Viewport / Platform Windows
+		io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;       // Enable Keyboard Controls
+		//io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;           // Enable Docking
+		//io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;         // Enable Multi-Viewport / Platform Windows
 
-	ImGui_ImplSDL2_InitForOpenGL(window->sdl_window, glcontext);
-	ImGui_ImplOpenGL3_Init();
+		ImGui_ImplSDL2_InitForOpenGL(sdlWindow->sdl_window, glcontext);
+		ImGui_ImplOpenGL3_Init();
+#endif
+	}
 
-	while (!close) 
+	void FixedUpdate(float deltaTime) override
 	{
-		SDL_Event evnt;
-		while (SDL_PollEvent(&evnt) != 0)
-		{
-			ImGui_ImplSDL2_ProcessEvent(&evnt);
-			if (evnt.type == SDL_QUIT) close = true;
-		}
+		previousAngle = angle;
+		angle += deltaTime * 90.0f;
+	}
+
+	void Render(float alpha) override
+	{
+#ifdef WF_HEADLESS
+		(void)alpha;
+#else
+		if (!sdlWindow) return;
+
 		ImGui_ImplOpenGL3_NewFrame();
-		ImGui_ImplSDL2_NewFrame(window->sdl_window);
+		ImGui_ImplSDL2_NewFrame(sdlWindow->sdl_window);
 		ImGui::NewFrame();
 		if (show_demo_window) ImGui::ShowDemoWindow(&show_demo_window);
+
+		ImGui::Begin("Frame");
+		ImGui::Text("frame %.2f ms, %llu fixed steps, alpha %.2f", scheduler.GetFrameDeltaTime() * 1000.0f, (unsigned long long)scheduler.GetFixedStepIndex(), alpha);
+		ImGui::Text("angle %.1f", previousAngle + (angle - previousAngle) * alpha);
+		ImGui::Checkbox("Profiler", &show_profiler);
+		ImGui::SameLine();
+		ImGui::Checkbox("Memory", &show_memory);
+		ImGui::End();
+		if (show_profiler) Wolf::Profiler::DrawImGui(&show_profiler);
+		if (show_memory) Wolf::Memory::DrawImGui(&show_memory);
 		ImGui::Render();
+
+		glViewport(0, 0, window->width, window->height);
 		glClearColor(0.2f, 0.2f, 0.2f, 1.f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-		SDL_GL_SwapWindow(window->sdl_window);
+		SDL_GL_SwapWindow(sdlWindow->sdl_window);
+#endif
+	}
+
+	void ShutDown() override
+	{
+#ifndef WF_HEADLESS
+		if (!sdlWindow)
+#endif
+		{
+			printf("headless: %llu frames, %llu fixed steps, angle %.1f\n", (unsigned long long)scheduler.GetFrameIndex(),
+				(unsigned long long)scheduler.GetFixedStepIndex(), angle);
+			return;
+		}
+#ifndef WF_HEADLESS
+
+		if (ImGui::GetCurrentContext())
+		{
+			ImGui_ImplOpenGL3_Shutdown();
+			ImGui_ImplSDL2_Shutdown();
+			ImGui::DestroyContext();
+		}
+		SDL_GL_DeleteContext(glcontext);
+#endif
+	}
+
+private:
+#ifndef WF_HEADLESS
+	Wolf::SDL_WINDOW* sdlWindow;
+	SDL_GLContext glcontext = nullptr;
+#endif
+	bool show_demo_window = true;
+	bool show_profiler = true;
+	bool show_memory = true;
+	float angle = 0.0f;
+	float previousAngle = 0.0f;
+};
+
+//usage: Sample [--headless] [--frames N] [--rate fps] [--trace frames] [--log file]
+//--headless runs without video, GL or ImGui with simulated time, as fast as possible unless --rate is given
+//a build made with premake5 --headless links no SDL2/GL and always runs headless
+//--trace writes the first frames to trace.json (chrome://tracing or ui.perfetto.dev)
+//--log also writes the log to file, the previous runs are kept as file.1, file.2, ...
+int main(int argc, char* argv[])
+{
+#ifdef WF_HEADLESS
+	bool headless = true;
+#else
+	bool headless = false;
+#endif
+	u64 frames = 0;
+	f64 rate = -1.0;
+	u32 traceFrames = 0;
+	const char* logPath = nullptr;
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--headless")) headless = true;
+		else if (!strcmp(argv[i], "--frames") && i + 1 < argc) frames = strtoull(argv[++i], nullptr, 10);
+		else if (!strcmp(argv[i], "--rate") && i + 1 < argc) rate = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--trace") && i + 1 < argc) traceFrames = (u32)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--log") && i + 1 < argc) logPath = argv[++i];
+	}
+	if (logPath)
+	{
+		Wolf::LoggerConfig logConfig;
+		logConfig.filePath = logPath;
+		Wolf::Logger::StartUp(logConfig);
+	}
+	if (traceFrames) Wolf::Profiler::BeginCapture(traceFrames, "trace.json");
+
+	Wolf::FrameSchedulerConfig config;
+	config.fixedDeltaTime = 1.0 / 60.0;
+	config.targetFrameRate = rate >= 0.0 ? rate : (headless ? 0.0 : 144.0);
+	config.simulatedTime = headless;
+
+	if (headless)
+	{
+		Wolf::HeadlessWindow window("Wolf3D", 800, 600, frames);
+		SampleApp app(&window, config);
+		app.Run();
+		Wolf::Logger::ShutDown();
+		return 0;
 	}
 
-	SDL_GL_DeleteContext(glcontext);
-	ImGui_ImplOpenGL3_Shutdown();
-	ImGui_ImplSDL2_Shutdown();
-	ImGui::DestroyContext();
-    delete(window);
-    return 0;
-}
\ No newline at end of file
+#ifndef WF_HEADLESS
+	std::cout << "HELLO WORLD" << std::endl;
+	Wolf::SDL_WINDOW window("Wolf3D", 800, 600, SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
+	SampleApp app(&window, config);
+	app.Run();
+	Wolf::Logger::ShutDown();
+	return 0;
+#endif
+}
@@ -0,0 +1,396 @@
+#define SDL_MAIN_HANDLED
+#include "wf_pch.h"
+#include "wf_texture_format.h"
+#include "wf_memory.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb/stb_image.h"
+
+#include <chrono>
+#include <filesystem>
+#include <vector>
+
+//TextureCooker: decodes an image with stb_image, builds the mip chain and writes the
+//.wtex container of wf_texture_format.h that CookedTexture memory maps at runtime
+//usage: TextureCooker [--linear] [--normal] [--wrap] [--no-mips] [--force] input output
+//--linear   the image isn't color (masks, roughness...), no sRGB conversion
+//--normal   tangent space normal map, implies --linear, mips are renormalized
+//--wrap     tiling texture, the mip filter wraps around the edges instead of clamping
+//--no-mips  only the top level
+//--force    cook even if the output is newer than the input and was cooked with the same options
+
+using namespace Wolf;
+
+struct CookOptions
+{
+	bool srgb = true;
+	bool normalMap = false;
+	bool wrap = false;
+	bool mips = true;
+	bool force = false;
+	const char* input = nullptr;
+	const char* output = nullptr;
+};
+
+//linear float RGBA, color premultiplied by alpha while filtering
+struct Image
+{
+	u32 width = 0;
+	u32 height = 0;
+	std::vector<f32> pixels;
+};
+
+static f32 srgbToLinear[256];
+
+static f32 LinearToSrgb(f32 value)
+{
+	if (value <= 0.0031308f) return value * 12.92f;
+	return 1.055f * powf(value, 1.0f / 2.4f) - 0.055f;
+}
+
+static u8 ToUnorm8(f32 value)
+{
+	value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+	return (u8)(value * 255.0f + 0.5f);
+}
+
+//Kaiser windowed sinc, sharper than a box or tent without the ringing of a plain sinc
+static const f32 FILTER_RADIUS = 3.0f;
+static const f32 KAISER_ALPHA = 4.0f;
+
+static f64 BesselI0(f64 x)
+{
+	f64 sum = 1.0;
+	f64 term = 1.0;
+	for (u32 k = 1; k < 32; k++)
+	{
+		const f64 half = x / (2.0 * k);
+		term *= half * half;
+		sum += term;
+		if (term < sum * 1e-12) break;
+	}
+	return sum;
+}
+
+static f32 FilterWeight(f32 x)
+{
+	x = fabsf(x);
+	if (x >= FILTER_RADIUS) return 0.0f;
+	const f64 t = x / FILTER_RADIUS;
+	const f64 window = BesselI0(KAISER_ALPHA * sqrt(1.0 - t * t)) / BesselI0(KAISER_ALPHA);
+	const f64 pix = 3.14159265358979323846 * x;
+	const f64 sinc = x < 1e-6f ? 1.0 : sin(pix) / pix;
+	return (f32)(sinc * window);
+}
+
+//source taps and weights of every destination pixel along one axis
+struct FilterTaps
+{
+	std::vector<u32> first;
+	std::vector<u32> count;
+	std::vector<u32> indices;
+	std::vector<f32> weights;
+};
+
+static void BuildTaps(u32 sourceSize, u32 destinationSize, bool wrap, FilterTaps& taps)
+{
+	taps.first.clear();
+	taps.count.clear();
+	taps.indices.clear();
+	taps.weights.clear();
+
+	//the kernel is stretched by the scale so it covers FILTER_RADIUS destination pixels
+	const f32 scale = (f32)sourceSize / (f32)destinationSize;
+	const f32 support = FILTER_RADIUS * scale;
+	for (u32 x = 0; x < destinationSize; x++)
+	{
+		const f32 center = ((f32)x + 0.5f) * scale;
+		const s32 begin = (s32)floorf(center - support);
+		const s32 end = (s32)ceilf(center + support);
+
+		const u32 first = (u32)taps.indices.size();
+		f32 sum = 0.0f;
+		for (s32 s = begin; s <= end; s++)
+		{
+			const f32 weight = FilterWeight(((f32)s + 0.5f - center) / scale);
+			if (weight == 0.0f) continue;
+			s32 index = s;
+			if (wrap) index = ((index % (s32)sourceSize) + (s32)sourceSize) % (s32)sourceSize;
+			else index = index < 0 ? 0 : (index >= (s32)sourceSize ? (s32)sourceSize - 1 : index);
+			taps.indices.push_back((u32)index);
+			taps.weights.push_back(weight);
+			sum += weight;
+		}
+		for (u32 i = first; i < taps.weights.size(); i++)
+			taps.weights[i] /= sum;
+		taps.first.push_back(first);
+		taps.count.push_back((u32)taps.indices.size() - first);
+	}
+}
+
+//separable downsample to the next mip size, rows first then columns
+static void Downsample(const Image& source, Image& destination, bool wrap)
+{
+	destination.width = source.width > 1 ? source.width / 2 : 1;
+	destination.height = source.height > 1 ? source.height / 2 : 1;
+
+	FilterTaps taps;
+	BuildTaps(source.width, destination.width, wrap, taps);
+	std::vector<f32> rows((size_t)destination.width * source.height * 4);
+	for (u32 y = 0; y < source.height; y++)
+	{
+		const f32* in = &source.pixels[(size_t)y * source.width * 4];
+		f32* out = &rows[(size_t)y * destination.width * 4];
+		for (u32 x = 0; x < destination.width; x++)
+		{
+			f32 sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for (u32 t = taps.first[x]; t < taps.first[x] + taps.count[x]; t++)
+			{
+				const f32* pixel = in + (size_t)taps.indices[t] * 4;
+				const f32 weight = taps.weights[t];
+				for (u32 c = 0; c < 4; c++) sum[c] += pixel[c] * weight;
+			}
+			for (u32 c = 0; c < 4; c++) out[x * 4 + c] = sum[c];
+		}
+	}
+
+	BuildTaps(source.height, destination.height, wrap, taps);
+	destination.pixels.assign((size_t)destination.width * destination.height * 4, 0.0f);
+	const size_t stride = (size_t)destination.width * 4;
+	for (u32 y = 0; y < destination.height; y++)
+	{
+		f32* out = &destination.pixels[y * stride];
+		for (u32 t = taps.first[y]; t < taps.first[y] + taps.count[y]; t++)
+		{
+			const f32* in = &rows[taps.indices[t] * stride];
+			const f32 weight = taps.weights[t];
+			for (size_t i = 0; i < stride; i++) out[i] += in[i] * weight;
+		}
+	}
+}
+
+static void Decode(const u8* rgba, u32 width, u32 height, const CookOptions& options, Image& image)
+{
+	image.width = width;
+	image.height = height;
+	image.pixels.resize((size_t)width * height * 4);
+	for (size_t i = 0; i < (size_t)width * height; i++)
+	{
+		const u8* in = rgba + i * 4;
+		f32* out = &image.pixels[i * 4];
+		const f32 alpha = in[3] / 255.0f;
+		for (u32 c = 0; c < 3; c++)
+		{
+			if (options.normalMap) out[c] = in[c] / 255.0f * 2.0f - 1.0f;
+			else if (options.srgb) out[c] = srgbToLinear[in[c]] * alpha;
+			else out[c] = in[c] / 255.0f * alpha;
+		}
+		out[3] = alpha;
+	}
+}
+
+static void Encode(const Image& image, const CookOptions& options, u8* rgba)
+{
+	for (size_t i = 0; i < (size_t)image.width * image.height; i++)
+	{
+		const f32* in = &image.pixels[i * 4];
+		u8* out = rgba + i * 4;
+		const f32 alpha = in[3] < 0.0f ? 0.0f : (in[3] > 1.0f ? 1.0f : in[3]);
+		if (options.normalMap)
+		{
+			//filtering shortens the normals, point them back on the unit sphere
+			const f32 length = sqrtf(in[0] * in[0] + in[1] * in[1] + in[2] * in[2]);
+			const f32 scale = length > 1e-6f ? 1.0f / length : 0.0f;
+			for (u32 c = 0; c < 3; c++) out[c] = ToUnorm8(in[c] * scale * 0.5f + 0.5f);
+		}
+		else
+		{
+			const f32 unpremultiply = alpha > 1e-6f ? 1.0f / alpha : 0.0f;
+			for (u32 c = 0; c < 3; c++)
+			{
+				const f32 value = in[c] * unpremultiply;
+				out[c] = ToUnorm8(options.srgb ? LinearToSrgb(value < 0.0f ? 0.0f : value) : value);
+			}
+		}
+		out[3] = ToUnorm8(alpha);
+	}
+}
+
+static TextureFormat GetFormat(const CookOptions& options)
+{
+	return options.srgb ? TextureFormat::RGBA8_SRGB : TextureFormat::RGBA8;
+}
+
+static u32 GetFlags(const CookOptions& options)
+{
+	return (options.normalMap ? (u32)TEXTURE_FLAG_NORMAL_MAP : 0u) | (options.wrap ? (u32)TEXTURE_FLAG_WRAP : 0u);
+}
+
+static u32 GetMipCount(u32 width, u32 height, const CookOptions& options)
+{
+	u32 mipCount = 1;
+	if (options.mips)
+	{
+		for (u32 size = width > height ? width : height; size > 1; size /= 2)
+			mipCount++;
+	}
+	return mipCount;
+}
+
+//newer than the input and cooked with the same options, the header records all of them
+static bool IsUpToDate(const CookOptions& options)
+{
+	std::error_code error;
+	const auto outputTime = std::filesystem::last_write_time(options.output, error);
+	if (error) return false;
+	const auto inputTime = std::filesystem::last_write_time(options.input, error);
+	if (error || outputTime < inputTime) return false;
+
+	TextureFileHeader header;
+	FILE* file = fopen(options.output, "rb");
+	if (!file) return false;
+	const bool read = fread(&header, sizeof(header), 1, file) == 1;
+	fclose(file);
+	return read && header.magic == TEXTURE_FILE_MAGIC && header.version == TEXTURE_FILE_VERSION &&
+		header.format == GetFormat(options) && header.flags == GetFlags(options) &&
+		header.mipCount == GetMipCount(header.width, header.height, options);
+}
+
+static bool Cook(const CookOptions& options)
+{
+	int width, height, channels;
+	u8* rgba = stbi_load(options.input, &width, &height, &channels, 4);
+	if (!rgba)
+	{
+		fprintf(stderr, "TextureCooker: can't decode %s: %s\n", options.input, stbi_failure_reason());
+		return false;
+	}
+	if ((u32)width > (1u << (TEXTURE_MAX_MIPS - 1)) || (u32)height > (1u << (TEXTURE_MAX_MIPS - 1)))
+	{
+		fprintf(stderr, "TextureCooker: %s is %dx%d, the largest size is %u\n", options.input, width, height, 1u << (TEXTURE_MAX_MIPS - 1));
+		stbi_image_free(rgba);
+		return false;
+	}
+
+	TextureFileHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = TEXTURE_FILE_MAGIC;
+	header.version = TEXTURE_FILE_VERSION;
+	header.format = GetFormat(options);
+	header.flags = GetFlags(options);
+	header.width = (u32)width;
+	header.height = (u32)height;
+	header.bytesPerPixel = GetTextureFormatBytesPerPixel(header.format);
+	const u32 mipCount = GetMipCount(header.width, header.height, options);
+	header.mipCount = mipCount;
+
+	u64 offset = Memory::alignUp(sizeof(TextureFileHeader), TEXTURE_DATA_ALIGNMENT);
+	u32 mipWidth = header.width;
+	u32 mipHeight = header.height;
+	for (u32 mip = 0; mip < mipCount; mip++)
+	{
+		TextureMipDesc& desc = header.mips[mip];
+		desc.offset = offset;
+		desc.width = mipWidth;
+		desc.height = mipHeight;
+		desc.size = (u64)mipWidth * mipHeight * header.bytesPerPixel;
+		offset = Memory::alignUp(offset + desc.size, TEXTURE_DATA_ALIGNMENT);
+		mipWidth = mipWidth > 1 ? mipWidth / 2 : 1;
+		mipHeight = mipHeight > 1 ? mipHeight / 2 : 1;
+	}
+	//the last mip isn't padded
+	header.fileSize = header.mips[mipCount - 1].offset + header.mips[mipCount - 1].size;
+
+	std::vector<u8> file((size_t)header.fileSize, 0);
+	memcpy(file.data(), &header, sizeof(header));
+
+	//the top level is copied as is, filtering only touches the smaller ones
+	memcpy(file.data() + header.mips[0].offset, rgba, (size_t)header.mips[0].size);
+	Image current;
+	Image next;
+	if (mipCount > 1) Decode(rgba, header.width, header.height, options, current);
+	stbi_image_free(rgba);
+	for (u32 mip = 1; mip < mipCount; mip++)
+	{
+		Downsample(current, next, options.wrap);
+		Encode(next, options, file.data() + header.mips[mip].offset);
+		std::swap(current, next);
+	}
+
+	if (!ValidateTextureFile(file.data(), file.size()))
+	{
+		fprintf(stderr, "TextureCooker: internal error, the container for %s doesn't validate\n", options.input);
+		return false;
+	}
+
+	//written next to the output and renamed over it, hot reload never sees a half written file
+	const std::string temporary = std::string(options.output) + ".tmp";
+	FILE* output = fopen(temporary.c_str(), "wb");
+	if (!output)
+	{
+		fprintf(stderr, "TextureCooker: can't write %s\n", temporary.c_str());
+		return false;
+	}
+	const bool written = fwrite(file.data(), 1, file.size(), output) == file.size();
+	if (fclose(output) != 0 || !written)
+	{
+		fprintf(stderr, "TextureCooker: can't write %s\n", temporary.c_str());
+		remove(temporary.c_str());
+		return false;
+	}
+	std::error_code error;
+	std::filesystem::rename(temporary, options.output, error);
+	if (error)
+	{
+		fprintf(stderr, "TextureCooker: can't replace %s: %s\n", options.output, error.message().c_str());
+		remove(temporary.c_str());
+		return false;
+	}
+
+	printf("%s -> %s  %ux%u  %u mips  %s  %.2f MB\n", options.input, options.output, header.width, header.height, header.mipCount,
+		options.normalMap ? "normal" : (options.srgb ? "srgb" : "linear"), (f64)header.fileSize / (1024.0 * 1024.0));
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	CookOptions options;
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--linear")) options.srgb = false;
+		else if (!strcmp(argv[i], "--normal")) { options.normalMap = true; options.srgb = false; }
+		else if (!strcmp(argv[i], "--wrap")) options.wrap = true;
+		else if (!strcmp(argv[i], "--no-mips")) options.mips = false;
+		else if (!strcmp(argv[i], "--force")) options.force = true;
+		else if (!options.input) options.input = argv[i];
+		else if (!options.output) options.output = argv[i];
+		else
+		{
+			fprintf(stderr, "TextureCooker: unexpected argument %s\n", argv[i]);
+			return 1;
+		}
+	}
+	if (!options.input || !options.output)
+	{
+		fprintf(stderr, "usage: TextureCooker [--linear] [--normal] [--wrap] [--no-mips] [--force] input output\n");
+		return 1;
+	}
+
+	if (!options.force && IsUpToDate(options))
+	{
+		printf("%s is up to date\n", options.output);
+		return 0;
+	}
+
+	for (u32 i = 0; i < 256; i++)
+	{
+		const f32 value = i / 255.0f;
+		srgbToLinear[i] = value <= 0.04045f ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	if (!Cook(options)) return 1;
+	const f64 ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+	printf("cooked in %.1f ms\n", ms);
+	return 0;
+}
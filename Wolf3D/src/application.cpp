@@ -1,15 +1,85 @@
 #include "wf_pch.h"
 #include "application.h"
+#include "wf_debug.h"
+#include "wf_profiler.h"
 namespace Wolf {
+	bool Application::needsShutDown = false;
+	Window* Application::window = nullptr;
+
+	void Application::Run()
+	{
+		needsShutDown = false;
+		//games that want a log file start the logger themselves before Run
+		const bool ownsLogger = !Logger::IsRunning();
+		if (ownsLogger) Logger::StartUp();
+		WF_PROFILE_THREAD("Main");
+		jobs.StartUp();
+		StartUp();
+		scheduler.Reset();
+
+		while (!needsShutDown)
+		{
+			Profiler::NewFrame();
+			frameAllocator.BeginFrame();
+			{
+				WF_PROFILE_SCOPE("Window events");
+				window->OnUpdate();
+			}
+			if (window->closeRequested) needsShutDown = true;
+			{
+				WF_PROFILE_SCOPE("Assets");
+				//reloads can register new dependencies, they arrive through ApplyLoads
+				assets.ApplyLoads();
+				assets.ApplyReloads();
+			}
+
+			const u32 fixedSteps = scheduler.BeginFrame();
+			for (u32 i = 0; i < fixedSteps; i++)
+			{
+				WF_PROFILE_SCOPE("FixedUpdate");
+				FixedUpdate(scheduler.GetFixedDeltaTime());
+			}
+			{
+				WF_PROFILE_SCOPE("Update");
+				Update(scheduler.GetFrameDeltaTime());
+			}
+			{
+				WF_PROFILE_SCOPE("Render");
+				Render(scheduler.GetAlpha());
+			}
+
+			Memory::EndFrame();
+		#ifdef WF_TRACK_HEAP
+			const u64 frameAllocations = Memory::GetFrameAllocationCount();
+			if (frameAllocations > 0 && scheduler.GetFrameIndex() > HEAP_REPORT_WARMUP_FRAMES)
+				WF_LOGWARNING("frame %llu: %llu heap allocations slipped through", (unsigned long long)scheduler.GetFrameIndex(), (unsigned long long)frameAllocations);
+		#endif
+
+			{
+				WF_PROFILE_SCOPE("Frame limiter");
+				scheduler.EndFrame();
+			}
+		}
+
+		ShutDown();
+		assets.StopHotReload();
+		jobs.ShutDown();
+		if (ownsLogger) Logger::ShutDown();
+	}
+
 	void Application::StartUp()
 	{
 	}
 
-	void Application::Update(float deltaTime)
+	void Application::Update(float /*deltaTime*/)
+	{
+	}
+
+	void Application::FixedUpdate(float /*deltaTime*/)
 	{
 	}
 
-	void Application::FixedUpdate(float deltaTime)
+	void Application::Render(float /*alpha*/)
 	{
 	}
 
@@ -1,25 +1,61 @@
 #ifndef WF_APPLICATION_H
 #define WF_APPLICATION_H
 #include "wf_window.h"
+#include "wf_frame_scheduler.h"
+#include "wf_jobs.h"
+#include "wf_memory.h"
+#include "wf_assets.h"
 
 namespace Wolf 
 {
+	//Games derive from Application and call Run(), the engine owns the main loop:
+	//FixedUpdate runs 0..n times per frame with the fixed step, Update once with the frame time,
+	//Render once with the alpha to interpolate between the last two fixed states
+	//The job system is running from StartUp to ShutDown, the main thread is its thread 0
+	//Per frame data goes to the frame allocator (valid for this frame and the next one) or to
+	//a ScratchScope, debug builds log every frame after the first few that touches the heap
+	//Run starts the logger's writer thread unless the game already did
+	//Asset hot reloads are swapped in right after the window events, before any update
+	//Asset paths go through the Vfs, mount directories and packs in StartUp before loading
 	class Application
 	{
 	public:
-		Application(Window* a_window)
+		Application(Window* a_window, const FrameSchedulerConfig& schedulerConfig = FrameSchedulerConfig())
+			: scheduler(schedulerConfig)
 		{
 			window = a_window;
+			assets.SetVfs(&vfs);
 		}
+		virtual ~Application() = default;
 
-		void StartUp();
-		void Update(float deltaTime);
-		void FixedUpdate(float deltaTime);
-		void ShutDown();
+		void Run();
+
+		JobSystem& GetJobs() { return jobs; }
+		FrameAllocator& GetFrameAllocator() { return frameAllocator; }
+		Vfs& GetVfs() { return vfs; }
+		AssetRegistry& GetAssets() { return assets; }
+
+		static const size_t FRAME_MEMORY = 8 * 1024 * 1024;
+		//frames before the heap allocation report starts, startup and first use caches are allowed to allocate
+		static const u64 HEAP_REPORT_WARMUP_FRAMES = 8;
+
+		virtual void StartUp();
+		virtual void Update(float deltaTime);
+		virtual void FixedUpdate(float deltaTime);
+		virtual void Render(float alpha);
+		virtual void ShutDown();
 
 		static bool needsShutDown;
 		static Window* window;
 		//static GraphicsContext context;
+
+	protected:
+		FrameScheduler scheduler;
+		JobSystem jobs;
+		FrameAllocator frameAllocator{ FRAME_MEMORY };
+		//before assets, textures point into its packs
+		Vfs vfs;
+		AssetRegistry assets;
 	};
 }
-#endif
\ No newline at end of file
+#endif
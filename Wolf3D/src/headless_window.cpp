@@ -0,0 +1,38 @@
+#include "wf_pch.h"
+#include "headless_window.h"
+#include <csignal>
+
+namespace Wolf
+{
+	static volatile sig_atomic_t stopSignal = 0;
+
+	static void OnStopSignal(int)
+	{
+		stopSignal = 1;
+	}
+
+	typedef void (*SignalHandler)(int);
+	static SignalHandler previousInterrupt = SIG_DFL;
+	static SignalHandler previousTerminate = SIG_DFL;
+
+	HeadlessWindow::HeadlessWindow(const std::string& name, unsigned int width, unsigned int height, u64 a_maxFrames)
+		: Window(name, width, height, 0), maxFrames(a_maxFrames)
+	{
+		stopSignal = 0;
+		previousInterrupt = std::signal(SIGINT, OnStopSignal);
+		previousTerminate = std::signal(SIGTERM, OnStopSignal);
+	}
+
+	HeadlessWindow::~HeadlessWindow()
+	{
+		std::signal(SIGINT, previousInterrupt == SIG_ERR ? SIG_DFL : previousInterrupt);
+		std::signal(SIGTERM, previousTerminate == SIG_ERR ? SIG_DFL : previousTerminate);
+	}
+
+	void HeadlessWindow::OnUpdate()
+	{
+		frameCount++;
+		if (stopSignal) closeRequested = true;
+		if (maxFrames && frameCount >= maxFrames) closeRequested = true;
+	}
+}
@@ -0,0 +1,32 @@
+#ifndef WF_HEADLESS_WINDOW_H
+#define WF_HEADLESS_WINDOW_H
+#include "wf_window.h"
+
+namespace Wolf
+{
+	//Window without a display for servers, CI and soak tests: no SDL video, no GL context,
+	//no ImGui. OnUpdate only handles closing, after maxFrames frames (0 runs until asked)
+	//or when the process gets SIGINT/SIGTERM, so Application::Run shuts down cleanly.
+	class HeadlessWindow : public Window
+	{
+	public:
+		HeadlessWindow(const std::string& name, unsigned int width, unsigned int height, u64 a_maxFrames = 0);
+		virtual ~HeadlessWindow();
+
+		virtual void OnUpdate() override;
+		virtual void SetVSync(bool enabled) override { vsync = enabled; }
+		virtual bool IsVSync() const override { return vsync; }
+		virtual void* GetNativeWindowPtr() const override { return nullptr; }
+		virtual bool IsHeadless() const override { return true; }
+
+		void RequestClose() { closeRequested = true; }
+		u64 GetFrameCount() const { return frameCount; }
+
+	private:
+		u64 maxFrames;
+		u64 frameCount = 0;
+		bool vsync = false;
+	};
+}
+
+#endif //WF_HEADLESS_WINDOW_H
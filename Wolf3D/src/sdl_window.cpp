@@ -7,7 +7,21 @@ Wolf::SDL_WINDOW::~SDL_WINDOW()
 	SDL_Quit();
 }
 
-void Wolf::SDL_WINDOW::OnUpdate(){}
+void Wolf::SDL_WINDOW::OnUpdate()
+{
+	SDL_Event evnt;
+	while (SDL_PollEvent(&evnt) != 0)
+	{
+		if (ImGui::GetCurrentContext()) ImGui_ImplSDL2_ProcessEvent(&evnt);
+		if (evnt.type == SDL_QUIT) closeRequested = true;
+		else if (evnt.type == SDL_WINDOWEVENT && evnt.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+		{
+			width = (unsigned int)evnt.window.data1;
+			height = (unsigned int)evnt.window.data2;
+		}
+	}
+}
+
 void Wolf::SDL_WINDOW::SetVSync(bool enabled)
 {
 	int interval = 0;
@@ -0,0 +1,737 @@
+#include "wf_pch.h"
+#include "wf_assets.h"
+#include "wf_debug.h"
+#include "wf_profiler.h"
+#include <algorithm>
+#include <chrono>
+
+namespace Wolf
+{
+	struct AssetReload
+	{
+		AssetId id;
+		const AssetType* type;
+		std::string path;
+		//nullptr if the reload failed, the old data stays
+		void* data;
+		AssetLoadContext context;
+	};
+
+	static std::string MakeKey(const AssetType& type, const std::string& path)
+	{
+		return std::string(type.name) + ":" + path;
+	}
+
+	template<typename T>
+	static void EraseValue(std::vector<T>& values, const T& value)
+	{
+		values.erase(std::remove(values.begin(), values.end(), value), values.end());
+	}
+
+	bool AssetLoadContext::OpenFile(const char* a_path, FileView& view)
+	{
+		AddFileDependency(a_path);
+		return registry->vfs ? registry->vfs->Open(a_path, view) : view.Open(a_path);
+	}
+
+	bool AssetLoadContext::ReadFile(const char* a_path, std::vector<u8>& data)
+	{
+		data.clear();
+		FileView view;
+		if (!OpenFile(a_path, view)) return false;
+		data.assign(view.GetData(), view.GetData() + view.GetSize());
+		return true;
+	}
+
+	void AssetLoadContext::AddFileDependency(const char* a_path)
+	{
+		//the watcher reports the OS files
+		std::string normalized = FileWatcher::NormalizePath(registry->vfs ? registry->vfs->Resolve(a_path).c_str() : a_path);
+		if (std::find(files.begin(), files.end(), normalized) == files.end())
+			files.push_back(std::move(normalized));
+	}
+
+	void* AssetLoadContext::LoadDependency(const AssetType& a_type, const char* a_path, AssetId* id)
+	{
+		void* data = nullptr;
+		const AssetId dependency = registry->LoadAsset(a_type, a_path, this, &data);
+		if (!dependency.IsNull() && std::find(dependencies.begin(), dependencies.end(), dependency) == dependencies.end())
+			dependencies.push_back(dependency);
+		if (id) *id = dependency;
+		return data;
+	}
+
+	AssetRegistry::AssetRegistry()
+	{
+	}
+
+	AssetRegistry::~AssetRegistry()
+	{
+		StopHotReload();
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			streamingQuit = true;
+		}
+		queueWake.notify_all();
+		for (std::thread& thread : streamingThreads)
+			thread.join();
+		streamingThreads.clear();
+
+		for (u32 index = 0; index < slotCount; index++)
+		{
+			const AssetSlot& slot = GetSlot(index);
+			const AssetNode& node = nodes[index];
+			if (!node.alive) continue;
+			if (slot.data) slot.type->unload(slot.data);
+			if (node.pendingData) slot.type->unload(node.pendingData);
+		}
+		for (RetiredData& garbage : retired)
+			garbage.type->unload(garbage.data);
+		for (AssetSlot* page : pages)
+			delete[] page;
+	}
+
+	std::string AssetRegistry::NormalizePath(const char* path) const
+	{
+		return vfs ? Vfs::NormalizePath(path) : FileWatcher::NormalizePath(path);
+	}
+
+	AssetId AssetRegistry::Load(const AssetType& type, const char* path)
+	{
+		void* data = nullptr;
+		return LoadAsset(type, path, nullptr, &data);
+	}
+
+	AssetId AssetRegistry::LoadAsset(const AssetType& type, const char* a_path, AssetLoadContext* parent, void** data)
+	{
+		const std::string path = NormalizePath(a_path);
+		const std::string key = MakeKey(type, path);
+		const bool mainThread = parent ? parent->mainThread : true;
+		//assets reloaded earlier in the running batch hand out their new data
+		const std::vector<AssetReload>* batch = parent ? parent->batch : nullptr;
+		*data = nullptr;
+
+		for (const AssetLoadContext* context = parent; context; context = context->parent)
+		{
+			if (context->type == &type && *context->path == path)
+			{
+				WF_LOGERROR("Assets: %s %s depends on itself", type.name, path.c_str());
+				return AssetId::Null();
+			}
+		}
+
+		std::unique_lock<std::mutex> guard(lock);
+		AssetId id;
+		for (;;)
+		{
+			auto found = assetsByKey.find(key);
+			if (found == assetsByKey.end())
+			{
+				//loaded right here, whoever asks for it meanwhile waits
+				id = Register(type, key, path, mainThread);
+				if (id.IsNull()) return id;
+				break;
+			}
+
+			id = AssetId{ found->second, GetSlot(found->second).generation };
+			AssetNode& node = nodes[id.index];
+			if (node.loadState == LoadState::Queued)
+			{
+				//needed now, its streaming queue entry goes stale
+				node.loadState = LoadState::Loading;
+				node.loader = std::this_thread::get_id();
+				break;
+			}
+			if (node.loadState == LoadState::Loading)
+			{
+				//A -> B on one streaming thread and B -> A on another, neither would finish
+				if (WaitWouldDeadlock(id))
+				{
+					WF_LOGERROR("Assets: %s %s and the assets loading it on other threads depend on each other", type.name, path.c_str());
+					return AssetId::Null();
+				}
+				const std::pair<std::thread::id, AssetId> wait(std::this_thread::get_id(), id);
+				waits.push_back(wait);
+				loadDone.wait(guard);
+				EraseValue(waits, wait);
+				continue;
+			}
+			if (node.loadState == LoadState::Loaded)
+			{
+				*data = node.pendingData;
+				if (mainThread)
+				{
+					guard.unlock();
+					Publish(id, *data);
+					return id;
+				}
+			}
+			else *data = GetSlot(id.index).data;
+
+			if (batch)
+			{
+				for (const AssetReload& reload : *batch)
+				{
+					if (reload.id != id) continue;
+					if (reload.data) *data = reload.data;
+					break;
+				}
+			}
+			return id;
+		}
+		guard.unlock();
+
+		AssetLoadContext context;
+		context.registry = this;
+		context.parent = parent;
+		context.type = &type;
+		context.path = &path;
+		context.batch = batch;
+		context.mainThread = mainThread;
+		void* loaded = RunLoader(type, path, context);
+
+		guard.lock();
+		if (!Complete(id, type, loaded, context)) return id;
+		guard.unlock();
+		if (mainThread) Publish(id, loaded);
+		*data = loaded;
+		return id;
+	}
+
+	AssetId AssetRegistry::LoadAsync(const AssetType& type, const char* a_path, f32 priority)
+	{
+		const std::string path = NormalizePath(a_path);
+		const std::string key = MakeKey(type, path);
+
+		std::unique_lock<std::mutex> guard(lock);
+		auto found = assetsByKey.find(key);
+		if (found != assetsByKey.end())
+		{
+			//asked for again, it keeps the most urgent priority
+			const AssetId id{ found->second, GetSlot(found->second).generation };
+			const AssetNode& node = nodes[id.index];
+			if (node.loadState == LoadState::Queued && priority < node.priority)
+				Enqueue(id, priority);
+			return id;
+		}
+
+		const AssetId id = Register(type, key, path, true);
+		if (id.IsNull()) return id;
+		nodes[id.index].loadState = LoadState::Queued;
+		Enqueue(id, priority);
+		if (streamingThreads.empty())
+		{
+			for (u32 i = 0; i < STREAMING_THREADS; i++)
+				streamingThreads.emplace_back(&AssetRegistry::StreamingLoop, this);
+		}
+		guard.unlock();
+		queueWake.notify_one();
+		return id;
+	}
+
+	void AssetRegistry::SetPriority(AssetId id, f32 priority)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		if (!IsAlive(id) || nodes[id.index].loadState != LoadState::Queued || nodes[id.index].priority == priority) return;
+		Enqueue(id, priority);
+	}
+
+	void AssetRegistry::Enqueue(AssetId id, f32 priority)
+	{
+		AssetNode& node = nodes[id.index];
+		node.priority = priority;
+		node.queueTicket = nextTicket++;
+		queue.push_back(LoadRequest{ priority, node.queueTicket, id });
+		std::push_heap(queue.begin(), queue.end());
+
+		//reprioritizing leaves stale entries behind, drop them before they pile up
+		if (queue.size() > 2 * (size_t)pendingLoads + 64)
+		{
+			queue.erase(std::remove_if(queue.begin(), queue.end(), [this](const LoadRequest& request)
+			{
+				return !IsAlive(request.id) || nodes[request.id.index].loadState != LoadState::Queued || nodes[request.id.index].queueTicket != request.ticket;
+			}), queue.end());
+			std::make_heap(queue.begin(), queue.end());
+		}
+	}
+
+	bool AssetRegistry::WaitWouldDeadlock(AssetId id) const
+	{
+		//follows the loader of the asset to the load it waits for and so on, every thread waits
+		//for one load at most so this is a chain that either ends or comes back to this thread
+		const std::thread::id self = std::this_thread::get_id();
+		for (size_t hops = 0; hops <= waits.size(); hops++)
+		{
+			if (!IsAlive(id) || nodes[id.index].loadState != LoadState::Loading) return false;
+			const AssetNode& node = nodes[id.index];
+			if (node.loader == self) return true;
+			auto wait = std::find_if(waits.begin(), waits.end(), [&node](const std::pair<std::thread::id, AssetId>& other) { return other.first == node.loader; });
+			if (wait == waits.end()) return false;
+			id = wait->second;
+		}
+		return false;
+	}
+
+	void* AssetRegistry::RunLoader(const AssetType& type, const std::string& path, AssetLoadContext& context)
+	{
+		WF_PROFILE_SCOPE("Asset load");
+		void* data = type.load(context, path.c_str());
+		if (!data)
+			WF_LOGERROR("Assets: can't load %s %s", type.name, path.c_str());
+		return data;
+	}
+
+	AssetId AssetRegistry::Register(const AssetType& type, const std::string& key, const std::string& path, bool reuseSlot)
+	{
+		u32 index;
+		if (reuseSlot && !freeSlots.empty())
+		{
+			index = freeSlots.back();
+			freeSlots.pop_back();
+		}
+		else
+		{
+			if (slotCount == MAX_ASSETS)
+			{
+				WF_LOGERROR("Assets: more than %u assets, %s isn't registered", MAX_ASSETS, path.c_str());
+				return AssetId::Null();
+			}
+			index = slotCount;
+			//pages never move, the main thread reads slots without the lock
+			if (index % PAGE_SIZE == 0) pages[index / PAGE_SIZE] = new AssetSlot[PAGE_SIZE]();
+			nodes.emplace_back();
+			slotCount++;
+		}
+
+		AssetSlot& slot = GetSlot(index);
+		slot.data = nullptr;
+		slot.type = &type;
+		slot.version = 1;
+		slot.state = AssetState::Loading;
+		//generation 0 is reserved for AssetId::Null(), freed slots were bumped by Unload
+		if (slot.generation == 0) slot.generation = 1;
+
+		AssetNode& node = nodes[index];
+		node.key = key;
+		node.path = path;
+		node.pendingData = nullptr;
+		node.loadState = LoadState::Loading;
+		node.loader = std::this_thread::get_id();
+		node.alive = true;
+		assetsByKey[key] = index;
+		liveCount++;
+		pendingLoads++;
+		return AssetId{ index, slot.generation };
+	}
+
+	bool AssetRegistry::Complete(AssetId id, const AssetType& type, void* data, const AssetLoadContext& context)
+	{
+		loadDone.notify_all();
+		if (!IsAlive(id))
+		{
+			//unloaded while it was loading
+			if (data) Retire(&type, data);
+			return false;
+		}
+
+		AssetNode& node = nodes[id.index];
+		Link(id, context);
+		node.pendingData = data;
+		node.loadState = LoadState::Loaded;
+		if (!context.mainThread) completed.push_back(id);
+		return true;
+	}
+
+	void AssetRegistry::Publish(AssetId id, void* data)
+	{
+		//main thread, nothing else changes the slot so finalize can run without the lock
+		const AssetType* type = GetSlot(id.index).type;
+		if (data && type->finalize) type->finalize(data);
+
+		std::lock_guard<std::mutex> guard(lock);
+		AssetNode& node = nodes[id.index];
+		AssetSlot& slot = GetSlot(id.index);
+		slot.data = data;
+		slot.state = data ? AssetState::Ready : AssetState::Failed;
+		node.pendingData = nullptr;
+		node.loadState = LoadState::Done;
+		pendingLoads--;
+	}
+
+	void AssetRegistry::Link(AssetId id, const AssetLoadContext& context)
+	{
+		AssetNode& node = nodes[id.index];
+		node.files = context.files;
+		node.dependencies = context.dependencies;
+		for (const std::string& file : node.files)
+			fileUsers[file].push_back(id);
+		for (AssetId dependency : node.dependencies)
+		{
+			if (IsAlive(dependency))
+				nodes[dependency.index].dependents.push_back(id);
+		}
+	}
+
+	void AssetRegistry::Unlink(AssetId id)
+	{
+		AssetNode& node = nodes[id.index];
+		for (const std::string& file : node.files)
+		{
+			auto users = fileUsers.find(file);
+			if (users == fileUsers.end()) continue;
+			EraseValue(users->second, id);
+			if (users->second.empty()) fileUsers.erase(users);
+		}
+		for (AssetId dependency : node.dependencies)
+		{
+			if (IsAlive(dependency))
+				EraseValue(nodes[dependency.index].dependents, id);
+		}
+		node.files.clear();
+		node.dependencies.clear();
+	}
+
+	void AssetRegistry::Retire(const AssetType* type, void* data)
+	{
+		retired.push_back(RetiredData{ type, data, epoch++ });
+	}
+
+	void AssetRegistry::FreeRetired(std::unique_lock<std::mutex>& guard)
+	{
+		if (retired.empty()) return;
+
+		u64 oldestReader = ~0ull;
+		for (u64 reader : readerEpochs)
+			oldestReader = reader < oldestReader ? reader : oldestReader;
+		auto keep = std::partition(retired.begin(), retired.end(), [oldestReader](const RetiredData& garbage) { return garbage.epoch >= oldestReader; });
+		if (keep == retired.end()) return;
+
+		std::vector<RetiredData> garbage(keep, retired.end());
+		retired.erase(keep, retired.end());
+		guard.unlock();
+		for (RetiredData& old : garbage)
+			old.type->unload(old.data);
+		guard.lock();
+	}
+
+	u64 AssetRegistry::BeginReading()
+	{
+		readerEpochs.push_back(epoch);
+		return epoch;
+	}
+
+	void AssetRegistry::EndReading(u64 startEpoch)
+	{
+		auto reader = std::find(readerEpochs.begin(), readerEpochs.end(), startEpoch);
+		if (reader != readerEpochs.end()) readerEpochs.erase(reader);
+	}
+
+	void AssetRegistry::Unload(AssetId id)
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		if (!IsAlive(id)) return;
+
+		Unlink(id);
+		AssetNode& node = nodes[id.index];
+		//dependents keep their data, they just stop following this asset
+		node.dependents.clear();
+		assetsByKey.erase(node.key);
+		node.alive = false;
+
+		//a queued load is skipped, a running one is thrown away when it completes
+		AssetSlot& slot = GetSlot(id.index);
+		if (node.loadState != LoadState::Done) pendingLoads--;
+		if (node.pendingData) Retire(slot.type, node.pendingData);
+		node.pendingData = nullptr;
+		node.loadState = LoadState::Done;
+		//loaders may be reading it as a dependency
+		if (slot.data) Retire(slot.type, slot.data);
+		slot.data = nullptr;
+		slot.state = AssetState::Failed;
+		slot.generation = slot.generation + 1 ? slot.generation + 1 : 1;
+		freeSlots.push_back(id.index);
+		liveCount--;
+		FreeRetired(guard);
+	}
+
+	u32 AssetRegistry::GetCount() const
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		return liveCount;
+	}
+
+	u32 AssetRegistry::GetPendingLoadCount() const
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		return pendingLoads;
+	}
+
+	void AssetRegistry::StreamingLoop()
+	{
+		WF_PROFILE_THREAD("Asset streaming");
+		std::unique_lock<std::mutex> guard(lock);
+		while (!streamingQuit)
+		{
+			if (queue.empty())
+			{
+				queueWake.wait(guard);
+				continue;
+			}
+			std::pop_heap(queue.begin(), queue.end());
+			const LoadRequest request = queue.back();
+			queue.pop_back();
+			if (!IsAlive(request.id)) continue;
+			AssetNode& node = nodes[request.id.index];
+			if (node.loadState != LoadState::Queued || node.queueTicket != request.ticket) continue;
+
+			node.loadState = LoadState::Loading;
+			node.loader = std::this_thread::get_id();
+			const AssetType& type = *GetSlot(request.id.index).type;
+			const std::string path = node.path;
+			const u64 startEpoch = BeginReading();
+			guard.unlock();
+
+			AssetLoadContext context;
+			context.registry = this;
+			context.type = &type;
+			context.path = &path;
+			void* data = RunLoader(type, path, context);
+
+			guard.lock();
+			Complete(request.id, type, data, context);
+			EndReading(startEpoch);
+		}
+	}
+
+	u32 AssetRegistry::ApplyLoads()
+	{
+		const auto start = std::chrono::steady_clock::now();
+		u32 count = 0;
+		std::unique_lock<std::mutex> guard(lock);
+		while (!completed.empty())
+		{
+			const AssetId id = completed.front();
+			completed.pop_front();
+			//unloaded, or already published by a Load that needed it
+			if (!IsAlive(id) || nodes[id.index].loadState != LoadState::Loaded) continue;
+
+			void* data = nodes[id.index].pendingData;
+			guard.unlock();
+			Publish(id, data);
+			count++;
+			guard.lock();
+
+			if (std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count() >= loadBudgetMs)
+				break;
+		}
+		FreeRetired(guard);
+		return count;
+	}
+
+	bool AssetRegistry::StartHotReload(const char* directory)
+	{
+		if (IsHotReloading())
+		{
+			WF_LOGERROR("Assets: hot reload is already watching a directory");
+			return false;
+		}
+
+		watcher = new FileWatcher();
+		if (!watcher->AddDirectory(directory))
+		{
+			delete watcher;
+			watcher = nullptr;
+			return false;
+		}
+		quit.store(false);
+		reloadThread = std::thread(&AssetRegistry::ReloadLoop, this);
+		return true;
+	}
+
+	void AssetRegistry::StopHotReload()
+	{
+		if (!IsHotReloading()) return;
+
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			quit.store(true);
+		}
+		applied.notify_all();
+		reloadThread.join();
+		delete watcher;
+		watcher = nullptr;
+
+		//a batch that was never applied is thrown away, nothing else has seen it
+		for (AssetReload& reload : results)
+			if (reload.data) reload.type->unload(reload.data);
+		results.clear();
+		resultsReady = false;
+	}
+
+	void AssetRegistry::ReloadLoop()
+	{
+		WF_PROFILE_THREAD("Asset reload");
+		std::vector<std::string> changed;
+		while (!quit.load())
+		{
+			//wait for the changes to settle, then reload them as one batch
+			if (watcher->Wait(DEBOUNCE_MS, changed) || changed.empty()) continue;
+
+			std::sort(changed.begin(), changed.end());
+			changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+			ReloadFiles(changed);
+			changed.clear();
+		}
+	}
+
+	void AssetRegistry::ReloadFiles(const std::vector<std::string>& changed)
+	{
+		//assets in a pack follow the pack file, the reloads below have to read the new one
+		if (vfs)
+		{
+			for (const std::string& file : changed)
+				vfs->RemapPack(file.c_str());
+		}
+
+		std::vector<AssetReload> batch;
+		u64 startEpoch;
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			applied.wait(guard, [this] { return !resultsReady || quit.load(); });
+			if (quit.load()) return;
+
+			//users of the changed files and everything depending on them, ordered so an asset
+			//comes after all its affected dependencies (reverse post order of a depth first walk)
+			std::vector<u8> visited(slotCount, 0);
+			std::vector<AssetId> order;
+			std::vector<std::pair<AssetId, u32>> stack;
+			for (const std::string& file : changed)
+			{
+				auto users = fileUsers.find(file);
+				if (users == fileUsers.end()) continue;
+				for (AssetId root : users->second)
+				{
+					if (visited[root.index]) continue;
+					visited[root.index] = 1;
+					stack.emplace_back(root, 0);
+					while (!stack.empty())
+					{
+						const AssetId id = stack.back().first;
+						const std::vector<AssetId>& dependents = nodes[id.index].dependents;
+						if (stack.back().second == dependents.size())
+						{
+							order.push_back(id);
+							stack.pop_back();
+							continue;
+						}
+						const AssetId dependent = dependents[stack.back().second++];
+						if (visited[dependent.index]) continue;
+						visited[dependent.index] = 1;
+						stack.emplace_back(dependent, 0);
+					}
+				}
+			}
+			if (order.empty()) return;
+
+			std::reverse(order.begin(), order.end());
+			batch.resize(order.size());
+			for (size_t i = 0; i < order.size(); i++)
+			{
+				batch[i].id = order[i];
+				batch[i].type = GetSlot(order[i].index).type;
+				batch[i].path = nodes[order[i].index].path;
+				batch[i].data = nullptr;
+			}
+			startEpoch = BeginReading();
+		}
+
+		//the batch doesn't grow from here, contexts can point into it
+		for (AssetReload& reload : batch)
+		{
+			AssetLoadContext& context = reload.context;
+			context.registry = this;
+			context.type = reload.type;
+			context.path = &reload.path;
+			context.batch = &batch;
+
+			WF_PROFILE_SCOPE("Asset reload");
+			reload.data = reload.type->load(context, reload.path.c_str());
+			if (!reload.data)
+				WF_LOGERROR("Assets: reloading %s %s failed, keeping the old data", reload.type->name, reload.path.c_str());
+		}
+
+		std::lock_guard<std::mutex> guard(lock);
+		results = std::move(batch);
+		resultsReady = true;
+		EndReading(startEpoch);
+	}
+
+	u32 AssetRegistry::ApplyReloads()
+	{
+		if (!IsHotReloading()) return 0;
+
+		std::vector<AssetReload> batch;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			if (!resultsReady) return 0;
+			batch.swap(results);
+			resultsReady = false;
+		}
+
+		//the main thread part runs before anything can see the new data
+		for (AssetReload& reload : batch)
+			if (reload.data && reload.type->finalize) reload.type->finalize(reload.data);
+
+		std::vector<AssetId> reloaded;
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			for (AssetReload& reload : batch)
+			{
+				if (!IsAlive(reload.id))
+				{
+					//unloaded while it was reloading
+					if (reload.data) Retire(reload.type, reload.data);
+					continue;
+				}
+
+				//a failed reload still follows the files it tried to read, fixing them retries it
+				Unlink(reload.id);
+				Link(reload.id, reload.context);
+				if (!reload.data) continue;
+
+				AssetNode& node = nodes[reload.id.index];
+				AssetSlot& slot = GetSlot(reload.id.index);
+				if (node.loadState == LoadState::Loaded)
+				{
+					//the first load was still waiting for ApplyLoads, the reload is newer
+					if (node.pendingData) Retire(slot.type, node.pendingData);
+					node.pendingData = nullptr;
+					node.loadState = LoadState::Done;
+					pendingLoads--;
+				}
+				if (slot.data) Retire(slot.type, slot.data);
+				slot.data = reload.data;
+				slot.state = AssetState::Ready;
+				slot.version++;
+				reloaded.push_back(reload.id);
+				WF_LOG("Assets: reloaded %s %s", reload.type->name, reload.path.c_str());
+			}
+			FreeRetired(guard);
+		}
+		applied.notify_one();
+
+		reloadCount += reloaded.size();
+		if (reloadCallback)
+		{
+			for (AssetId id : reloaded)
+				reloadCallback(id, reloadUserData);
+		}
+		return (u32)reloaded.size();
+	}
+
+	void AssetRegistry::SetReloadCallback(ReloadCallback callback, void* userData)
+	{
+		reloadCallback = callback;
+		reloadUserData = userData;
+	}
+}
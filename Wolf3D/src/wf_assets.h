@@ -0,0 +1,283 @@
+#ifndef WF_ASSETS_H
+#define WF_ASSETS_H
+#include "wf_pch.h"
+#include "wf_file_watcher.h"
+#include "wf_vfs.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+//Assets are loaded through an AssetType, a loader reads its files through the AssetLoadContext
+//so the registry knows which files and which other assets every asset was built from.
+//Load runs the loader on the calling thread. LoadAsync returns the id right away and a pool of
+//streaming threads loads the queued assets smallest priority first, ApplyLoads then makes them
+//visible (running the main thread part of the type, GPU uploads) within a per frame time budget.
+//With hot reload on, a background thread watches the asset directories, reloads the assets that
+//read a changed file plus everything that depends on them (dependencies first) and hands the
+//results to ApplyReloads. Data produced off the main thread is only swapped in by ApplyLoads
+//and ApplyReloads, at a point of the frame where nothing holds asset pointers, and replaced data
+//is freed once no loader can still be reading it, so Get stays a plain array read.
+namespace Wolf
+{
+	struct AssetId
+	{
+		u32 index;
+		u32 generation;
+
+		bool operator==(const AssetId& other) const { return index == other.index && generation == other.generation; }
+		bool operator!=(const AssetId& other) const { return !(*this == other); }
+		bool IsNull() const { return generation == 0; }
+		static constexpr AssetId Null() { return AssetId{ 0, 0 }; }
+	};
+
+	enum class AssetState : u8
+	{
+		Loading,
+		Ready,
+		Failed,
+	};
+
+	class AssetLoadContext;
+
+	struct AssetType
+	{
+		//assets are keyed by type name and path, names have to be unique
+		const char* name;
+		//returns nullptr on failure, runs on streaming and reload threads too
+		void* (*load)(AssetLoadContext& context, const char* path);
+		void (*unload)(void* data);
+		//optional main thread part (GPU uploads), runs before the data becomes visible.
+		//It must leave what loaders of dependent assets read intact
+		void (*finalize)(void* data);
+	};
+
+	class AssetRegistry;
+	struct AssetReload;
+
+	class AssetLoadContext
+	{
+	public:
+		//opens the file through the registry's Vfs without copying it, the asset is reloaded when
+		//it changes (even if it doesn't exist yet)
+		bool OpenFile(const char* path, FileView& view);
+		//same, copied out
+		bool ReadFile(const char* path, std::vector<u8>& data);
+		//for loaders that open their files themselves, paths go through the Vfs like the others
+		void AddFileDependency(const char* path);
+		//loads the asset or finds the loaded one, this asset is reloaded after it. The data is
+		//only guaranteed to stay valid during this load, keep the AssetId to use it later
+		void* LoadDependency(const AssetType& type, const char* path, AssetId* id = nullptr);
+
+	private:
+		friend class AssetRegistry;
+
+		AssetRegistry* registry = nullptr;
+		const AssetLoadContext* parent = nullptr;
+		const AssetType* type = nullptr;
+		const std::string* path = nullptr;
+		//reloads already done by the running batch, dependents load against the new data
+		const std::vector<AssetReload>* batch = nullptr;
+		bool mainThread = false;
+		std::vector<std::string> files;
+		std::vector<AssetId> dependencies;
+	};
+
+	class AssetRegistry
+	{
+	public:
+		static const u32 MAX_ASSETS = 64 * 1024;
+		//changed files are collected until nothing changes for this long, editors save in steps
+		static const u32 DEBOUNCE_MS = 50;
+		//started with the first LoadAsync, file reads and decoding overlap across them
+		static const u32 STREAMING_THREADS = 2;
+
+		typedef void (*ReloadCallback)(AssetId id, void* userData);
+
+		AssetRegistry();
+		~AssetRegistry();
+
+		AssetRegistry(const AssetRegistry&) = delete;
+		AssetRegistry& operator=(const AssetRegistry&) = delete;
+
+		//asset paths become Vfs paths, set before loading anything. It has to outlive the assets
+		//loaded from its packs, hot reload remaps the packs that change. Without one paths are
+		//plain OS paths
+		void SetVfs(Vfs* a_vfs) { vfs = a_vfs; }
+		const Vfs* GetVfs() const { return vfs; }
+
+		//loads on the calling thread, the same type and path give back the loaded asset
+		//a failed load still gives an id, the asset appears once its files are fixed
+		AssetId Load(const AssetType& type, const char* path);
+		//queues the load, smaller priorities go first (distance to the camera, 0 for what the
+		//level needs before it starts). Get returns nullptr until ApplyLoads made the asset ready
+		AssetId LoadAsync(const AssetType& type, const char* path, f32 priority = 0.0f);
+		//reorders a queued load, does nothing once it started
+		void SetPriority(AssetId id, f32 priority);
+		//also cancels a queued load
+		void Unload(AssetId id);
+		bool IsAlive(AssetId id) const
+		{
+			return !id.IsNull() && id.index < MAX_ASSETS && pages[id.index / PAGE_SIZE] && GetSlot(id.index).generation == id.generation;
+		}
+
+		//nullptr while the asset is loading or failed to load, valid until the next ApplyLoads/ApplyReloads
+		void* Get(AssetId id) const { return IsAlive(id) ? GetSlot(id.index).data : nullptr; }
+		template<typename T>
+		T* Get(AssetId id) const { return (T*)Get(id); }
+		AssetState GetState(AssetId id) const { return IsAlive(id) ? GetSlot(id.index).state : AssetState::Failed; }
+		bool IsReady(AssetId id) const { return GetState(id) == AssetState::Ready; }
+		//bumped by every successful reload, lets users rebuild what they derived from the data
+		u32 GetVersion(AssetId id) const { return IsAlive(id) ? GetSlot(id.index).version : 0; }
+		u32 GetCount() const;
+		//queued, loading or waiting for ApplyLoads, for loading screens
+		u32 GetPendingLoadCount() const;
+
+		//makes finished async loads visible, oldest first, until the budget is used up
+		//(at least one per call), main thread once per frame
+		u32 ApplyLoads();
+		void SetLoadBudget(f64 milliseconds) { loadBudgetMs = milliseconds; }
+		f64 GetLoadBudget() const { return loadBudgetMs; }
+
+		//watches directory for changes, call before or after loading
+		bool StartHotReload(const char* directory);
+		void StopHotReload();
+		bool IsHotReloading() const { return reloadThread.joinable(); }
+
+		//swaps finished reloads in and frees replaced data, main thread once per frame
+		u32 ApplyReloads();
+		//called by ApplyReloads for every reloaded asset
+		void SetReloadCallback(ReloadCallback callback, void* userData);
+		u64 GetReloadCount() const { return reloadCount; }
+
+	private:
+		friend class AssetLoadContext;
+
+		static const u32 PAGE_SIZE = 1024;
+
+		//read without the lock by the main thread, only the main thread changes published slots
+		struct AssetSlot
+		{
+			void* data;
+			const AssetType* type;
+			u32 generation;
+			u32 version;
+			AssetState state;
+		};
+
+		enum class LoadState : u8
+		{
+			Queued,
+			Loading,
+			//pendingData waits for the main thread
+			Loaded,
+			Done,
+		};
+
+		//dependency graph and load progress, guarded by lock
+		struct AssetNode
+		{
+			std::string key;
+			std::string path;
+			std::vector<std::string> files;
+			std::vector<AssetId> dependencies;
+			std::vector<AssetId> dependents;
+			void* pendingData = nullptr;
+			//the queue entry with another ticket is stale
+			u64 queueTicket = 0;
+			f32 priority = 0.0f;
+			LoadState loadState = LoadState::Done;
+			bool alive = false;
+			//runs the loader while Loading
+			std::thread::id loader;
+		};
+
+		struct LoadRequest
+		{
+			f32 priority;
+			u64 ticket;
+			AssetId id;
+
+			//std heaps keep the largest on top, this puts the smallest priority there
+			bool operator<(const LoadRequest& other) const
+			{
+				return priority != other.priority ? priority > other.priority : ticket > other.ticket;
+			}
+		};
+
+		struct RetiredData
+		{
+			const AssetType* type;
+			void* data;
+			u64 epoch;
+		};
+
+		AssetSlot& GetSlot(u32 index) const { return pages[index / PAGE_SIZE][index % PAGE_SIZE]; }
+		std::string NormalizePath(const char* path) const;
+		AssetId LoadAsset(const AssetType& type, const char* path, AssetLoadContext* parent, void** data);
+		void* RunLoader(const AssetType& type, const std::string& path, AssetLoadContext& context);
+		AssetId Register(const AssetType& type, const std::string& key, const std::string& path, bool reuseSlot);
+		void Enqueue(AssetId id, f32 priority);
+		bool WaitWouldDeadlock(AssetId id) const;
+		bool Complete(AssetId id, const AssetType& type, void* data, const AssetLoadContext& context);
+		void Publish(AssetId id, void* data);
+		void Link(AssetId id, const AssetLoadContext& context);
+		void Unlink(AssetId id);
+		void Retire(const AssetType* type, void* data);
+		void FreeRetired(std::unique_lock<std::mutex>& guard);
+		u64 BeginReading();
+		void EndReading(u64 startEpoch);
+		void StreamingLoop();
+		void ReloadLoop();
+		void ReloadFiles(const std::vector<std::string>& changed);
+
+		AssetSlot* pages[MAX_ASSETS / PAGE_SIZE] = {};
+		Vfs* vfs = nullptr;
+		u64 reloadCount = 0;
+		f64 loadBudgetMs = 2.0;
+
+		//guards everything below and slot allocation
+		mutable std::mutex lock;
+		u32 slotCount = 0;
+		u32 liveCount = 0;
+		u32 pendingLoads = 0;
+		//only reused by the main thread, other threads always take new slots
+		std::vector<u32> freeSlots;
+		std::vector<AssetNode> nodes;
+		std::unordered_map<std::string, u32> assetsByKey;
+		std::unordered_map<std::string, std::vector<AssetId>> fileUsers;
+		//woken when a load leaves LoadState::Loading
+		std::condition_variable loadDone;
+		//threads blocked on a load another thread runs, a cycle in it would never wake up
+		std::vector<std::pair<std::thread::id, AssetId>> waits;
+
+		//streaming
+		std::vector<std::thread> streamingThreads;
+		std::vector<LoadRequest> queue;
+		std::condition_variable queueWake;
+		u64 nextTicket = 0;
+		std::deque<AssetId> completed;
+		bool streamingQuit = false;
+
+		//replaced data is freed once every load that may have picked it up is done: loads note
+		//the epoch they started in, data retired in an earlier epoch than the oldest one is safe
+		u64 epoch = 1;
+		std::vector<u64> readerEpochs;
+		std::vector<RetiredData> retired;
+
+		//hot reload, the reload thread doesn't start a batch before the last one is applied
+		std::thread reloadThread;
+		std::atomic<bool> quit{ false };
+		std::condition_variable applied;
+		FileWatcher* watcher = nullptr;
+		std::vector<AssetReload> results;
+		bool resultsReady = false;
+		ReloadCallback reloadCallback = nullptr;
+		void* reloadUserData = nullptr;
+	};
+}
+
+#endif //WF_ASSETS_H
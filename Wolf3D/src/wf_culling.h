@@ -0,0 +1,233 @@
+#ifndef WF_CULLING_H
+#define WF_CULLING_H
+#include "wf_math.h"
+
+namespace Wolf
+{
+	//points with dot(normal, p) + d >= 0 are on the inside
+	struct Plane
+	{
+		Vec3 normal;
+		f32 d;
+
+		constexpr Plane() : normal(0.0f, 1.0f, 0.0f), d(0.0f) {}
+		constexpr Plane(const Vec3& a_normal, f32 a_d) : normal(a_normal), d(a_d) {}
+		constexpr Plane(f32 a, f32 b, f32 c, f32 a_d) : normal(a, b, c), d(a_d) {}
+
+		static Plane fromPointNormal(const Vec3& point, const Vec3& a_normal)
+		{
+			const Vec3 n = a_normal.normalized();
+			return Plane(n, -Vec3::dot(n, point));
+		}
+
+		constexpr f32 distance(const Vec3& point) const
+		{
+			return Vec3::dot(normal, point) + d;
+		}
+
+		void normalize()
+		{
+			const f32 invMod = 1.0f / normal.mod();
+			normal *= invMod;
+			d *= invMod;
+		}
+	};
+
+	struct Sphere
+	{
+		Vec3 center;
+		f32 radius;
+
+		constexpr Sphere() : center(), radius(0.0f) {}
+		constexpr Sphere(const Vec3& a_center, f32 a_radius) : center(a_center), radius(a_radius) {}
+	};
+
+	struct AABB
+	{
+		Vec3 min;
+		Vec3 max;
+
+		constexpr AABB() : min(), max() {}
+		constexpr AABB(const Vec3& a_min, const Vec3& a_max) : min(a_min), max(a_max) {}
+
+		constexpr Vec3 center() const { return (min + max) * 0.5f; }
+		constexpr Vec3 extents() const { return (max - min) * 0.5f; }
+
+		constexpr void expand(const Vec3& point)
+		{
+			min = Vec3::min(min, point);
+			max = Vec3::max(max, point);
+		}
+
+		//AABB of this box after the transform, Arvo's method
+		AABB transformed(const Mat44f& mat) const
+		{
+			const Vec3 c = center();
+			const Vec3 e = extents();
+			Vec3 newCenter = mat * c + mat.getPosition();
+			Vec3 newExtents;
+			for (u16 i = 0; i < 3; i++)
+				newExtents.values[i] = fabsf(mat.m[0][i]) * e.x + fabsf(mat.m[1][i]) * e.y + fabsf(mat.m[2][i]) * e.z;
+			return AABB(newCenter - newExtents, newCenter + newExtents);
+		}
+	};
+
+	struct Frustum
+	{
+		enum PlaneIndex { LEFT, RIGHT, BOTTOM, TOP, NEAR_PLANE, FAR_PLANE, PLANE_COUNT };
+
+		Plane planes[PLANE_COUNT];
+
+		Frustum() {}
+		Frustum(const Mat44f& viewProj) { setFromMatrix(viewProj); }
+
+		//Gribb/Hartmann extraction for the row vector convention (clip = v * viewProj)
+		//and GL clip space (-w <= x, y, z <= w), planes are normalized and point inwards
+		void setFromMatrix(const Mat44f& viewProj)
+		{
+			const Mat44f& m = viewProj;
+			for (u16 i = 0; i < 3; i++)
+			{
+				Plane& low = planes[i * 2];
+				Plane& high = planes[i * 2 + 1];
+				low = Plane(m.m[0][3] + m.m[0][i], m.m[1][3] + m.m[1][i], m.m[2][3] + m.m[2][i], m.m[3][3] + m.m[3][i]);
+				high = Plane(m.m[0][3] - m.m[0][i], m.m[1][3] - m.m[1][i], m.m[2][3] - m.m[2][i], m.m[3][3] - m.m[3][i]);
+				low.normalize();
+				high.normalize();
+			}
+		}
+
+		bool intersects(const Sphere& sphere) const
+		{
+			for (u16 i = 0; i < PLANE_COUNT; i++)
+				if (planes[i].distance(sphere.center) < -sphere.radius) return false;
+			return true;
+		}
+
+		//conservative, boxes crossing two planes near a frustum corner can pass
+		bool intersects(const AABB& box) const
+		{
+			const Vec3 c = box.center();
+			const Vec3 e = box.extents();
+			for (u16 i = 0; i < PLANE_COUNT; i++)
+			{
+				const Vec3& n = planes[i].normal;
+				const f32 r = fabsf(n.x) * e.x + fabsf(n.y) * e.y + fabsf(n.z) * e.z;
+				if (planes[i].distance(c) < -r) return false;
+			}
+			return true;
+		}
+	};
+
+	//Batch culling over SoA bounds. Each plane is broadcast to all lanes and tested against 4
+	//objects at a time (plane-major). Bit i of visibleMask[i / 32] is set when object i is visible,
+	//visibleMask needs (count + 31) / 32 words and is fully overwritten. Returns the visible count.
+	namespace Batch
+	{
+		inline u32 popCount(u32 v)
+		{
+			v = v - ((v >> 1) & 0x55555555);
+			v = (v & 0x33333333) + ((v >> 2) & 0x33333333);
+			return (((v + (v >> 4)) & 0x0f0f0f0f) * 0x01010101) >> 24;
+		}
+
+		//spheres pass radius, boxes pass half extents that get projected on each normal: r = |n| . e
+		//a mask word is built in a register and stored once, the input tail is scalar
+		template<bool Boxes>
+		inline u32 cullCentered(const Frustum& frustum, const f32* cx, const f32* cy, const f32* cz,
+			const f32* radius, const f32* ex, const f32* ey, const f32* ez, u32 count, u32* visibleMask)
+		{
+			u32 visible = 0;
+			u32 i = 0;
+	#ifdef WF_SIMD_SSE
+			__m128 px[Frustum::PLANE_COUNT], py[Frustum::PLANE_COUNT], pz[Frustum::PLANE_COUNT], pd[Frustum::PLANE_COUNT];
+			__m128 ax[Frustum::PLANE_COUNT], ay[Frustum::PLANE_COUNT], az[Frustum::PLANE_COUNT];
+			const __m128 signMask = _mm_set1_ps(-0.0f);
+			for (u16 p = 0; p < Frustum::PLANE_COUNT; p++)
+			{
+				const Plane& plane = frustum.planes[p];
+				px[p] = _mm_set1_ps(plane.normal.x);
+				py[p] = _mm_set1_ps(plane.normal.y);
+				pz[p] = _mm_set1_ps(plane.normal.z);
+				pd[p] = _mm_set1_ps(plane.d);
+				ax[p] = _mm_andnot_ps(signMask, px[p]);
+				ay[p] = _mm_andnot_ps(signMask, py[p]);
+				az[p] = _mm_andnot_ps(signMask, pz[p]);
+			}
+
+			for (; i + 32 <= count; i += 32)
+			{
+				u32 word = 0;
+				for (u32 j = 0; j < 32; j += 4)
+				{
+					const u32 k = i + j;
+					const __m128 x = _mm_loadu_ps(cx + k);
+					const __m128 y = _mm_loadu_ps(cy + k);
+					const __m128 z = _mm_loadu_ps(cz + k);
+					__m128 r, boxX, boxY, boxZ;
+					if (Boxes)
+					{
+						boxX = _mm_loadu_ps(ex + k);
+						boxY = _mm_loadu_ps(ey + k);
+						boxZ = _mm_loadu_ps(ez + k);
+					}
+					else
+						r = _mm_loadu_ps(radius + k);
+
+					//dist < -r with the operations of Plane::distance and Frustum::intersects in the same
+					//order, so objects touching a plane get the same answer as the scalar test
+					__m128 outside = _mm_setzero_ps();
+					for (u16 p = 0; p < Frustum::PLANE_COUNT; p++)
+					{
+						if (Boxes)
+							r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(boxX, ax[p]), _mm_mul_ps(boxY, ay[p])), _mm_mul_ps(boxZ, az[p]));
+						const __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, px[p]), _mm_mul_ps(y, py[p])), _mm_mul_ps(z, pz[p])), pd[p]);
+						outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, _mm_xor_ps(r, signMask)));
+					}
+					word |= (u32)(~_mm_movemask_ps(outside) & 0xf) << j;
+				}
+				visibleMask[i >> 5] = word;
+				visible += popCount(word);
+			}
+	#endif
+			for (; i < count; i++)
+			{
+				if ((i & 31) == 0) visibleMask[i >> 5] = 0;
+				const Vec3 c(cx[i], cy[i], cz[i]);
+				bool inside = true;
+				for (u16 p = 0; p < Frustum::PLANE_COUNT && inside; p++)
+				{
+					const Plane& plane = frustum.planes[p];
+					const f32 r = Boxes ? fabsf(plane.normal.x) * ex[i] + fabsf(plane.normal.y) * ey[i] + fabsf(plane.normal.z) * ez[i] : radius[i];
+					inside = !(plane.distance(c) < -r);
+				}
+				if (inside)
+				{
+					visibleMask[i >> 5] |= 1u << (i & 31);
+					visible++;
+				}
+			}
+			return visible;
+		}
+	}
+
+	inline u32 CullSpheres(const Frustum& frustum, const f32* centerX, const f32* centerY, const f32* centerZ,
+		const f32* radius, u32 count, u32* visibleMask)
+	{
+		return Batch::cullCentered<false>(frustum, centerX, centerY, centerZ, radius, nullptr, nullptr, nullptr, count, visibleMask);
+	}
+
+	//boxes as center + half extents, AABB::center() and AABB::extents()
+	inline u32 CullAABBs(const Frustum& frustum, const f32* centerX, const f32* centerY, const f32* centerZ,
+		const f32* extentX, const f32* extentY, const f32* extentZ, u32 count, u32* visibleMask)
+	{
+		return Batch::cullCentered<true>(frustum, centerX, centerY, centerZ, nullptr, extentX, extentY, extentZ, count, visibleMask);
+	}
+
+	inline bool IsVisible(const u32* visibleMask, u32 index)
+	{
+		return (visibleMask[index >> 5] >> (index & 31)) & 1u;
+	}
+}
+
+#endif //WF_CULLING_H
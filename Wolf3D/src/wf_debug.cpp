@@ -0,0 +1,369 @@
+#include "wf_pch.h"
+#include "wf_debug.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#if _WIN32
+#include "windows.h"
+#else
+#include <unistd.h>
+#endif
+
+namespace Wolf
+{
+	//bounded multi producer ring (Vyukov): a slot is free for position p when its sequence is p,
+	//readable when it is p + 1, the reader hands it back for the next lap with p + QUEUE_SIZE
+	struct LogRecord
+	{
+		std::atomic<u64> sequence;
+		u64 time;
+		LogLevel level;
+		u32 length;
+		char text[MAX_LOG_LEN];
+	};
+
+	static LogRecord records[Logger::QUEUE_SIZE];
+	alignas(64) static std::atomic<u64> enqueuePosition{ 0 };
+	alignas(64) static std::atomic<u64> dequeuePosition{ 0 };
+	static std::atomic<u64> droppedMessages{ 0 };
+	static std::atomic<bool> running{ false };
+
+	static const std::chrono::steady_clock::time_point loggerEpoch = std::chrono::steady_clock::now();
+
+	static std::thread writer;
+	static std::atomic<bool> quit{ false };
+	static std::mutex wakeLock;
+	static std::condition_variable wakeUp;
+	static std::condition_variable flushed;
+	//only read and written by the writer thread, or by ShutDown once it is joined
+	static LoggerConfig config;
+	static char filePath[256];
+	static FILE* file = nullptr;
+	static u64 fileBytes = 0;
+	static u64 reportedDropped = 0;
+
+	//the writer wakes up on its own this often, errors and a half full ring wake it right away
+	static const auto WRITER_INTERVAL = std::chrono::milliseconds(10);
+	static const u32 BATCH_SIZE = 64 * 1024;
+	static char consoleBatch[BATCH_SIZE];
+	static char fileBatch[BATCH_SIZE];
+	static size_t consoleBatchSize = 0;
+	static size_t fileBatchSize = 0;
+	static LogLevel consoleBatchLevel = LogLevel::Info;
+
+	static const char* GetLevelName(LogLevel level)
+	{
+		switch (level)
+		{
+		case LogLevel::Warning: return "warning";
+		case LogLevel::Error: return "error";
+		default: return "info";
+		}
+	}
+
+	static u64 LogTime()
+	{
+		return (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - loggerEpoch).count();
+	}
+
+	static void WriteConsole(LogLevel level, const char* text, size_t size)
+	{
+	#if _WIN32
+		//the console color applies to what is written while it is set
+		HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+		if (level != LogLevel::Info) SetConsoleTextAttribute(console, level == LogLevel::Error ? 12 : 14);
+		fwrite(text, 1, size, stdout);
+		fflush(stdout);
+		if (level != LogLevel::Info) SetConsoleTextAttribute(console, 7);
+	#else
+		//same colors on a terminal, escape codes would only clutter redirected output
+		static const bool colors = isatty(fileno(stdout));
+		if (colors && level != LogLevel::Info) fputs(level == LogLevel::Error ? "\x1b[91m" : "\x1b[93m", stdout);
+		fwrite(text, 1, size, stdout);
+		if (colors && level != LogLevel::Info) fputs("\x1b[0m", stdout);
+	#endif
+	}
+
+	static void RotateFile()
+	{
+		if (file) fclose(file);
+		file = nullptr;
+		fileBytes = 0;
+
+		//path.n-1 -> path.n ... path -> path.1, the oldest one falls off
+		char from[sizeof(filePath) + 16];
+		char to[sizeof(filePath) + 16];
+		if (config.maxFiles > 0)
+		{
+			snprintf(to, sizeof(to), "%s.%u", filePath, config.maxFiles);
+			remove(to);
+			for (u32 i = config.maxFiles - 1; i > 0; i--)
+			{
+				snprintf(from, sizeof(from), "%s.%u", filePath, i);
+				snprintf(to, sizeof(to), "%s.%u", filePath, i + 1);
+				rename(from, to);
+			}
+			snprintf(to, sizeof(to), "%s.1", filePath);
+			rename(filePath, to);
+		}
+
+		file = fopen(filePath, "wb");
+		if (!file)
+		{
+			const char* message = "Logger: can't open the log file, logging to the console only\n";
+			WriteConsole(LogLevel::Error, message, strlen(message));
+		}
+	}
+
+	static void FlushBatches()
+	{
+		if (consoleBatchSize)
+		{
+			WriteConsole(consoleBatchLevel, consoleBatch, consoleBatchSize);
+			consoleBatchSize = 0;
+		}
+		if (fileBatchSize && file)
+		{
+			fwrite(fileBatch, 1, fileBatchSize, file);
+			fileBytes += fileBatchSize;
+			if (fileBytes >= config.maxFileBytes)
+				RotateFile();
+		}
+		fileBatchSize = 0;
+	}
+
+	static void AppendRecord(LogLevel level, u64 time, const char* text, u32 length)
+	{
+		if (config.console)
+		{
+			//a run of records with the same level is written in one go, the color changes between runs
+			if (consoleBatchSize && (level != consoleBatchLevel || consoleBatchSize + length + 1 > BATCH_SIZE))
+				FlushBatches();
+			consoleBatchLevel = level;
+			memcpy(consoleBatch + consoleBatchSize, text, length);
+			consoleBatch[consoleBatchSize + length] = '\n';
+			consoleBatchSize += length + 1;
+		}
+		if (file)
+		{
+			char prefix[48];
+			const int prefixLength = snprintf(prefix, sizeof(prefix), "[%12.6f] %-7s ", (f64)time * 1e-9, GetLevelName(level));
+			if (fileBatchSize + prefixLength + length + 1 > BATCH_SIZE)
+				FlushBatches();
+			memcpy(fileBatch + fileBatchSize, prefix, prefixLength);
+			memcpy(fileBatch + fileBatchSize + prefixLength, text, length);
+			fileBatch[fileBatchSize + prefixLength + length] = '\n';
+			fileBatchSize += prefixLength + length + 1;
+		}
+	}
+
+	//writes every readable record, returns how many
+	static u32 Drain()
+	{
+		u32 count = 0;
+		u64 position = dequeuePosition.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			LogRecord& record = records[position & (Logger::QUEUE_SIZE - 1)];
+			//a writer that claimed the slot but hasn't finished formatting stops the drain here
+			if (record.sequence.load(std::memory_order_acquire) != position + 1) break;
+
+			AppendRecord(record.level, record.time, record.text, record.length);
+			record.sequence.store(position + Logger::QUEUE_SIZE, std::memory_order_release);
+			position++;
+			count++;
+		}
+		dequeuePosition.store(position, std::memory_order_release);
+
+		const u64 dropped = droppedMessages.load(std::memory_order_relaxed);
+		if (dropped != reportedDropped)
+		{
+			char message[96];
+			const int length = snprintf(message, sizeof(message), "Logger: %llu messages dropped, the queue was full", (unsigned long long)(dropped - reportedDropped));
+			AppendRecord(LogLevel::Warning, LogTime(), message, (u32)length);
+			reportedDropped = dropped;
+		}
+
+		if (count)
+		{
+			FlushBatches();
+			fflush(stdout);
+			if (file) fflush(file);
+		}
+		return count;
+	}
+
+	static void WriterLoop()
+	{
+		for (;;)
+		{
+			const bool stopping = quit.load(std::memory_order_acquire);
+			if (Drain())
+			{
+				//taking the lock orders the drain before a Flush that is about to wait
+				{ std::lock_guard<std::mutex> lock(wakeLock); }
+				flushed.notify_all();
+				continue;
+			}
+			if (stopping) break;
+
+			std::unique_lock<std::mutex> lock(wakeLock);
+			flushed.notify_all();
+			wakeUp.wait_for(lock, WRITER_INTERVAL);
+		}
+		flushed.notify_all();
+	}
+
+	void Logger::StartUp(const LoggerConfig& a_config)
+	{
+		if (IsRunning()) return;
+
+		config = a_config;
+		filePath[0] = 0;
+		if (config.filePath)
+		{
+			snprintf(filePath, sizeof(filePath), "%s", config.filePath);
+			RotateFile();
+		}
+		config.filePath = filePath[0] ? filePath : nullptr;
+
+		const u64 start = enqueuePosition.load(std::memory_order_relaxed);
+		for (u64 i = 0; i < QUEUE_SIZE; i++)
+			records[(start + i) & (QUEUE_SIZE - 1)].sequence.store(start + i, std::memory_order_relaxed);
+		dequeuePosition.store(start, std::memory_order_relaxed);
+		reportedDropped = droppedMessages.load(std::memory_order_relaxed);
+
+		quit.store(false);
+		running.store(true, std::memory_order_release);
+		writer = std::thread(WriterLoop);
+	}
+
+	void Logger::ShutDown()
+	{
+		if (!IsRunning()) return;
+
+		running.store(false, std::memory_order_release);
+		{
+			std::lock_guard<std::mutex> lock(wakeLock);
+			quit.store(true, std::memory_order_release);
+		}
+		wakeUp.notify_one();
+		writer.join();
+
+		//whatever raced the stop flag into the ring
+		Drain();
+		if (file) fclose(file);
+		file = nullptr;
+		config = LoggerConfig();
+	}
+
+	bool Logger::IsRunning()
+	{
+		return running.load(std::memory_order_acquire);
+	}
+
+	void Logger::Flush()
+	{
+		if (!IsRunning())
+		{
+			fflush(stdout);
+			return;
+		}
+
+		const u64 target = enqueuePosition.load(std::memory_order_acquire);
+		std::unique_lock<std::mutex> lock(wakeLock);
+		wakeUp.notify_one();
+		flushed.wait(lock, [target]
+		{
+			return dequeuePosition.load(std::memory_order_acquire) >= target || !IsRunning();
+		});
+	}
+
+	u64 Logger::GetDroppedMessages()
+	{
+		return droppedMessages.load(std::memory_order_relaxed);
+	}
+
+	void Logger::LogV(LogLevel level, const char* format, va_list args)
+	{
+		if (!IsRunning())
+		{
+			char msg[MAX_LOG_LEN];
+			int length = vsnprintf(msg, MAX_LOG_LEN - 1, format, args);
+			if (length < 0) return;
+			if (length > MAX_LOG_LEN - 2) length = MAX_LOG_LEN - 2;
+			msg[length] = '\n';
+			WriteConsole(level, msg, (size_t)length + 1);
+			return;
+		}
+
+		//claim a slot, formatting goes straight into it
+		u64 position = enqueuePosition.load(std::memory_order_relaxed);
+		LogRecord* record;
+		for (;;)
+		{
+			record = &records[position & (QUEUE_SIZE - 1)];
+			const s64 difference = (s64)record->sequence.load(std::memory_order_acquire) - (s64)position;
+			if (difference == 0)
+			{
+				if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (difference < 0)
+			{
+				droppedMessages.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			else
+			{
+				position = enqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		int length = vsnprintf(record->text, MAX_LOG_LEN, format, args);
+		if (length < 0) length = 0;
+		if (length > MAX_LOG_LEN - 1) length = MAX_LOG_LEN - 1;
+		record->length = (u32)length;
+		record->level = level;
+		record->time = LogTime();
+		record->sequence.store(position + 1, std::memory_order_release);
+
+		//everything else waits for the writer's next round
+		if (level == LogLevel::Error || position - dequeuePosition.load(std::memory_order_relaxed) >= QUEUE_SIZE / 2)
+			wakeUp.notify_one();
+	}
+
+	void Logger::Log(LogLevel level, const char* format, ...)
+	{
+		va_list args;
+		va_start(args, format);
+		LogV(level, format, args);
+		va_end(args);
+	}
+
+	void Logger::DebugLog(const char* format, ...)
+	{
+		va_list args;
+		va_start(args, format);
+		LogV(LogLevel::Info, format, args);
+		va_end(args);
+	}
+
+	void Logger::DebugLogError(const char* format, ...)
+	{
+		va_list args;
+		va_start(args, format);
+		LogV(LogLevel::Error, format, args);
+		va_end(args);
+	}
+
+	void Logger::DebugLogWarning(const char* format, ...)
+	{
+		va_list args;
+		va_start(args, format);
+		LogV(LogLevel::Warning, format, args);
+		va_end(args);
+	}
+}
@@ -1,19 +1,43 @@
 #ifndef WF_DEBUG_H
 #define WF_DEBUG_H
 #include "wf_pch.h"
-#if _WIN32
-#include "windows.h"
+
+//lowest level compiled in, calls below it vanish including their arguments
+#define WF_LOG_LEVEL_INFO 0
+#define WF_LOG_LEVEL_WARNING 1
+#define WF_LOG_LEVEL_ERROR 2
+#define WF_LOG_LEVEL_NONE 3
+
+//premake defines WF_DEBUG, _DEBUG only comes with the msvc debug runtime
+#ifndef WF_LOG_LEVEL
+	#if defined(WF_DEBUG) || defined(_DEBUG)
+		#define WF_LOG_LEVEL WF_LOG_LEVEL_INFO
+	#else
+		#define WF_LOG_LEVEL WF_LOG_LEVEL_ERROR
+	#endif
 #endif
-#define WF_ASSERT_ALWAYS(exp, msg) Wolf::Logger::DebugLogError("%s :  file: %s : line: %d", msg, __FILE__, __LINE__); while(true){};
+
+#define WF_ASSERT_ALWAYS(exp, msg) Wolf::Logger::DebugLogError("%s :  file: %s : line: %d", msg, __FILE__, __LINE__); Wolf::Logger::Flush(); while(true){};
 #ifdef _DEBUG
-#define WF_ASSERT(exp, msg) Wolf::Logger::DebugLogError("%s :  file: %s : line: %d", msg, __FILE__, __LINE__); abort();
+#define WF_ASSERT(exp, msg) Wolf::Logger::DebugLogError("%s :  file: %s : line: %d", msg, __FILE__, __LINE__); Wolf::Logger::Flush(); abort();
+#else
+#define WF_ASSERT(exp) void(0)
+#define WF_WARNING(...) void(0)
+#endif
+
+#if WF_LOG_LEVEL <= WF_LOG_LEVEL_ERROR
 #define WF_LOGERROR(...) Wolf::Logger::DebugLogError(__VA_ARGS__)
+#else
+#define WF_LOGERROR(...) void(0)
+#endif
+#if WF_LOG_LEVEL <= WF_LOG_LEVEL_WARNING
 #define WF_LOGWARNING(...) Wolf::Logger::DebugLogWarning(__VA_ARGS__)
+#else
+#define WF_LOGWARNING(...) void(0)
+#endif
+#if WF_LOG_LEVEL <= WF_LOG_LEVEL_INFO
 #define WF_LOG(...) Wolf::Logger::DebugLog(__VA_ARGS__)
 #else
-#define WF_ASSERT(exp) void(0)
-#define WF_LOGERROR(...) Wolf::Logger::DebugLogError(__VA_ARGS__)
-#define WF_WARNING(...) void(0)
 #define WF_LOG(...) void(0)
 #endif
 
@@ -21,56 +45,48 @@ namespace Wolf
 {
 	constexpr auto MAX_LOG_LEN = 1024;
 
+	enum class LogLevel : u8
+	{
+		Info,
+		Warning,
+		Error,
+	};
+
+	struct LoggerConfig
+	{
+		bool console = true;
+		//nullptr for console only, the previous file of the same name is rotated to path.1
+		const char* filePath = nullptr;
+		//the file is rotated when it grows past this, path.1 ... path.maxFiles are kept
+		u64 maxFileBytes = 8 * 1024 * 1024;
+		u32 maxFiles = 3;
+	};
+
+	//Messages are formatted on the calling thread into a slot of a lock-free multi producer ring
+	//and written by a background thread in batches, the calling thread never touches the console
+	//or the file. When the ring is full the message is dropped and counted, the writer reports
+	//the count. Before StartUp and after ShutDown messages are written synchronously.
 	class Logger
 	{
 	public:
-		static void DebugLog(const char* format, ...)
-		{
-			va_list args;
-			va_start(args, format);
-			char msg[MAX_LOG_LEN];
-			vsnprintf(msg, (MAX_LOG_LEN - 2), format, args);
-			strcat_s(msg, sizeof(msg), "\n");
-			vprintf(msg, args);
-			va_end(args);
-		}
+		//power of two
+		static const u32 QUEUE_SIZE = 1024;
 
-		static void DebugLogError(const char* format, ...)
-		{
-	#if _WIN32
-			HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-			SetConsoleTextAttribute(hConsole, 12);
-	#endif
-			va_list args;
-			va_start(args, format);
-			char msg[MAX_LOG_LEN];
-			vsnprintf(msg, (MAX_LOG_LEN - 2), format, args);
-			strcat_s(msg, sizeof(msg), "\n");
-			vprintf(msg, args);
-			va_end(args);
-	#if _WIN32
-			SetConsoleTextAttribute(hConsole, 7);
-	#endif
-		}
+		static void StartUp(const LoggerConfig& config = LoggerConfig());
+		//writes what is queued and stops the writer, log from other threads stops before this
+		static void ShutDown();
+		static bool IsRunning();
 
-		static void DebugLogWarning(const char* format, ...)
-		{
-	#if _WIN32
-			HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-			SetConsoleTextAttribute(hConsole, 14);
-	#endif
-			va_list args;
-			va_start(args, format);
-			char msg[MAX_LOG_LEN];
-			vsnprintf(msg, (MAX_LOG_LEN - 2), format, args);
-			strcat_s(msg, sizeof(msg), "\n");
-			vprintf(msg, args);
-			va_end(args);
-	#if _WIN32
-			SetConsoleTextAttribute(hConsole, 7);
-	#endif
-		}
-	};
+		//blocks until everything logged before the call is written, call it before abort()
+		static void Flush();
+		static u64 GetDroppedMessages();
+
+		static void Log(LogLevel level, const char* format, ...);
+		static void LogV(LogLevel level, const char* format, va_list args);
 
+		static void DebugLog(const char* format, ...);
+		static void DebugLogError(const char* format, ...);
+		static void DebugLogWarning(const char* format, ...);
+	};
 }
-#endif
\ No newline at end of file
+#endif //WF_DEBUG_H
@@ -0,0 +1,351 @@
+#include "wf_pch.h"
+#include "wf_ecs.h"
+#include "wf_debug.h"
+#include <mutex>
+
+namespace Wolf
+{
+	namespace Ecs
+	{
+		static ComponentInfo componentInfos[MAX_COMPONENT_TYPES];
+		static u32 componentCount = 0;
+		static std::mutex registerLock;
+
+		u32 RegisterComponent(const ComponentInfo& info)
+		{
+			std::lock_guard<std::mutex> lock(registerLock);
+			if (componentCount >= MAX_COMPONENT_TYPES)
+			{
+				WF_LOGERROR("Ecs: more than %u component types, %s can't be registered", MAX_COMPONENT_TYPES, info.name);
+				Logger::Flush();
+				abort();
+			}
+			if (info.alignment > 64)
+				WF_LOGERROR("Ecs: %s needs %u byte alignment, chunks only guarantee 64", info.name, info.alignment);
+			componentInfos[componentCount] = info;
+			return componentCount++;
+		}
+
+		const ComponentInfo& GetComponentInfo(u32 id)
+		{
+			return componentInfos[id];
+		}
+	}
+
+	static inline void MoveComponent(const ComponentInfo& info, void* destination, void* source)
+	{
+		if (info.trivial)
+		{
+			memcpy(destination, source, info.size);
+			return;
+		}
+		info.moveConstruct(destination, source);
+		info.destruct(source);
+	}
+
+	void CommandBuffer::Write(CommandType type, Entity entity, u32 componentId, const void* payload, u32 size)
+	{
+		const u32 paddedSize = (u32)Memory::alignUp(size, sizeof(Header));
+		const size_t start = data.size();
+		data.resize(start + sizeof(Header) + paddedSize);
+
+		Header header{ type, (u8)componentId, 0, size, entity };
+		memcpy(data.data() + start, &header, sizeof(Header));
+		if (size) memcpy(data.data() + start + sizeof(Header), payload, size);
+	}
+
+	World::World()
+	{
+		//entities without components live in the empty archetype
+		GetArchetype(0);
+	}
+
+	World::~World()
+	{
+		for (Archetype* archetype : archetypes)
+		{
+			for (Chunk* chunk : archetype->chunks)
+			{
+				for (u32 column = 0; column < archetype->componentCount; column++)
+				{
+					const ComponentInfo& info = Ecs::GetComponentInfo(archetype->componentIds[column]);
+					if (info.trivial) continue;
+					for (u32 row = 0; row < chunk->count; row++)
+						info.destruct(archetype->GetComponent(chunk, column, row));
+				}
+				delete chunk;
+			}
+			delete archetype;
+		}
+		for (Chunk* chunk : freeChunks)
+			delete chunk;
+	}
+
+	Archetype* World::GetArchetype(ComponentMask mask)
+	{
+		auto found = archetypeMap.find(mask);
+		if (found != archetypeMap.end()) return found->second;
+
+		MemoryTagScope tag(MemoryTag::Ecs);
+		Archetype* archetype = new Archetype();
+		archetype->mask = mask;
+		memset(archetype->columnOf, -1, sizeof(archetype->columnOf));
+		u32 rowSize = sizeof(Entity);
+		for (u32 id = 0; id < MAX_COMPONENT_TYPES; id++)
+		{
+			if (!((mask >> id) & 1)) continue;
+			archetype->columnOf[id] = (s8)archetype->componentCount;
+			archetype->sizes[archetype->componentCount] = Ecs::GetComponentInfo(id).size;
+			archetype->componentIds[archetype->componentCount++] = id;
+			rowSize += archetype->sizes[archetype->componentCount - 1];
+		}
+
+		//start from the unpadded estimate and shrink until the aligned columns fit
+		const u32 dataSize = sizeof(Chunk::data);
+		u32 capacity = dataSize / rowSize;
+		while (capacity > 0)
+		{
+			size_t offset = sizeof(Entity) * capacity;
+			for (u32 column = 0; column < archetype->componentCount; column++)
+			{
+				const ComponentInfo& info = Ecs::GetComponentInfo(archetype->componentIds[column]);
+				//16 byte aligned columns so systems can use SSE loads
+				offset = Memory::alignUp(offset, info.alignment > 16 ? info.alignment : 16);
+				archetype->offsets[column] = (u32)offset;
+				offset += (size_t)info.size * capacity;
+			}
+			if (offset <= dataSize) break;
+			capacity--;
+		}
+		if (capacity == 0)
+		{
+			WF_LOGERROR("Ecs: components of archetype %llx don't fit in a %u byte chunk", (unsigned long long)mask, Chunk::SIZE);
+			Logger::Flush();
+			abort();
+		}
+		archetype->chunkCapacity = capacity;
+
+		archetypes.push_back(archetype);
+		archetypeMap[mask] = archetype;
+		return archetype;
+	}
+
+	Chunk* World::AllocateChunk(Archetype* archetype)
+	{
+		MemoryTagScope tag(MemoryTag::Ecs);
+		Chunk* chunk;
+		if (!freeChunks.empty())
+		{
+			chunk = freeChunks.back();
+			freeChunks.pop_back();
+		}
+		else
+		{
+			chunk = new Chunk();
+		}
+		chunk->archetype = archetype;
+		chunk->count = 0;
+		archetype->chunks.push_back(chunk);
+		return chunk;
+	}
+
+	void World::FreeChunk(Chunk* chunk)
+	{
+		chunk->archetype->chunks.pop_back();
+		chunk->archetype = nullptr;
+		freeChunks.push_back(chunk);
+	}
+
+	Entity World::AllocateEntity()
+	{
+		if (!freeIndices.empty())
+		{
+			const u32 index = freeIndices.back();
+			freeIndices.pop_back();
+			return Entity{ index, records[index].generation };
+		}
+		MemoryTagScope tag(MemoryTag::Ecs);
+		records.push_back(EntityRecord{ nullptr, 0, 1 });
+		return Entity{ (u32)records.size() - 1, 1 };
+	}
+
+	const World::EntityRecord& World::AllocateRow(Archetype* archetype, Entity entity)
+	{
+		Chunk* chunk = archetype->chunks.empty() ? nullptr : archetype->chunks.back();
+		if (!chunk || chunk->count == archetype->chunkCapacity)
+			chunk = AllocateChunk(archetype);
+
+		const u32 row = chunk->count++;
+		chunk->GetEntities()[row] = entity;
+		archetype->entityCount++;
+
+		EntityRecord& record = records[entity.index];
+		record.chunk = chunk;
+		record.row = row;
+		return record;
+	}
+
+	void World::RemoveRow(Chunk* chunk, u32 row)
+	{
+		//components of the row are already moved out or destroyed, fill the hole with the last entity
+		Archetype* archetype = chunk->archetype;
+		Chunk* last = archetype->chunks.back();
+		const u32 lastRow = last->count - 1;
+		if (last != chunk || lastRow != row)
+		{
+			for (u32 column = 0; column < archetype->componentCount; column++)
+			{
+				const ComponentInfo& info = Ecs::GetComponentInfo(archetype->componentIds[column]);
+				MoveComponent(info, archetype->GetComponent(chunk, column, row), archetype->GetComponent(last, column, lastRow));
+			}
+			const Entity moved = last->GetEntities()[lastRow];
+			chunk->GetEntities()[row] = moved;
+			records[moved.index].chunk = chunk;
+			records[moved.index].row = row;
+		}
+
+		last->count--;
+		archetype->entityCount--;
+		if (last->count == 0) FreeChunk(last);
+	}
+
+	Entity World::Create()
+	{
+		const Entity entity = AllocateEntity();
+		AllocateRow(archetypes[0], entity);
+		return entity;
+	}
+
+	void World::Destroy(Entity entity)
+	{
+		if (!IsAlive(entity)) return;
+
+		EntityRecord& record = records[entity.index];
+		Chunk* chunk = record.chunk;
+		Archetype* archetype = chunk->archetype;
+		for (u32 column = 0; column < archetype->componentCount; column++)
+		{
+			const ComponentInfo& info = Ecs::GetComponentInfo(archetype->componentIds[column]);
+			if (!info.trivial) info.destruct(archetype->GetComponent(chunk, column, record.row));
+		}
+		RemoveRow(chunk, record.row);
+
+		record.chunk = nullptr;
+		//generation 0 is reserved for Entity::Null()
+		record.generation = record.generation + 1 ? record.generation + 1 : 1;
+		freeIndices.push_back(entity.index);
+	}
+
+	void World::MoveEntity(Entity entity, Archetype* destination)
+	{
+		EntityRecord& record = records[entity.index];
+		Chunk* sourceChunk = record.chunk;
+		const u32 sourceRow = record.row;
+		Archetype* source = sourceChunk->archetype;
+
+		AllocateRow(destination, entity);
+		Chunk* destinationChunk = record.chunk;
+		const u32 destinationRow = record.row;
+
+		//shared components are moved, the ones the destination doesn't have are destroyed
+		for (u32 column = 0; column < source->componentCount; column++)
+		{
+			const u32 id = source->componentIds[column];
+			const ComponentInfo& info = Ecs::GetComponentInfo(id);
+			void* component = source->GetComponent(sourceChunk, column, sourceRow);
+			if (destination->columnOf[id] >= 0)
+				MoveComponent(info, destination->GetComponent(destinationChunk, destination->columnOf[id], destinationRow), component);
+			else if (!info.trivial)
+				info.destruct(component);
+		}
+		RemoveRow(sourceChunk, sourceRow);
+	}
+
+	void* World::AddComponent(Entity entity, u32 componentId, bool& existed)
+	{
+		if (!IsAlive(entity)) return nullptr;
+
+		Archetype* source = records[entity.index].chunk->archetype;
+		existed = source->columnOf[componentId] >= 0;
+		if (!existed)
+		{
+			Archetype* destination = source->addEdge[componentId];
+			if (!destination)
+			{
+				destination = GetArchetype(source->mask | (ComponentMask(1) << componentId));
+				source->addEdge[componentId] = destination;
+				destination->removeEdge[componentId] = source;
+			}
+			MoveEntity(entity, destination);
+		}
+
+		const EntityRecord& record = records[entity.index];
+		Archetype* archetype = record.chunk->archetype;
+		return archetype->GetComponent(record.chunk, archetype->columnOf[componentId], record.row);
+	}
+
+	void World::RemoveComponent(Entity entity, u32 componentId)
+	{
+		if (!IsAlive(entity)) return;
+
+		Archetype* source = records[entity.index].chunk->archetype;
+		if (source->columnOf[componentId] < 0) return;
+
+		Archetype* destination = source->removeEdge[componentId];
+		if (!destination)
+		{
+			destination = GetArchetype(source->mask & ~(ComponentMask(1) << componentId));
+			source->removeEdge[componentId] = destination;
+			destination->addEdge[componentId] = source;
+		}
+		MoveEntity(entity, destination);
+	}
+
+	void World::Playback(CommandBuffer& commands)
+	{
+		typedef CommandBuffer::Header Header;
+		typedef CommandBuffer::CommandType CommandType;
+
+		//Entity::Null() in Add/Remove refers to the last entity created by this buffer
+		Entity created = Entity::Null();
+		size_t offset = 0;
+		while (offset < commands.data.size())
+		{
+			Header header;
+			memcpy(&header, commands.data.data() + offset, sizeof(Header));
+			u8* payload = commands.data.data() + offset + sizeof(Header);
+			offset += sizeof(Header) + Memory::alignUp(header.size, sizeof(Header));
+
+			const Entity entity = header.entity.IsNull() ? created : header.entity;
+			switch (header.type)
+			{
+			case CommandType::Create:
+				created = Create();
+				break;
+			case CommandType::Destroy:
+				Destroy(entity);
+				break;
+			case CommandType::Add:
+			{
+				bool existed = false;
+				void* component = AddComponent(entity, header.componentId, existed);
+				//trivially copyable, a copy is a valid construction
+				if (component) memcpy(component, payload, header.size);
+				break;
+			}
+			case CommandType::Remove:
+				RemoveComponent(entity, header.componentId);
+				break;
+			}
+		}
+		commands.Clear();
+	}
+
+	u32 World::GetChunkCount() const
+	{
+		u32 count = 0;
+		for (const Archetype* archetype : archetypes)
+			count += (u32)archetype->chunks.size();
+		return count;
+	}
+}
@@ -0,0 +1,310 @@
+#ifndef WF_ECS_H
+#define WF_ECS_H
+#include "wf_pch.h"
+#include "wf_jobs.h"
+#include "wf_memory.h"
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+//Archetype based entity component system
+//Entities with the same set of components share an Archetype, its entities live in fixed size
+//Chunks with one array per component (SoA), so a query walks plain arrays chunk by chunk.
+//Adding or removing a component moves the entity to another archetype, the hole it leaves is
+//filled with the archetype's last entity so chunks stay dense. Pointers returned by Get are
+//only valid until the next structural change, record those in a CommandBuffer while iterating.
+namespace Wolf
+{
+	//index into the world's entity records, generation tells reused indices apart
+	struct Entity
+	{
+		u32 index;
+		u32 generation;
+
+		bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+		bool operator!=(const Entity& other) const { return !(*this == other); }
+		bool IsNull() const { return generation == 0; }
+		static constexpr Entity Null() { return Entity{ 0, 0 }; }
+	};
+
+	typedef u64 ComponentMask;
+	const u32 MAX_COMPONENT_TYPES = 64;
+
+	struct ComponentInfo
+	{
+		u32 size;
+		u32 alignment;
+		void (*moveConstruct)(void* destination, void* source);
+		void (*destruct)(void* component);
+		//trivially copyable and destructible, moved with memcpy and never destructed
+		bool trivial;
+		const char* name;
+	};
+
+	namespace Ecs
+	{
+		u32 RegisterComponent(const ComponentInfo& info);
+		const ComponentInfo& GetComponentInfo(u32 id);
+
+		//ids are handed out on first use, components need a move constructor
+		template<typename T>
+		u32 ComponentId()
+		{
+			static const u32 id = RegisterComponent(ComponentInfo{
+				(u32)sizeof(T), (u32)alignof(T),
+				[](void* destination, void* source) { new (destination) T(std::move(*(T*)source)); },
+				[](void* component) { ((T*)component)->~T(); },
+				std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value,
+				typeid(T).name() });
+			return id;
+		}
+
+		template<typename... Ts>
+		ComponentMask MaskOf()
+		{
+			return (ComponentMask(0) | ... | (ComponentMask(1) << ComponentId<Ts>()));
+		}
+	}
+
+	class Archetype;
+
+	struct alignas(64) Chunk
+	{
+		static const u32 SIZE = 16 * 1024;
+		static const u32 HEADER_SIZE = 64;
+
+		Archetype* archetype;
+		u32 count;
+		alignas(64) u8 data[SIZE - HEADER_SIZE];
+
+		//the entity array sits first, the component arrays follow
+		Entity* GetEntities() { return (Entity*)data; }
+	};
+
+	class Archetype
+	{
+	public:
+		ComponentMask mask = 0;
+		u32 componentCount = 0;
+		u32 componentIds[MAX_COMPONENT_TYPES];
+		//byte offset of each column inside Chunk::data
+		u32 offsets[MAX_COMPONENT_TYPES];
+		u32 sizes[MAX_COMPONENT_TYPES];
+		//component id to column, -1 when the archetype doesn't have it
+		s8 columnOf[MAX_COMPONENT_TYPES];
+		u32 chunkCapacity = 0;
+		u32 entityCount = 0;
+		//all chunks are full except the last one
+		std::vector<Chunk*> chunks;
+		//archetype reached by adding or removing one component, filled lazily
+		Archetype* addEdge[MAX_COMPONENT_TYPES] = {};
+		Archetype* removeEdge[MAX_COMPONENT_TYPES] = {};
+
+		void* GetComponent(Chunk* chunk, u32 column, u32 row) const
+		{
+			return chunk->data + offsets[column] + row * sizes[column];
+		}
+
+		template<typename T>
+		T* GetColumn(Chunk* chunk) const
+		{
+			return (T*)(chunk->data + offsets[columnOf[Ecs::ComponentId<T>()]]);
+		}
+	};
+
+	class World;
+
+	//Structural changes recorded while iterating (or from jobs, one buffer per thread) and applied
+	//by World::Playback. Component values are copied bytewise so they must be trivially copyable.
+	//The buffer keeps its memory after Clear so a steady state doesn't allocate.
+	class CommandBuffer
+	{
+	public:
+		void Destroy(Entity entity) { Write(CommandType::Destroy, entity, 0, nullptr, 0); }
+
+		template<typename T>
+		void Add(Entity entity, const T& component)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "CommandBuffer components must be trivially copyable");
+			Write(CommandType::Add, entity, Ecs::ComponentId<T>(), &component, sizeof(T));
+		}
+
+		template<typename T>
+		void Remove(Entity entity) { Write(CommandType::Remove, entity, Ecs::ComponentId<T>(), nullptr, 0); }
+
+		//the entity is created at playback
+		template<typename... Ts>
+		void Create(const Ts&... components)
+		{
+			Write(CommandType::Create, Entity::Null(), 0, nullptr, 0);
+			(Add(Entity::Null(), components), ...);
+		}
+
+		void Clear() { data.clear(); }
+		bool IsEmpty() const { return data.empty(); }
+
+	private:
+		friend class World;
+
+		enum class CommandType : u8 { Create, Destroy, Add, Remove };
+
+		//payload follows the header, padded to 16 bytes
+		struct Header
+		{
+			CommandType type;
+			u8 componentId;
+			u16 pad;
+			u32 size;
+			Entity entity;
+		};
+
+		void Write(CommandType type, Entity entity, u32 componentId, const void* payload, u32 size);
+
+		std::vector<u8> data;
+	};
+
+	class World
+	{
+	public:
+		World();
+		~World();
+		World(const World&) = delete;
+		World& operator=(const World&) = delete;
+
+		Entity Create();
+
+		template<typename... Ts>
+		Entity Create(Ts&&... components)
+		{
+			Archetype* archetype = GetArchetype(Ecs::MaskOf<std::decay_t<Ts>...>());
+			const Entity entity = AllocateEntity();
+			const EntityRecord& record = AllocateRow(archetype, entity);
+			(new (archetype->GetColumn<std::decay_t<Ts>>(record.chunk) + record.row) std::decay_t<Ts>(std::forward<Ts>(components)), ...);
+			return entity;
+		}
+
+		void Destroy(Entity entity);
+
+		bool IsAlive(Entity entity) const
+		{
+			return entity.index < records.size() && records[entity.index].generation == entity.generation && records[entity.index].chunk;
+		}
+
+		//replaces the value if the entity already has one
+		template<typename T>
+		T* Add(Entity entity, T&& component)
+		{
+			typedef std::decay_t<T> Type;
+			bool existed = false;
+			void* memory = AddComponent(entity, Ecs::ComponentId<Type>(), existed);
+			if (!memory) return nullptr;
+			if (existed)
+			{
+				*(Type*)memory = std::forward<T>(component);
+				return (Type*)memory;
+			}
+			return new (memory) Type(std::forward<T>(component));
+		}
+
+		template<typename T>
+		void Remove(Entity entity) { RemoveComponent(entity, Ecs::ComponentId<T>()); }
+
+		//nullptr if the entity is dead or doesn't have T
+		template<typename T>
+		T* Get(Entity entity)
+		{
+			if (!IsAlive(entity)) return nullptr;
+			const EntityRecord& record = records[entity.index];
+			const Archetype* archetype = record.chunk->archetype;
+			const s8 column = archetype->columnOf[Ecs::ComponentId<T>()];
+			return column >= 0 ? (T*)archetype->GetComponent(record.chunk, column, record.row) : nullptr;
+		}
+
+		template<typename T>
+		bool Has(Entity entity) const
+		{
+			if (!IsAlive(entity)) return false;
+			return (records[entity.index].chunk->archetype->mask >> Ecs::ComponentId<T>()) & 1;
+		}
+
+		//f(Entity, Ts&...) for every entity that has all of Ts
+		template<typename... Ts, typename F>
+		void Each(F&& f)
+		{
+			const ComponentMask required = Ecs::MaskOf<Ts...>();
+			for (Archetype* archetype : archetypes)
+			{
+				if ((archetype->mask & required) != required) continue;
+				for (Chunk* chunk : archetype->chunks)
+					EachInChunk(chunk, f, archetype->GetColumn<Ts>(chunk)...);
+			}
+		}
+
+		//Each with chunks spread over the job system. f runs concurrently, structural changes
+		//have to go through a CommandBuffer per thread (JobSystem::GetThreadIndex())
+		template<typename... Ts, typename F>
+		void ParallelEach(JobSystem& jobs, F&& f)
+		{
+			const ComponentMask required = Ecs::MaskOf<Ts...>();
+			u32 chunkCount = 0;
+			for (Archetype* archetype : archetypes)
+				if ((archetype->mask & required) == required) chunkCount += (u32)archetype->chunks.size();
+			if (chunkCount == 0) return;
+
+			ScratchScope scratch;
+			Chunk** chunks = scratch.Allocate<Chunk*>(chunkCount);
+			u32 i = 0;
+			for (Archetype* archetype : archetypes)
+				if ((archetype->mask & required) == required)
+					for (Chunk* chunk : archetype->chunks) chunks[i++] = chunk;
+
+			jobs.ParallelFor(chunkCount, 1, [&](u32 begin, u32 end)
+			{
+				for (u32 c = begin; c < end; c++)
+					EachInChunk(chunks[c], f, chunks[c]->archetype->template GetColumn<Ts>(chunks[c])...);
+			});
+		}
+
+		void Playback(CommandBuffer& commands);
+
+		u32 GetEntityCount() const { return (u32)(records.size() - freeIndices.size()); }
+		u32 GetArchetypeCount() const { return (u32)archetypes.size(); }
+		u32 GetChunkCount() const;
+
+	private:
+		struct EntityRecord
+		{
+			Chunk* chunk;
+			u32 row;
+			u32 generation;
+		};
+
+		template<typename F, typename... Ts>
+		static void EachInChunk(Chunk* chunk, F& f, Ts*... columns)
+		{
+			const Entity* entities = chunk->GetEntities();
+			const u32 count = chunk->count;
+			for (u32 row = 0; row < count; row++)
+				f(entities[row], columns[row]...);
+		}
+
+		Archetype* GetArchetype(ComponentMask mask);
+		Entity AllocateEntity();
+		const EntityRecord& AllocateRow(Archetype* archetype, Entity entity);
+		void RemoveRow(Chunk* chunk, u32 row);
+		void MoveEntity(Entity entity, Archetype* destination);
+		void* AddComponent(Entity entity, u32 componentId, bool& existed);
+		void RemoveComponent(Entity entity, u32 componentId);
+		Chunk* AllocateChunk(Archetype* archetype);
+		void FreeChunk(Chunk* chunk);
+
+		std::vector<EntityRecord> records;
+		std::vector<u32> freeIndices;
+		std::vector<Archetype*> archetypes;
+		std::unordered_map<ComponentMask, Archetype*> archetypeMap;
+		std::vector<Chunk*> freeChunks;
+	};
+}
+
+#endif //WF_ECS_H
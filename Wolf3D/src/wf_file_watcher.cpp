@@ -0,0 +1,181 @@
+#include "wf_pch.h"
+#include "wf_file_watcher.h"
+#include "wf_debug.h"
+#include <filesystem>
+#include <thread>
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+namespace Wolf
+{
+	std::string FileWatcher::NormalizePath(const char* path)
+	{
+		std::error_code error;
+		std::filesystem::path absolute = std::filesystem::absolute(path, error);
+		if (error) absolute = path;
+		return absolute.lexically_normal().generic_string();
+	}
+
+#if defined(__linux__)
+	static const u32 WATCH_MASK = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+
+	FileWatcher::FileWatcher()
+	{
+		inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (inotify < 0)
+			WF_LOGERROR("FileWatcher: inotify_init1 failed (%d)", errno);
+	}
+
+	FileWatcher::~FileWatcher()
+	{
+		if (inotify >= 0) close(inotify);
+	}
+
+	bool FileWatcher::AddWatch(const std::string& directory)
+	{
+		const int watch = inotify_add_watch(inotify, directory.c_str(), WATCH_MASK);
+		if (watch < 0)
+		{
+			WF_LOGERROR("FileWatcher: can't watch %s (%d)", directory.c_str(), errno);
+			return false;
+		}
+		directories[watch] = directory;
+		return true;
+	}
+
+	bool FileWatcher::AddDirectory(const char* path)
+	{
+		if (inotify < 0) return false;
+
+		//inotify isn't recursive, every directory gets its own watch
+		const std::string root = NormalizePath(path);
+		if (!AddWatch(root)) return false;
+		std::error_code error;
+		for (std::filesystem::recursive_directory_iterator it(root, error), end; !error && it != end; it.increment(error))
+		{
+			if (it->is_directory(error))
+				AddWatch(it->path().lexically_normal().generic_string());
+		}
+		return true;
+	}
+
+	u32 FileWatcher::Wait(u32 timeoutMs, std::vector<std::string>& changed)
+	{
+		if (inotify < 0)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+			return 0;
+		}
+
+		pollfd descriptor{ inotify, POLLIN, 0 };
+		if (poll(&descriptor, 1, (int)timeoutMs) <= 0) return 0;
+
+		const size_t start = changed.size();
+		alignas(inotify_event) char buffer[4096];
+		for (;;)
+		{
+			const ssize_t size = read(inotify, buffer, sizeof(buffer));
+			if (size <= 0) break;
+
+			for (ssize_t offset = 0; offset < size;)
+			{
+				const inotify_event* event = (const inotify_event*)(buffer + offset);
+				offset += sizeof(inotify_event) + event->len;
+
+				if (event->mask & IN_IGNORED)
+				{
+					directories.erase(event->wd);
+					continue;
+				}
+				if (event->mask & IN_Q_OVERFLOW)
+				{
+					WF_LOGWARNING("FileWatcher: event queue overflow, changes were missed");
+					continue;
+				}
+				auto directory = directories.find(event->wd);
+				if (directory == directories.end() || event->len == 0) continue;
+
+				std::string path = directory->second + "/" + event->name;
+				if (event->mask & IN_ISDIR)
+				{
+					//a new directory or one moved in, files that made it in before the watch are reported now
+					if (!(event->mask & (IN_CREATE | IN_MOVED_TO)) || !AddDirectory(path.c_str())) continue;
+					std::error_code error;
+					for (std::filesystem::recursive_directory_iterator it(path, error), end; !error && it != end; it.increment(error))
+					{
+						if (it->is_regular_file(error))
+							changed.push_back(it->path().lexically_normal().generic_string());
+					}
+					continue;
+				}
+				//a created file is reported when it is closed
+				if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+					changed.push_back(std::move(path));
+			}
+		}
+		return (u32)(changed.size() - start);
+	}
+#else
+	FileWatcher::FileWatcher()
+	{
+	}
+
+	FileWatcher::~FileWatcher()
+	{
+	}
+
+	void FileWatcher::Scan(std::vector<std::string>* changed)
+	{
+		std::error_code error;
+		for (const std::string& root : roots)
+		{
+			for (std::filesystem::recursive_directory_iterator it(root, error), end; !error && it != end; it.increment(error))
+			{
+				if (!it->is_regular_file(error)) continue;
+				const std::filesystem::file_time_type time = it->last_write_time(error);
+				if (error) continue;
+
+				std::string path = it->path().lexically_normal().generic_string();
+				auto known = writeTimes.find(path);
+				if (known == writeTimes.end())
+				{
+					if (changed) changed->push_back(path);
+					writeTimes.emplace(std::move(path), time);
+				}
+				else if (known->second != time)
+				{
+					known->second = time;
+					if (changed) changed->push_back(std::move(path));
+				}
+			}
+		}
+	}
+
+	bool FileWatcher::AddDirectory(const char* path)
+	{
+		const std::string root = NormalizePath(path);
+		std::error_code error;
+		if (!std::filesystem::is_directory(root, error))
+		{
+			WF_LOGERROR("FileWatcher: can't watch %s", root.c_str());
+			return false;
+		}
+		roots.push_back(root);
+		//remember what is there now so only later changes are reported
+		Scan(nullptr);
+		return true;
+	}
+
+	u32 FileWatcher::Wait(u32 timeoutMs, std::vector<std::string>& changed)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+		const size_t start = changed.size();
+		Scan(&changed);
+		return (u32)(changed.size() - start);
+	}
+#endif
+}
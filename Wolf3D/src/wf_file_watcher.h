@@ -0,0 +1,50 @@
+#ifndef WF_FILE_WATCHER_H
+#define WF_FILE_WATCHER_H
+#include "wf_pch.h"
+#include <unordered_map>
+#include <vector>
+#if !defined(__linux__)
+#include <filesystem>
+#endif
+
+namespace Wolf
+{
+	//Reports files written, created or moved into the watched directories and their subdirectories.
+	//Directories are watched rather than files so editors that save through a temporary file and a
+	//rename are seen too. Linux uses inotify, other platforms compare modification times on each Wait.
+	//Not thread safe, one thread owns the watcher.
+	class FileWatcher
+	{
+	public:
+		FileWatcher();
+		~FileWatcher();
+
+		FileWatcher(const FileWatcher&) = delete;
+		FileWatcher& operator=(const FileWatcher&) = delete;
+
+		//watches the directory and everything below it, new subdirectories are picked up
+		bool AddDirectory(const char* path);
+
+		//blocks up to timeoutMs, appends changed files as normalized paths and returns how many
+		u32 Wait(u32 timeoutMs, std::vector<std::string>& changed);
+
+		//absolute, no . or .., forward slashes, the form paths are reported in
+		static std::string NormalizePath(const char* path);
+
+	private:
+	#if defined(__linux__)
+		bool AddWatch(const std::string& directory);
+
+		int inotify = -1;
+		//watch descriptor -> directory
+		std::unordered_map<int, std::string> directories;
+	#else
+		void Scan(std::vector<std::string>* changed);
+
+		std::vector<std::string> roots;
+		std::unordered_map<std::string, std::filesystem::file_time_type> writeTimes;
+	#endif
+	};
+}
+
+#endif //WF_FILE_WATCHER_H
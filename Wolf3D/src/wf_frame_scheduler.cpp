@@ -0,0 +1,90 @@
+#include "wf_pch.h"
+#include "wf_frame_scheduler.h"
+#include <thread>
+
+namespace Wolf
+{
+	FrameScheduler::FrameScheduler(const FrameSchedulerConfig& a_config)
+	{
+		SetConfig(a_config);
+		Reset();
+	}
+
+	void FrameScheduler::SetConfig(const FrameSchedulerConfig& a_config)
+	{
+		config = a_config;
+		if (config.fixedDeltaTime <= 0.0) config.fixedDeltaTime = 1.0 / 60.0;
+		if (config.maxFixedSteps == 0) config.maxFixedSteps = 1;
+	}
+
+	void FrameScheduler::Reset()
+	{
+		lastFrameStart = Clock::now();
+		nextFrameTarget = lastFrameStart;
+		accumulator = 0.0;
+		frameDeltaTime = 0.0;
+	}
+
+	u32 FrameScheduler::BeginFrame()
+	{
+		const Clock::time_point now = Clock::now();
+		const f64 elapsed = std::chrono::duration<f64>(now - lastFrameStart).count();
+		lastFrameStart = now;
+		return Advance(config.simulatedTime ? config.fixedDeltaTime : elapsed);
+	}
+
+	u32 FrameScheduler::Advance(f64 elapsedSeconds)
+	{
+		if (elapsedSeconds < 0.0) elapsedSeconds = 0.0;
+		if (elapsedSeconds > config.maxFrameTime)
+		{
+			droppedTime += elapsedSeconds - config.maxFrameTime;
+			elapsedSeconds = config.maxFrameTime;
+		}
+
+		frameDeltaTime = elapsedSeconds;
+		frameIndex++;
+		accumulator += elapsedSeconds;
+
+		u32 steps = (u32)(accumulator / config.fixedDeltaTime);
+		if (steps > config.maxFixedSteps)
+		{
+			//can't catch up, keep less than one step so the alpha stays meaningful
+			const f64 excess = accumulator - config.maxFixedSteps * config.fixedDeltaTime;
+			const f64 keep = fmod(excess, config.fixedDeltaTime);
+			droppedTime += excess - keep;
+			steps = config.maxFixedSteps;
+			accumulator = keep;
+		}
+		else
+			accumulator -= steps * config.fixedDeltaTime;
+
+		fixedStepIndex += steps;
+		return steps;
+	}
+
+	void FrameScheduler::EndFrame()
+	{
+		if (config.targetFrameRate <= 0.0) return;
+
+		const Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<f64>(1.0 / config.targetFrameRate));
+		nextFrameTarget += period;
+		const Clock::time_point now = Clock::now();
+		//more than a frame behind (hitch or the limiter was just turned on), restart the cadence
+		if (nextFrameTarget + period < now) nextFrameTarget = now;
+		WaitUntil(nextFrameTarget);
+	}
+
+	void FrameScheduler::WaitUntil(Clock::time_point target)
+	{
+		if (!config.yieldOnly)
+		{
+			const Clock::duration sleepTime = (target - Clock::now()) - std::chrono::duration_cast<Clock::duration>(std::chrono::duration<f64>(config.sleepMargin));
+			if (sleepTime > Clock::duration::zero())
+				std::this_thread::sleep_for(sleepTime);
+		}
+
+		while (Clock::now() < target)
+			std::this_thread::yield();
+	}
+}
@@ -0,0 +1,75 @@
+#ifndef WF_FRAME_SCHEDULER_H
+#define WF_FRAME_SCHEDULER_H
+#include "wf_pch.h"
+#include <chrono>
+
+namespace Wolf
+{
+	struct FrameSchedulerConfig
+	{
+		f64 fixedDeltaTime = 1.0 / 60.0;
+		//spiral of death clamp, when a frame needs more fixed steps than this the extra time is dropped
+		u32 maxFixedSteps = 5;
+		//frames longer than this (breakpoints, window drags, loading) count as this long
+		f64 maxFrameTime = 0.25;
+		//0 disables the limiter, vsync can still cap the frame rate
+		f64 targetFrameRate = 0.0;
+		//the limiter sleeps until this much time is left and yields for the rest, it has to cover
+		//the OS wake up latency (SDL sets a 1ms timer resolution on Windows)
+		f64 sleepMargin = 1.5e-3;
+		//spin + yield for the whole wait instead of sleeping, less jitter but keeps a core busy
+		bool yieldOnly = false;
+		//every frame advances exactly fixedDeltaTime instead of the measured time, so one frame is
+		//one fixed step. Headless simulation runs as fast as it can (targetFrameRate 0) or at a fixed rate
+		bool simulatedTime = false;
+	};
+
+	//Accumulator based fixed step: every frame adds its duration to the accumulator and
+	//runs fixed steps while it holds at least fixedDeltaTime. The leftover fraction is the
+	//interpolation alpha between the last two fixed states.
+	class FrameScheduler
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		FrameScheduler(const FrameSchedulerConfig& a_config = FrameSchedulerConfig());
+
+		void SetConfig(const FrameSchedulerConfig& a_config);
+		const FrameSchedulerConfig& GetConfig() const { return config; }
+
+		//restarts timing from now, the next frame gets 0 elapsed time
+		void Reset();
+
+		//measures the time since the last frame and returns the number of fixed steps to run
+		u32 BeginFrame();
+		//same as BeginFrame with an explicit elapsed time, deterministic for replays and tools
+		u32 Advance(f64 elapsedSeconds);
+		//waits for the target frame rate if the limiter is on
+		void EndFrame();
+
+		f32 GetFixedDeltaTime() const { return (f32)config.fixedDeltaTime; }
+		f32 GetFrameDeltaTime() const { return (f32)frameDeltaTime; }
+		//accumulator / fixedDeltaTime in [0, 1)
+		f32 GetAlpha() const { return (f32)(accumulator / config.fixedDeltaTime); }
+
+		u64 GetFrameIndex() const { return frameIndex; }
+		u64 GetFixedStepIndex() const { return fixedStepIndex; }
+		//simulation time lost to the spiral of death clamp and maxFrameTime
+		f64 GetDroppedTime() const { return droppedTime; }
+
+	private:
+		void WaitUntil(Clock::time_point target);
+
+		FrameSchedulerConfig config;
+		Clock::time_point lastFrameStart;
+		Clock::time_point nextFrameTarget;
+		f64 accumulator = 0.0;
+		f64 frameDeltaTime = 0.0;
+		f64 droppedTime = 0.0;
+		u64 frameIndex = 0;
+		u64 fixedStepIndex = 0;
+
+	};
+}
+
+#endif //WF_FRAME_SCHEDULER_H
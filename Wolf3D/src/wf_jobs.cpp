@@ -0,0 +1,327 @@
+#include "wf_pch.h"
+#include "wf_jobs.h"
+#include "wf_debug.h"
+#include "wf_profiler.h"
+
+namespace Wolf
+{
+	//workers belong to one system for their whole life, the main thread is recognized by id
+	//since it can start several systems
+	struct WorkerIdentity
+	{
+		const JobSystem* system;
+		s32 index;
+	};
+	static thread_local WorkerIdentity worker = { nullptr, -1 };
+
+	bool JobDeque::Push(JobSlot* job)
+	{
+		const s64 b = bottom.load(std::memory_order_relaxed);
+		const s64 t = top.load(std::memory_order_acquire);
+		if (b - t >= (s64)CAPACITY) return false;
+
+		jobs[b & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+		//release store instead of fence + relaxed store, same guarantee and TSan understands it
+		bottom.store(b + 1, std::memory_order_release);
+		return true;
+	}
+
+	JobSlot* JobDeque::Pop()
+	{
+		const s64 b = bottom.load(std::memory_order_relaxed) - 1;
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		s64 t = top.load(std::memory_order_relaxed);
+
+		if (t > b)
+		{
+			//empty
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		JobSlot* job = jobs[b & (CAPACITY - 1)].load(std::memory_order_relaxed);
+		if (t == b)
+		{
+			//last job, race the thieves for it
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				job = nullptr;
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+		return job;
+	}
+
+	JobSlot* JobDeque::Steal()
+	{
+		s64 t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const s64 b = bottom.load(std::memory_order_acquire);
+		if (t >= b) return nullptr;
+
+		JobSlot* job = jobs[t & (CAPACITY - 1)].load(std::memory_order_relaxed);
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return nullptr;
+		return job;
+	}
+
+	void JobSystem::StartUp(u32 workerCount)
+	{
+		if (IsRunning()) return;
+		MemoryTagScope tag(MemoryTag::Jobs);
+		if (workerCount == 0)
+		{
+			const u32 cores = std::thread::hardware_concurrency();
+			workerCount = cores > 1 ? cores - 1 : 1;
+		}
+
+		quit.store(false);
+		mainThread = std::this_thread::get_id();
+		for (u32 i = 0; i < workerCount + 1; i++)
+			threadData.push_back(new ThreadData());
+		for (u32 i = 1; i <= workerCount; i++)
+			threads.emplace_back(&JobSystem::WorkerLoop, this, i);
+	}
+
+	void JobSystem::ShutDown()
+	{
+		if (!IsRunning()) return;
+
+		//let everything queued finish first, jobs may still be spawning jobs
+		const s32 index = GetThreadIndex();
+		while ((index >= 0 && RunOne(index)) || queuedJobs.load() > 0) {}
+
+		{
+			std::lock_guard<std::mutex> lock(sleepLock);
+			quit.store(true);
+		}
+		wakeUp.notify_all();
+		for (std::thread& thread : threads)
+			thread.join();
+		threads.clear();
+
+		for (ThreadData* data : threadData)
+			delete data;
+		threadData.clear();
+		mainThread = std::thread::id();
+	}
+
+	s32 JobSystem::GetThreadIndex() const
+	{
+		if (worker.system == this) return worker.index;
+		return IsRunning() && std::this_thread::get_id() == mainThread ? 0 : -1;
+	}
+
+	JobSlot* JobSystem::AllocateSlot(ThreadData* data, const Job& job)
+	{
+		//a slot stays queued until the thread running it copied the job out, the owner skips
+		//those instead of overwriting a job that is still in a deque or being read by a thief
+		for (u32 i = 0; i < JOBS_PER_THREAD; i++)
+		{
+			JobSlot* slot = &data->slots[data->nextSlot++ & (JOBS_PER_THREAD - 1)];
+			if (slot->queued.load(std::memory_order_acquire)) continue;
+			slot->job = job;
+			slot->queued.store(true, std::memory_order_relaxed);
+			return slot;
+		}
+		return nullptr;
+	}
+
+	void JobSystem::Run(const Job& job, JobCounter* counter)
+	{
+		Job queued = job;
+		if (counter)
+		{
+			counter->count.fetch_add(1, std::memory_order_relaxed);
+			queued.counter = counter;
+		}
+
+		const s32 index = GetThreadIndex();
+		if (index < 0)
+		{
+			if (IsRunning()) WF_LOGERROR("JobSystem::Run called from a thread the job system doesn't own, running inline");
+			Execute(queued);
+			return;
+		}
+		Push(index, queued);
+	}
+
+	bool JobSystem::RunAfter(JobCounter& dependency, const Job& job, JobCounter* counter)
+	{
+		Job queued = job;
+		if (counter)
+		{
+			counter->count.fetch_add(1, std::memory_order_relaxed);
+			queued.counter = counter;
+		}
+
+		bool full = false;
+		{
+			std::lock_guard<std::mutex> lock(dependency.continuationLock);
+			if (!dependency.IsDone())
+			{
+				JobContinuation* continuation;
+				{
+					std::lock_guard<std::mutex> poolLock(continuationPoolLock);
+					continuation = continuationPool.Create(JobContinuation{ queued, dependency.continuations });
+				}
+				if (continuation)
+				{
+					dependency.continuations = continuation;
+					return true;
+				}
+				full = true;
+			}
+		}
+		if (full)
+		{
+			//waiting here would turn a scheduling call into a hidden sync point, the caller
+			//decides. Finish undoes the increment and launches what waits on the counter
+			WF_LOGERROR("JobSystem out of continuations (%u), RunAfter didn't queue the job", MAX_CONTINUATIONS);
+			if (counter) Finish(counter);
+			return false;
+		}
+
+		const s32 index = GetThreadIndex();
+		if (index < 0)
+			Execute(queued);
+		else
+			Push(index, queued);
+		return true;
+	}
+
+	void JobSystem::Push(s32 index, const Job& job)
+	{
+		ThreadData* data = threadData[index];
+		JobSlot* slot = AllocateSlot(data, job);
+		if (!slot)
+		{
+			//every slot of this thread is queued, running it here keeps the program correct
+			Execute(job);
+			return;
+		}
+		if (!data->deque.Push(slot))
+		{
+			//can't happen while the ring is as big as the deque, kept as the same fallback
+			RunSlot(slot);
+			return;
+		}
+
+		//seq_cst pairs with the worker incrementing sleepingWorkers before checking queuedJobs
+		queuedJobs.fetch_add(1);
+		if (sleepingWorkers.load() > 0)
+		{
+			//taking the lock makes sure a worker between its check and wait() gets the notify
+			{ std::lock_guard<std::mutex> lock(sleepLock); }
+			wakeUp.notify_one();
+		}
+	}
+
+	bool JobSystem::RunOne(s32 index)
+	{
+		const u32 count = (u32)threadData.size();
+		JobSlot* slot = threadData[index]->deque.Pop();
+		for (u32 i = 1; !slot && i < count; i++)
+			slot = threadData[(index + i) % count]->deque.Steal();
+		if (!slot) return false;
+
+		queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+		RunSlot(slot);
+		return true;
+	}
+
+	void JobSystem::RunSlot(JobSlot* slot)
+	{
+		//copy out and hand the slot back before running, jobs spawned from this one can reuse it
+		const Job job = slot->job;
+		slot->queued.store(false, std::memory_order_release);
+		Execute(job);
+	}
+
+	void JobSystem::Execute(const Job& job)
+	{
+		job.function(job.data);
+		if (job.counter) Finish(job.counter);
+	}
+
+	void JobSystem::Finish(JobCounter* counter)
+	{
+		u32 count = counter->count.load(std::memory_order_relaxed);
+		while (count > 1)
+		{
+			if (counter->count.compare_exchange_weak(count, count - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+				return;
+		}
+
+		//last job, the counter hits 0 under the lock and isn't touched after unlocking,
+		//Wait takes the same lock before returning so the owner can destroy the counter safely
+		JobContinuation* ready = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(counter->continuationLock);
+			if (counter->count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				ready = counter->continuations;
+				counter->continuations = nullptr;
+			}
+		}
+		while (ready)
+		{
+			const Job job = ready->job;
+			JobContinuation* next = ready->next;
+			{
+				std::lock_guard<std::mutex> poolLock(continuationPoolLock);
+				continuationPool.Destroy(ready);
+			}
+			ready = next;
+
+			const s32 index = GetThreadIndex();
+			if (index < 0)
+				Execute(job);
+			else
+				Push(index, job);
+		}
+	}
+
+	void JobSystem::Wait(JobCounter& counter)
+	{
+		const s32 index = GetThreadIndex();
+		while (!counter.IsDone())
+		{
+			if (index < 0 || !RunOne(index))
+				std::this_thread::yield();
+		}
+		//the last Finish may still be inside the lock
+		std::lock_guard<std::mutex> lock(counter.continuationLock);
+	}
+
+	void JobSystem::WorkerLoop(u32 index)
+	{
+		worker = { this, (s32)index };
+	#ifdef WF_PROFILE
+		char name[32];
+		snprintf(name, sizeof(name), "Worker %u", index);
+		Profiler::SetThreadName(name);
+	#endif
+		u32 idleSpins = 0;
+		while (!quit.load(std::memory_order_relaxed))
+		{
+			if (RunOne((s32)index))
+			{
+				idleSpins = 0;
+				continue;
+			}
+
+			//spin a little before sleeping, jobs often come in bursts
+			if (++idleSpins < 64)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(sleepLock);
+			sleepingWorkers.fetch_add(1);
+			wakeUp.wait(lock, [this]() { return queuedJobs.load() > 0 || quit.load(); });
+			sleepingWorkers.fetch_sub(1);
+			idleSpins = 0;
+		}
+	}
+}
@@ -0,0 +1,199 @@
+#ifndef WF_JOBS_H
+#define WF_JOBS_H
+#include "wf_pch.h"
+#include "wf_memory.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Wolf
+{
+	typedef void (*JobFunction)(void* data);
+
+	class JobCounter;
+
+	struct Job
+	{
+		JobFunction function = nullptr;
+		void* data = nullptr;
+		//decremented when the job finishes, can be null
+		JobCounter* counter = nullptr;
+	};
+
+	//a queued job in the ring of its thread, free again once the job has been copied out to run
+	struct JobSlot
+	{
+		Job job;
+		std::atomic<bool> queued{ false };
+	};
+
+	struct JobContinuation
+	{
+		Job job;
+		JobContinuation* next;
+	};
+
+	//Number of unfinished jobs attached to it. JobSystem::Wait blocks on it, RunAfter
+	//queues continuations that are launched when it reaches 0.
+	//Don't reuse a counter while it still has continuations queued and Wait on it before
+	//destroying it, the last job may still be finishing after the count reads 0.
+	class JobCounter
+	{
+	public:
+		bool IsDone() const { return count.load(std::memory_order_acquire) == 0; }
+		u32 GetCount() const { return count.load(std::memory_order_acquire); }
+
+	private:
+		friend class JobSystem;
+		std::atomic<u32> count{ 0 };
+		std::mutex continuationLock;
+		JobContinuation* continuations = nullptr;
+	};
+
+	//Chase-Lev work stealing deque (Le et al. 2013 memory orders), fixed capacity
+	//the owner thread pushes and pops at the bottom, other threads steal from the top
+	class JobDeque
+	{
+	public:
+		static const u32 CAPACITY = 4096;
+
+		bool Push(JobSlot* job);
+		JobSlot* Pop();
+		JobSlot* Steal();
+
+	private:
+		alignas(64) std::atomic<s64> top{ 0 };
+		alignas(64) std::atomic<s64> bottom{ 0 };
+		std::atomic<JobSlot*> jobs[CAPACITY];
+	};
+
+	//Work stealing job system. Thread 0 is the thread that calls StartUp (the main thread),
+	//workers are 1..n. Every thread owns a deque and a ring of job slots, Run pushes to the
+	//caller's deque and idle threads steal from the others. Wait runs jobs on the calling
+	//thread until the counter is done, so the main thread helps instead of blocking.
+	//Run/Wait/ParallelFor can only be called from the main thread or from inside jobs of this
+	//system, other threads (a worker of another JobSystem too) run the job inline.
+	class JobSystem
+	{
+	public:
+		//jobs each thread can have queued, Run executes the job inline once they're all in use
+		static const u32 JOBS_PER_THREAD = JobDeque::CAPACITY;
+		//RunAfter jobs waiting on counters, across all threads
+		static const u32 MAX_CONTINUATIONS = 1024;
+		static_assert((JOBS_PER_THREAD & (JOBS_PER_THREAD - 1)) == 0, "the slot ring is indexed with a mask");
+
+		JobSystem() = default;
+		~JobSystem() { ShutDown(); }
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		//workerCount 0 uses hardware_concurrency() - 1 workers
+		void StartUp(u32 workerCount = 0);
+		void ShutDown();
+		bool IsRunning() const { return !threads.empty(); }
+
+		//threads including the main one
+		u32 GetThreadCount() const { return (u32)threads.size() + 1; }
+		//0 on the main thread, 1..n on workers, -1 on threads not owned by this system
+		s32 GetThreadIndex() const;
+
+		void Run(const Job& job, JobCounter* counter = nullptr);
+		void Run(JobFunction function, void* data, JobCounter* counter = nullptr) { Run(Job{ function, data, nullptr }, counter); }
+		//launched once dependency reaches 0, counter is incremented right away. Never blocks:
+		//false (logged) when all MAX_CONTINUATIONS are in use, then nothing is queued and the
+		//caller picks the fallback, usually Wait(dependency) then Run
+		bool RunAfter(JobCounter& dependency, const Job& job, JobCounter* counter = nullptr);
+
+		//runs queued jobs on this thread until counter reaches 0, the counter can be destroyed after
+		void Wait(JobCounter& counter);
+
+		//body(begin, end) over [0, count) in chunks of grainSize indices, blocks until done
+		//chunks are handed out from an atomic cursor so uneven chunks balance themselves
+		//grainSize 0 picks count / (threads * 8)
+		template<typename F>
+		void ParallelFor(u32 count, u32 grainSize, const F& body);
+
+	private:
+		struct ThreadData
+		{
+			JobDeque deque;
+			JobSlot slots[JOBS_PER_THREAD];
+			u32 nextSlot = 0;
+		};
+
+		template<typename F>
+		struct ParallelForData
+		{
+			const F* body;
+			std::atomic<u32> cursor;
+			u32 count;
+			u32 grainSize;
+
+			static void Execute(void* data)
+			{
+				ParallelForData* self = (ParallelForData*)data;
+				while (true)
+				{
+					const u32 begin = self->cursor.fetch_add(self->grainSize, std::memory_order_relaxed);
+					if (begin >= self->count) break;
+					const u32 end = self->count - begin < self->grainSize ? self->count : begin + self->grainSize;
+					(*self->body)(begin, end);
+				}
+			}
+		};
+
+		JobSlot* AllocateSlot(ThreadData* data, const Job& job);
+		void Push(s32 index, const Job& job);
+		bool RunOne(s32 index);
+		void RunSlot(JobSlot* slot);
+		void Execute(const Job& job);
+		void Finish(JobCounter* counter);
+		void WorkerLoop(u32 index);
+
+		std::vector<std::thread> threads;
+		std::vector<ThreadData*> threadData;
+		std::thread::id mainThread;
+		std::atomic<bool> quit{ false };
+
+		Pool<JobContinuation> continuationPool{ MAX_CONTINUATIONS };
+		std::mutex continuationPoolLock;
+
+		//sleeping workers are woken when jobs are queued
+		std::atomic<s32> queuedJobs{ 0 };
+		std::atomic<u32> sleepingWorkers{ 0 };
+		std::mutex sleepLock;
+		std::condition_variable wakeUp;
+	};
+
+	template<typename F>
+	void JobSystem::ParallelFor(u32 count, u32 grainSize, const F& body)
+	{
+		if (count == 0) return;
+		const u32 threadCount = GetThreadCount();
+		if (grainSize == 0) grainSize = count / (threadCount * 8) > 0 ? count / (threadCount * 8) : 1;
+
+		const u32 chunks = (count + grainSize - 1) / grainSize;
+		if (chunks == 1 || !IsRunning() || GetThreadIndex() < 0)
+		{
+			body(0u, count);
+			return;
+		}
+
+		ParallelForData<F> data;
+		data.body = &body;
+		data.cursor.store(0, std::memory_order_relaxed);
+		data.count = count;
+		data.grainSize = grainSize;
+
+		//one job per thread at most, the caller runs one of them inside Wait
+		JobCounter counter;
+		const u32 jobCount = chunks < threadCount ? chunks : threadCount;
+		for (u32 i = 0; i < jobCount; i++)
+			Run(&ParallelForData<F>::Execute, &data, &counter);
+		Wait(counter);
+	}
+}
+
+#endif //WF_JOBS_H
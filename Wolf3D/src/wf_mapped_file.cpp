@@ -0,0 +1,121 @@
+#include "wf_pch.h"
+#include "wf_mapped_file.h"
+#if _WIN32
+#include "windows.h"
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Wolf
+{
+	MappedFile::MappedFile(MappedFile&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this == &other) return *this;
+		Close();
+		data = other.data;
+		size = other.size;
+		other.data = nullptr;
+		other.size = 0;
+	#if _WIN32
+		mapping = other.mapping;
+		other.mapping = nullptr;
+	#endif
+		return *this;
+	}
+
+#if _WIN32
+	bool MappedFile::Open(const char* path)
+	{
+		Close();
+		HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+		//the mapping keeps the file open
+		HANDLE fileMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(file);
+		if (!fileMapping) return false;
+
+		const void* view = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+		if (!view)
+		{
+			CloseHandle(fileMapping);
+			return false;
+		}
+		mapping = fileMapping;
+		data = (const u8*)view;
+		size = (u64)fileSize.QuadPart;
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (!data) return;
+		UnmapViewOfFile(data);
+		CloseHandle(mapping);
+		mapping = nullptr;
+		data = nullptr;
+		size = 0;
+	}
+
+	void MappedFile::Prefetch(u64 offset, u64 bytes) const
+	{
+		if (!data || offset >= size) return;
+		WIN32_MEMORY_RANGE_ENTRY range{ (void*)(data + offset), (SIZE_T)(bytes < size - offset ? bytes : size - offset) };
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+	}
+#else
+	bool MappedFile::Open(const char* path)
+	{
+		Close();
+		const int file = open(path, O_RDONLY | O_CLOEXEC);
+		if (file < 0) return false;
+
+		struct stat info;
+		if (fstat(file, &info) != 0 || info.st_size == 0)
+		{
+			::close(file);
+			return false;
+		}
+		//the mapping stays valid after the descriptor is closed
+		void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		::close(file);
+		if (view == MAP_FAILED) return false;
+
+		data = (const u8*)view;
+		size = (u64)info.st_size;
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (!data) return;
+		munmap((void*)data, (size_t)size);
+		data = nullptr;
+		size = 0;
+	}
+
+	void MappedFile::Prefetch(u64 offset, u64 bytes) const
+	{
+		if (!data || offset >= size) return;
+		//madvise wants a page aligned start
+		const u64 page = (u64)sysconf(_SC_PAGESIZE);
+		const u64 start = offset & ~(page - 1);
+		const u64 end = bytes < size - offset ? offset + bytes : size;
+		madvise((void*)(data + start), (size_t)(end - start), MADV_WILLNEED);
+	}
+#endif
+}
@@ -0,0 +1,39 @@
+#ifndef WF_MAPPED_FILE_H
+#define WF_MAPPED_FILE_H
+#include "wf_pch.h"
+
+namespace Wolf
+{
+	//Read only view of a whole file. Pages are loaded by the OS on first touch and shared with
+	//the file cache, so opening is cheap and nothing is copied into the heap.
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		~MappedFile() { Close(); }
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		bool Open(const char* path);
+		void Close();
+
+		bool IsOpen() const { return data != nullptr; }
+		const u8* GetData() const { return data; }
+		u64 GetSize() const { return size; }
+
+		//tells the OS the range is about to be read, it starts paging it in
+		void Prefetch(u64 offset, u64 bytes) const;
+
+	private:
+		const u8* data = nullptr;
+		u64 size = 0;
+	#if _WIN32
+		void* mapping = nullptr;
+	#endif
+	};
+}
+
+#endif //WF_MAPPED_FILE_H
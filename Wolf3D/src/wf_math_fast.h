@@ -0,0 +1,182 @@
+#ifndef WF_MATH_FAST_H
+#define WF_MATH_FAST_H
+#include "wf_math.h"
+
+//Opt-in approximations of the libm calls used by wf_math.h
+//Each function documents its max error against the libm double precision result over the
+//stated domain, MathBench --accuracy measures them again and fails if a bound is exceeded.
+//Inputs are not checked for nan/inf.
+namespace Wolf
+{
+	namespace Math
+	{
+		namespace Fast
+		{
+			//relative error <= 3e-7 for x in [1e-30, 1e30]
+			inline f32 rsqrt(f32 x)
+			{
+	#ifdef WF_SIMD_SSE
+				const f32 y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+				return y * (1.5f - 0.5f * x * y * y);
+	#else
+				union { f32 f; u32 i; } bits = { x };
+				bits.i = 0x5f375a86 - (bits.i >> 1);
+				f32 y = bits.f;
+				y = y * (1.5f - 0.5f * x * y * y);
+				y = y * (1.5f - 0.5f * x * y * y);
+				return y * (1.5f - 0.5f * x * y * y);
+	#endif
+			}
+
+			//relative error <= 3e-7 for x in [1e-30, 1e30], 0 for x == 0
+			inline f32 sqrt(f32 x)
+			{
+				return x > 0.0f ? x * rsqrt(x) : 0.0f;
+			}
+
+			//length of the result is 1 within 4e-7
+			inline Vec2 normalized(const Vec2& v)
+			{
+				const f32 inv = rsqrt(v.sqrmod());
+				return Vec2(v.x * inv, v.y * inv);
+			}
+
+			inline Vec3 normalized(const Vec3& v)
+			{
+				const f32 inv = rsqrt(v.sqrmod());
+				return Vec3(v.x * inv, v.y * inv, v.z * inv);
+			}
+
+			inline void normalize(Vec3& v)
+			{
+				v *= rsqrt(v.sqrmod());
+			}
+
+			inline void normalize(Quaternion& q)
+			{
+				q *= rsqrt(q.squaredLength());
+			}
+
+			//adding 1.5 * 2^23 pushes the fraction out of the mantissa, so the float add rounds to
+			//nearest and the low mantissa bits hold the integer. No floorf call (a libm call without
+			//SSE4.1) and no float to int conversion, loops using it still vectorize. Valid for |x| < 2^22
+			const f32 roundShifter = 12582912.0f;
+			const u32 roundShifterBits = 0x4b400000;
+
+			inline f32 roundNearest(f32 x)
+			{
+				return (x + roundShifter) - roundShifter;
+			}
+
+			//x - k * 2pi into [-pi, pi], 2pi split in 3 parts (Cody-Waite) so k * 2pi doesn't round
+			inline f32 reduceAngle(f32 x)
+			{
+				const f32 k = roundNearest(x * 0.159154943f);
+				return ((x - k * 6.28125f) - k * 1.93530717e-3f) - k * 1.26255e-11f;
+			}
+
+			//sin for x in [-pi/2, pi/2], Taylor up to x^11, truncation error 6e-8 at pi/2
+			inline f32 sinPoly(f32 x)
+			{
+				const f32 x2 = x * x;
+				return x * (1.0f + x2 * (-1.66666667e-1f + x2 * (8.33333333e-3f + x2 * (-1.98412698e-4f + x2 * (2.75573192e-6f + x2 * -2.50521084e-8f)))));
+			}
+
+			//absolute error <= 3e-7 for x in [-1e4, 1e4]
+			//branch free so it doesn't mispredict on scattered angles
+			inline f32 sin(f32 x)
+			{
+				x = reduceAngle(x);
+				//|x| folded into [0, pi/2] around pi/2, sign restored at the end
+				//the reduction can overshoot pi slightly, folded goes negative and stays correct
+				const f32 folded = 1.57079633f - fabsf(1.57079633f - fabsf(x));
+				return copysignf(1.0f, x) * sinPoly(folded);
+			}
+
+			//absolute error <= 3e-7 for x in [-1e4, 1e4]
+			inline f32 cos(f32 x)
+			{
+				x = reduceAngle(x);
+				return sinPoly(1.57079633f - fabsf(x));
+			}
+
+			//absolute error <= 1.5e-5 rad, polynomial from Abramowitz & Stegun 4.4.49
+			inline f32 atan(f32 x)
+			{
+				const bool invert = x > 1.0f || x < -1.0f;
+				const f32 t = invert ? 1.0f / x : x;
+				const f32 t2 = t * t;
+				const f32 r = t * (0.9998660f + t2 * (-0.3302995f + t2 * (0.1801410f + t2 * (-0.0851330f + t2 * 0.0208351f))));
+				if (!invert) return r;
+				return (x > 0.0f ? 1.57079633f : -1.57079633f) - r;
+			}
+
+			//absolute error <= 1.5e-5 rad, same quadrant rules as atan2f, atan2(0, 0) == 0
+			inline f32 atan2(f32 y, f32 x)
+			{
+				if (x == 0.0f)
+				{
+					if (y > 0.0f) return 1.57079633f;
+					if (y < 0.0f) return -1.57079633f;
+					return 0.0f;
+				}
+				const f32 r = atan(y / x);
+				if (x > 0.0f) return r;
+				return y >= 0.0f ? r + 3.14159265f : r - 3.14159265f;
+			}
+
+			//absolute error <= 7e-5 rad for x in [-1, 1], Abramowitz & Stegun 4.4.45
+			inline f32 acos(f32 x)
+			{
+				const f32 ax = x < 0.0f ? -x : x;
+				const f32 r = sqrt(1.0f - ax) * (1.5707288f + ax * (-0.2121144f + ax * (0.0742610f + ax * -0.0187293f)));
+				return x < 0.0f ? 3.14159265f - r : r;
+			}
+
+			//ln2 split in 2 parts so k * ln2Hi is exact
+			const f32 ln2Hi = 0.693145752f;
+			const f32 ln2Lo = 1.42860677e-6f;
+
+			//relative error <= 3e-7 for x in [-87, 88], inputs outside are clamped
+			inline f32 exp(f32 x)
+			{
+				x = Math::clamp(x, -87.0f, 88.0f);
+
+				//x = k * ln2 + r, r in [-ln2/2, ln2/2]
+				union { f32 f; u32 i; } shifted = { x * 1.44269504f + roundShifter };
+				const f32 k = shifted.f - roundShifter;
+				const f32 r = (x - k * ln2Hi) - k * ln2Lo;
+				const f32 p = 1.0f + r * (1.0f + r * (0.5f + r * (1.66666667e-1f + r * (4.16666667e-2f + r * (8.33333333e-3f + r * 1.38888889e-3f)))));
+
+				//2^k built straight into the exponent bits
+				union { u32 i; f32 f; } scale;
+				scale.i = (shifted.i - roundShifterBits + 127) << 23;
+				return p * scale.f;
+			}
+
+			//absolute error <= 6e-7 for x in [1e-6, 1e6] (most of it is the float rounding of the result)
+			//normal floats only
+			inline f32 log(f32 x)
+			{
+				//x = m * 2^e, m in [sqrt(1/2), sqrt(2))
+				union { f32 f; u32 i; } bits = { x };
+				s32 e = (s32)((bits.i >> 23) & 0xff) - 127;
+				bits.i = (bits.i & 0x007fffff) | 0x3f800000;
+				f32 m = bits.f;
+				if (m > 1.41421356f)
+				{
+					m *= 0.5f;
+					e++;
+				}
+
+				//log(m) = 2 * atanh(s), s = (m - 1) / (m + 1), |s| <= 0.172
+				const f32 s = (m - 1.0f) / (m + 1.0f);
+				const f32 s2 = s * s;
+				const f32 logM = 2.0f * s * (1.0f + s2 * (3.33333333e-1f + s2 * (2.0e-1f + s2 * (1.42857143e-1f + s2 * 1.11111111e-1f))));
+				return (f32)e * ln2Hi + ((f32)e * ln2Lo + logM);
+			}
+		}
+	}
+}
+
+#endif //WF_MATH_FAST_H
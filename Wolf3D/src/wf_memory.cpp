@@ -0,0 +1,327 @@
+#include "wf_pch.h"
+#include "wf_memory.h"
+#include "wf_debug.h"
+#include <cfloat>
+
+namespace Wolf
+{
+	//in front of every tracked block, offset leads back to what malloc returned
+	struct AllocationHeader
+	{
+		u64 size;
+		u32 offset;
+		u8 tag;
+		u8 pad[3];
+	};
+	static_assert(sizeof(AllocationHeader) == 16, "tracked blocks assume a 16 byte header");
+
+	struct TagCounters
+	{
+		std::atomic<u64> current{ 0 };
+		std::atomic<u64> peak{ 0 };
+		std::atomic<u64> live{ 0 };
+		std::atomic<u64> total{ 0 };
+		std::atomic<u64> regions{ 0 };
+		std::atomic<u64> budget{ 0 };
+	};
+
+	static const u32 TAG_COUNT = (u32)MemoryTag::Count;
+	static const u32 FRAME_HISTORY = 256;
+
+	static TagCounters tagCounters[TAG_COUNT];
+	static std::atomic<u64> trackedAllocations{ 0 };
+	static thread_local MemoryTag threadTag = MemoryTag::General;
+
+	//main thread only, EndFrame and DrawImGui
+	static bool overBudget[TAG_COUNT];
+	static u64 lastTrackedAllocations = 0;
+	static u64 frameAllocations = 0;
+	static f32 frameAllocationHistory[FRAME_HISTORY];
+	static u32 frameHistoryCount = 0;
+
+	static void AddBytes(TagCounters& counters, u64 bytes)
+	{
+		const u64 current = counters.current.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+		u64 peak = counters.peak.load(std::memory_order_relaxed);
+		while (current > peak && !counters.peak.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {}
+	}
+
+	static void Charge(MemoryTag tag, u64 bytes)
+	{
+		TagCounters& counters = tagCounters[(u32)tag];
+		AddBytes(counters, bytes);
+		counters.live.fetch_add(1, std::memory_order_relaxed);
+		counters.total.fetch_add(1, std::memory_order_relaxed);
+		trackedAllocations.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	static void Release(MemoryTag tag, u64 bytes)
+	{
+		TagCounters& counters = tagCounters[(u32)tag];
+		counters.current.fetch_sub(bytes, std::memory_order_relaxed);
+		counters.live.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	static void* TrackedAllocate(size_t size, size_t alignment, MemoryTag tag)
+	{
+		if (alignment < sizeof(AllocationHeader)) alignment = sizeof(AllocationHeader);
+		u8* raw = (u8*)malloc(size + alignment + sizeof(AllocationHeader));
+		if (!raw) return nullptr;
+
+		u8* memory = (u8*)Memory::alignUp((size_t)raw + sizeof(AllocationHeader), alignment);
+		AllocationHeader* header = (AllocationHeader*)memory - 1;
+		header->size = size;
+		header->offset = (u32)(memory - raw);
+		header->tag = (u8)tag;
+		Charge(tag, size);
+		return memory;
+	}
+
+	static void TrackedFree(void* memory)
+	{
+		if (!memory) return;
+		AllocationHeader* header = (AllocationHeader*)memory - 1;
+		Release((MemoryTag)header->tag, header->size);
+		free((u8*)memory - header->offset);
+	}
+}
+
+#ifdef WF_TRACK_HEAP
+static std::atomic<u64> heapAllocations{ 0 };
+static std::atomic<u64> heapBytes{ 0 };
+
+static void* HeapAllocate(size_t size, size_t alignment)
+{
+	heapAllocations.fetch_add(1, std::memory_order_relaxed);
+	heapBytes.fetch_add(size, std::memory_order_relaxed);
+	void* memory = Wolf::TrackedAllocate(size ? size : 1, alignment, Wolf::threadTag);
+	if (!memory) throw std::bad_alloc();
+	return memory;
+}
+
+void* operator new(size_t size) { return HeapAllocate(size, 16); }
+void* operator new[](size_t size) { return HeapAllocate(size, 16); }
+void* operator new(size_t size, std::align_val_t alignment) { return HeapAllocate(size, (size_t)alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return HeapAllocate(size, (size_t)alignment); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	try { return HeapAllocate(size, 16); }
+	catch (...) { return nullptr; }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	try { return HeapAllocate(size, 16); }
+	catch (...) { return nullptr; }
+}
+
+void operator delete(void* memory) noexcept { Wolf::TrackedFree(memory); }
+void operator delete[](void* memory) noexcept { Wolf::TrackedFree(memory); }
+void operator delete(void* memory, size_t) noexcept { Wolf::TrackedFree(memory); }
+void operator delete[](void* memory, size_t) noexcept { Wolf::TrackedFree(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { Wolf::TrackedFree(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { Wolf::TrackedFree(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept { Wolf::TrackedFree(memory); }
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept { Wolf::TrackedFree(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { Wolf::TrackedFree(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { Wolf::TrackedFree(memory); }
+#endif
+
+namespace Wolf
+{
+	namespace Memory
+	{
+	#ifdef WF_TRACK_HEAP
+		u64 GetHeapAllocationCount() { return heapAllocations.load(std::memory_order_relaxed); }
+		u64 GetHeapAllocatedBytes() { return heapBytes.load(std::memory_order_relaxed); }
+	#else
+		u64 GetHeapAllocationCount() { return 0; }
+		u64 GetHeapAllocatedBytes() { return 0; }
+	#endif
+
+		const char* GetTagName(MemoryTag tag)
+		{
+			static const char* names[TAG_COUNT] = { "General", "Textures", "Meshes", "Audio", "ImGui", "Ecs", "Jobs", "Profiler" };
+			return (u32)tag < TAG_COUNT ? names[(u32)tag] : "Unknown";
+		}
+
+		MemoryTag GetThreadTag() { return threadTag; }
+		void SetThreadTag(MemoryTag tag) { threadTag = tag; }
+
+		void* Allocate(size_t size, MemoryTag tag, size_t alignment) { return TrackedAllocate(size, alignment, tag); }
+		void Free(void* memory) { TrackedFree(memory); }
+
+		void Track(MemoryTag tag, u64 bytes)
+		{
+			TagCounters& counters = tagCounters[(u32)tag];
+			AddBytes(counters, bytes);
+			counters.regions.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		void Untrack(MemoryTag tag, u64 bytes)
+		{
+			TagCounters& counters = tagCounters[(u32)tag];
+			counters.current.fetch_sub(bytes, std::memory_order_relaxed);
+			counters.regions.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		void SetBudget(MemoryTag tag, u64 bytes)
+		{
+			tagCounters[(u32)tag].budget.store(bytes, std::memory_order_relaxed);
+		}
+
+		MemoryTagStats GetTagStats(MemoryTag tag)
+		{
+			const TagCounters& counters = tagCounters[(u32)tag];
+			return MemoryTagStats{
+				counters.current.load(std::memory_order_relaxed),
+				counters.peak.load(std::memory_order_relaxed),
+				counters.live.load(std::memory_order_relaxed),
+				counters.total.load(std::memory_order_relaxed),
+				counters.regions.load(std::memory_order_relaxed),
+				counters.budget.load(std::memory_order_relaxed) };
+		}
+
+		void EndFrame()
+		{
+			const u64 total = trackedAllocations.load(std::memory_order_relaxed);
+			frameAllocations = total - lastTrackedAllocations;
+			lastTrackedAllocations = total;
+			frameAllocationHistory[frameHistoryCount++ % FRAME_HISTORY] = (f32)frameAllocations;
+
+			for (u32 i = 0; i < TAG_COUNT; i++)
+			{
+				const u64 budget = tagCounters[i].budget.load(std::memory_order_relaxed);
+				const u64 current = tagCounters[i].current.load(std::memory_order_relaxed);
+				const bool over = budget && current > budget;
+				if (over && !overBudget[i])
+					WF_LOGWARNING("memory budget exceeded: %s uses %.2f MB of %.2f MB", GetTagName((MemoryTag)i), current / 1048576.0, budget / 1048576.0);
+				overBudget[i] = over;
+			}
+		}
+
+		u64 GetFrameAllocationCount()
+		{
+			return frameAllocations;
+		}
+
+		void DrawImGui(bool* open)
+		{
+			if (!ImGui::Begin("Memory", open))
+			{
+				ImGui::End();
+				return;
+			}
+
+			const u32 historyCount = frameHistoryCount < FRAME_HISTORY ? frameHistoryCount : FRAME_HISTORY;
+			ImGui::Text("allocations last frame: %llu", (unsigned long long)frameAllocations);
+			ImGui::PlotHistogram("##allocations", frameAllocationHistory, (int)historyCount,
+				historyCount < FRAME_HISTORY ? 0 : (int)(frameHistoryCount % FRAME_HISTORY), nullptr, 0.0f, FLT_MAX, ImVec2(0.0f, 50.0f));
+		#ifndef WF_TRACK_HEAP
+			ImGui::TextDisabled("heap tracking is off, only Memory::Allocate allocations and Memory::Track regions are counted");
+		#endif
+
+			ImGui::Columns(7, "memoryTags");
+			ImGui::Text("Tag"); ImGui::NextColumn();
+			ImGui::Text("Current MB"); ImGui::NextColumn();
+			ImGui::Text("Peak MB"); ImGui::NextColumn();
+			ImGui::Text("Budget MB"); ImGui::NextColumn();
+			ImGui::Text("Live"); ImGui::NextColumn();
+			ImGui::Text("Total"); ImGui::NextColumn();
+			ImGui::Text("Regions"); ImGui::NextColumn();
+			ImGui::Separator();
+			for (u32 i = 0; i < TAG_COUNT; i++)
+			{
+				const MemoryTagStats stats = GetTagStats((MemoryTag)i);
+				const bool over = stats.budgetBytes && stats.currentBytes > stats.budgetBytes;
+				if (over) ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.35f, 0.3f, 1.0f));
+				ImGui::Text("%s", GetTagName((MemoryTag)i)); ImGui::NextColumn();
+				ImGui::Text("%.2f", stats.currentBytes / 1048576.0); ImGui::NextColumn();
+				ImGui::Text("%.2f", stats.peakBytes / 1048576.0); ImGui::NextColumn();
+				if (stats.budgetBytes)
+				{
+					ImGui::ProgressBar((f32)stats.currentBytes / stats.budgetBytes, ImVec2(-1.0f, 0.0f));
+					if (ImGui::IsItemHovered()) ImGui::SetTooltip("%.2f MB", stats.budgetBytes / 1048576.0);
+				}
+				else
+					ImGui::TextDisabled("-");
+				ImGui::NextColumn();
+				ImGui::Text("%llu", (unsigned long long)stats.liveAllocations); ImGui::NextColumn();
+				ImGui::Text("%llu", (unsigned long long)stats.totalAllocations); ImGui::NextColumn();
+				ImGui::Text("%llu", (unsigned long long)stats.trackedRegions); ImGui::NextColumn();
+				if (over) ImGui::PopStyleColor();
+			}
+			ImGui::Columns(1);
+			ImGui::End();
+		}
+	}
+
+	LinearArena::LinearArena(size_t a_capacity)
+		: capacity(a_capacity)
+	{
+		memory = (u8*)::operator new(capacity, std::align_val_t(64));
+	}
+
+	LinearArena::~LinearArena()
+	{
+		::operator delete(memory, std::align_val_t(64));
+	}
+
+	void* LinearArena::Allocate(size_t size, size_t alignment)
+	{
+		const size_t start = Memory::alignUp(offset, alignment);
+		if (start + size > capacity)
+		{
+			WF_LOGERROR("LinearArena out of memory: %zu bytes requested, %zu of %zu used", size, offset, capacity);
+			return nullptr;
+		}
+		offset = start + size;
+		if (offset > highWater) highWater = offset;
+		return memory + start;
+	}
+
+	FrameAllocator::FrameAllocator(size_t capacityPerFrame)
+		: capacity(capacityPerFrame)
+	{
+		for (u32 i = 0; i < 2; i++)
+		{
+			memory[i] = (u8*)::operator new(capacity, std::align_val_t(64));
+			offsets[i].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	FrameAllocator::~FrameAllocator()
+	{
+		for (u32 i = 0; i < 2; i++)
+			::operator delete(memory[i], std::align_val_t(64));
+	}
+
+	void FrameAllocator::BeginFrame()
+	{
+		const size_t used = offsets[current].load(std::memory_order_relaxed);
+		if (used > highWater) highWater = used;
+		current ^= 1;
+		offsets[current].store(0, std::memory_order_relaxed);
+	}
+
+	void* FrameAllocator::Allocate(size_t size, size_t alignment)
+	{
+		//over-reserve by the alignment so the bump is a single fetch_add
+		const size_t reserved = size + alignment - 1;
+		const size_t offset = offsets[current].fetch_add(reserved, std::memory_order_relaxed);
+		if (offset + reserved > capacity)
+		{
+			WF_LOGERROR("FrameAllocator out of memory: %zu bytes requested, capacity %zu", size, capacity);
+			return nullptr;
+		}
+		//blocks are 64 byte aligned so aligning the offset aligns the pointer
+		return memory[current] + Memory::alignUp(offset, alignment);
+	}
+
+	LinearArena& ScratchScope::GetThreadArena()
+	{
+		static thread_local LinearArena arena(THREAD_CAPACITY);
+		return arena;
+	}
+}
@@ -0,0 +1,268 @@
+#ifndef WF_MEMORY_H
+#define WF_MEMORY_H
+#include "wf_pch.h"
+#include "wf_debug.h"
+#include <atomic>
+#include <new>
+#include <utility>
+
+//Debug builds replace the global operator new/delete with tracking versions so Application
+//can report heap allocations that happen after the first frames and every allocation is
+//charged to a MemoryTag. Define WF_TRACK_HEAP to get the same in release builds.
+#if defined(WF_DEBUG) && !defined(WF_TRACK_HEAP)
+	#define WF_TRACK_HEAP 1
+#endif
+
+namespace Wolf
+{
+	namespace Memory
+	{
+		inline size_t alignUp(size_t value, size_t alignment)
+		{
+			return (value + alignment - 1) & ~(alignment - 1);
+		}
+
+		//only counted with WF_TRACK_HEAP, 0 otherwise
+		u64 GetHeapAllocationCount();
+		u64 GetHeapAllocatedBytes();
+	}
+
+	//Subsystem an allocation is charged to. Heap allocations (with WF_TRACK_HEAP) go to the
+	//calling thread's tag, set with MemoryTagScope. Memory outside the heap (GPU resources,
+	//mapped files) is reported with Memory::Track / Memory::Untrack.
+	enum class MemoryTag : u8
+	{
+		General,
+		Textures,
+		Meshes,
+		Audio,
+		ImGui,
+		Ecs,
+		Jobs,
+		Profiler,
+		Count
+	};
+
+	struct MemoryTagStats
+	{
+		u64 currentBytes;
+		u64 peakBytes;
+		//Memory::Allocate and heap allocations
+		u64 liveAllocations;
+		u64 totalAllocations;
+		//live Memory::Track regions, they are bytes but not allocations
+		u64 trackedRegions;
+		//0 when no budget is set
+		u64 budgetBytes;
+	};
+
+	namespace Memory
+	{
+		const char* GetTagName(MemoryTag tag);
+
+		MemoryTag GetThreadTag();
+		void SetThreadTag(MemoryTag tag);
+
+		//tracked regardless of WF_TRACK_HEAP, free with Memory::Free (ImGui::SetAllocatorFunctions...)
+		void* Allocate(size_t size, MemoryTag tag, size_t alignment = 16);
+		void Free(void* memory);
+
+		//memory that doesn't come from the heap, counted in the tag's bytes and regions only
+		void Track(MemoryTag tag, u64 bytes);
+		void Untrack(MemoryTag tag, u64 bytes);
+
+		//EndFrame logs a warning when a tag goes over its budget (once until it drops below again)
+		void SetBudget(MemoryTag tag, u64 bytes);
+		MemoryTagStats GetTagStats(MemoryTag tag);
+
+		//closes the frame for the per frame counters and checks the budgets, called by Application::Run
+		void EndFrame();
+		//tracked allocations during the last frame (heap ones only with WF_TRACK_HEAP)
+		u64 GetFrameAllocationCount();
+
+		//call between ImGui::NewFrame and ImGui::Render
+		void DrawImGui(bool* open = nullptr);
+	}
+
+	//charges the heap allocations of this thread to tag until the end of the scope
+	class MemoryTagScope
+	{
+	public:
+		explicit MemoryTagScope(MemoryTag tag) : previous(Memory::GetThreadTag()) { Memory::SetThreadTag(tag); }
+		~MemoryTagScope() { Memory::SetThreadTag(previous); }
+		MemoryTagScope(const MemoryTagScope&) = delete;
+		MemoryTagScope& operator=(const MemoryTagScope&) = delete;
+
+	private:
+		MemoryTag previous;
+	};
+
+	//Bump allocator over one block allocated up front. Allocations are freed all at once
+	//with Reset or back to a marker, destructors are never called so keep it to trivially
+	//destructible data. Alignments up to 64. Not thread safe, see FrameAllocator for the shared one.
+	class LinearArena
+	{
+	public:
+		explicit LinearArena(size_t a_capacity);
+		~LinearArena();
+		LinearArena(const LinearArena&) = delete;
+		LinearArena& operator=(const LinearArena&) = delete;
+
+		//nullptr when the arena is full (logged)
+		void* Allocate(size_t size, size_t alignment = 16);
+
+		template<typename T>
+		T* Allocate(u32 count = 1) { return (T*)Allocate(sizeof(T) * count, alignof(T)); }
+
+		template<typename T, typename... Args>
+		T* New(Args&&... args)
+		{
+			void* memory = Allocate(sizeof(T), alignof(T));
+			return memory ? new (memory) T(std::forward<Args>(args)...) : nullptr;
+		}
+
+		void Reset() { offset = 0; }
+		size_t GetMarker() const { return offset; }
+		void ResetToMarker(size_t marker) { offset = marker; }
+
+		size_t GetUsed() const { return offset; }
+		size_t GetCapacity() const { return capacity; }
+		size_t GetHighWater() const { return highWater; }
+
+	private:
+		u8* memory;
+		size_t capacity;
+		size_t offset = 0;
+		size_t highWater = 0;
+	};
+
+	//Two arenas swapped by BeginFrame. Memory allocated during frame N stays valid during
+	//frame N + 1, so data handed from one frame to the next (render lists, readbacks) needs no copy.
+	//Allocate is lock free and can be called from jobs.
+	class FrameAllocator
+	{
+	public:
+		explicit FrameAllocator(size_t capacityPerFrame);
+		~FrameAllocator();
+		FrameAllocator(const FrameAllocator&) = delete;
+		FrameAllocator& operator=(const FrameAllocator&) = delete;
+
+		//resets the arena of frame N - 1 and makes it current
+		void BeginFrame();
+
+		void* Allocate(size_t size, size_t alignment = 16);
+
+		template<typename T>
+		T* Allocate(u32 count = 1) { return (T*)Allocate(sizeof(T) * count, alignof(T)); }
+
+		template<typename T, typename... Args>
+		T* New(Args&&... args)
+		{
+			void* memory = Allocate(sizeof(T), alignof(T));
+			return memory ? new (memory) T(std::forward<Args>(args)...) : nullptr;
+		}
+
+		size_t GetUsed() const { return offsets[current].load(std::memory_order_relaxed); }
+		size_t GetCapacity() const { return capacity; }
+		size_t GetHighWater() const { return highWater; }
+
+	private:
+		u8* memory[2];
+		std::atomic<size_t> offsets[2];
+		size_t capacity;
+		size_t highWater = 0;
+		u32 current = 0;
+	};
+
+	//Temporary memory for the current scope on this thread, released when the scope ends.
+	//Every thread gets its own arena on first use, scopes nest like a stack.
+	class ScratchScope
+	{
+	public:
+		static const size_t THREAD_CAPACITY = 1024 * 1024;
+
+		ScratchScope() : arena(GetThreadArena()), marker(arena.GetMarker()) {}
+		~ScratchScope() { arena.ResetToMarker(marker); }
+		ScratchScope(const ScratchScope&) = delete;
+		ScratchScope& operator=(const ScratchScope&) = delete;
+
+		void* Allocate(size_t size, size_t alignment = 16) { return arena.Allocate(size, alignment); }
+
+		template<typename T>
+		T* Allocate(u32 count = 1) { return arena.Allocate<T>(count); }
+
+		static LinearArena& GetThreadArena();
+
+	private:
+		LinearArena& arena;
+		size_t marker;
+	};
+
+	//Fixed capacity pool of T with an intrusive free list, Create/Destroy are O(1) and
+	//never touch the heap after construction. Not thread safe.
+	template<typename T>
+	class Pool
+	{
+	public:
+		explicit Pool(u32 a_capacity)
+			: capacity(a_capacity)
+		{
+			slots = (Slot*)::operator new(sizeof(Slot) * capacity, std::align_val_t(alignof(Slot)));
+			for (u32 i = 0; i < capacity; i++)
+				slots[i].next = i + 1 < capacity ? &slots[i + 1] : nullptr;
+			freeList = capacity ? &slots[0] : nullptr;
+		}
+
+		~Pool()
+		{
+			if (count) WF_LOGERROR("Pool destroyed with %u live objects, their destructors won't run", count);
+			::operator delete(slots, std::align_val_t(alignof(Slot)));
+		}
+
+		Pool(const Pool&) = delete;
+		Pool& operator=(const Pool&) = delete;
+
+		//nullptr when the pool is full (logged)
+		template<typename... Args>
+		T* Create(Args&&... args)
+		{
+			if (!freeList)
+			{
+				WF_LOGERROR("Pool of %u objects of %u bytes is full", capacity, (u32)sizeof(T));
+				return nullptr;
+			}
+			Slot* slot = freeList;
+			freeList = slot->next;
+			count++;
+			return new (slot->storage) T(std::forward<Args>(args)...);
+		}
+
+		void Destroy(T* object)
+		{
+			if (!object) return;
+			object->~T();
+			Slot* slot = (Slot*)object;
+			slot->next = freeList;
+			freeList = slot;
+			count--;
+		}
+
+		bool Owns(const T* object) const { return (const Slot*)object >= slots && (const Slot*)object < slots + capacity; }
+		u32 GetCount() const { return count; }
+		u32 GetCapacity() const { return capacity; }
+
+	private:
+		union Slot
+		{
+			Slot* next;
+			alignas(T) u8 storage[sizeof(T)];
+		};
+
+		Slot* slots;
+		Slot* freeList;
+		u32 capacity;
+		u32 count = 0;
+	};
+}
+
+#endif //WF_MEMORY_H
@@ -0,0 +1,155 @@
+#include "wf_pch.h"
+#include "wf_mesh.h"
+#include "wf_debug.h"
+#include "wf_memory.h"
+
+namespace Wolf
+{
+	static void* LoadCookedMesh(AssetLoadContext& context, const char* path)
+	{
+		FileView view;
+		if (!context.OpenFile(path, view))
+		{
+			WF_LOGERROR("CookedMesh: can't open %s", path);
+			return nullptr;
+		}
+		CookedMesh* mesh = new CookedMesh();
+		if (!mesh->Open(std::move(view), path))
+		{
+			delete mesh;
+			return nullptr;
+		}
+		return mesh;
+	}
+
+	static void UnloadCookedMesh(void* data)
+	{
+		delete (CookedMesh*)data;
+	}
+
+	const AssetType CookedMesh::ASSET_TYPE = { "mesh", LoadCookedMesh, UnloadCookedMesh, nullptr };
+
+	bool CookedMesh::Open(const char* path)
+	{
+		FileView view;
+		if (!view.Open(path))
+		{
+			WF_LOGERROR("CookedMesh: can't map %s", path);
+			return false;
+		}
+		return Open(std::move(view), path);
+	}
+
+	bool CookedMesh::Open(FileView&& view, const char* name)
+	{
+		Close();
+		file = std::move(view);
+		if (!ValidateMeshFile(file.GetData(), file.GetSize()))
+		{
+			WF_LOGERROR("CookedMesh: %s isn't a valid version %u mesh, cook it again", name, MESH_FILE_VERSION);
+			file.Close();
+			return false;
+		}
+		header = (const MeshFileHeader*)file.GetData();
+		submeshes = (const MeshSubmesh*)(file.GetData() + header->submeshOffset);
+		Memory::Track(MemoryTag::Meshes, file.GetSize());
+		return true;
+	}
+
+	void CookedMesh::Close()
+	{
+		if (!header) return;
+		Memory::Untrack(MemoryTag::Meshes, file.GetSize());
+		header = nullptr;
+		submeshes = nullptr;
+		file.Close();
+	}
+
+	const MeshAttributeDesc* CookedMesh::FindAttribute(MeshAttribute attribute) const
+	{
+		for (u32 i = 0; i < header->attributeCount; i++)
+		{
+			if (header->attributes[i].attribute == attribute) return &header->attributes[i];
+		}
+		return nullptr;
+	}
+
+	AABB CookedMesh::GetBounds() const
+	{
+		return AABB(Vec3(header->boundsMin[0], header->boundsMin[1], header->boundsMin[2]),
+			Vec3(header->boundsMax[0], header->boundsMax[1], header->boundsMax[2]));
+	}
+
+	struct GLVertexFormat
+	{
+		GLint components;
+		GLenum type;
+		GLboolean normalized;
+	};
+
+	static GLVertexFormat GetGLVertexFormat(VertexFormat format)
+	{
+		switch (format)
+		{
+		case VertexFormat::Float32x2: return { 2, GL_FLOAT, GL_FALSE };
+		case VertexFormat::Float32x3: return { 3, GL_FLOAT, GL_FALSE };
+		case VertexFormat::Float32x4: return { 4, GL_FLOAT, GL_FALSE };
+		case VertexFormat::Half16x2: return { 2, GL_HALF_FLOAT, GL_FALSE };
+		case VertexFormat::Snorm16x2: return { 2, GL_SHORT, GL_TRUE };
+		case VertexFormat::Snorm16x4: return { 4, GL_SHORT, GL_TRUE };
+		case VertexFormat::Snorm10x3_2: return { 4, GL_INT_2_10_10_10_REV, GL_TRUE };
+		case VertexFormat::Unorm8x4: return { 4, GL_UNSIGNED_BYTE, GL_TRUE };
+		default: return { 0, 0, GL_FALSE };
+		}
+	}
+
+	bool CookedMesh::CreateGLMesh(GLMesh& mesh) const
+	{
+		if (!header) return false;
+
+		glGenVertexArrays(1, &mesh.vertexArray);
+		glBindVertexArray(mesh.vertexArray);
+		glGenBuffers((GLsizei)header->streamCount, mesh.vertexBuffers);
+		for (u32 stream = 0; stream < header->streamCount; stream++)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, mesh.vertexBuffers[stream]);
+			glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)header->streams[stream].size, GetStreamData(stream), GL_STATIC_DRAW);
+		}
+		for (u32 i = 0; i < header->attributeCount; i++)
+		{
+			const MeshAttributeDesc& attribute = header->attributes[i];
+			const GLVertexFormat format = GetGLVertexFormat(attribute.format);
+			const GLuint location = (GLuint)attribute.attribute;
+			glBindBuffer(GL_ARRAY_BUFFER, mesh.vertexBuffers[attribute.stream]);
+			glEnableVertexAttribArray(location);
+			glVertexAttribPointer(location, format.components, format.type, format.normalized,
+				(GLsizei)header->streams[attribute.stream].stride, (const void*)(uintptr_t)attribute.offset);
+		}
+
+		//the element buffer binding is part of the vertex array
+		glGenBuffers(1, &mesh.indexBuffer);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBuffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)((u64)header->indexCount * header->indexSize), GetIndexData(), GL_STATIC_DRAW);
+		mesh.indexType = header->indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		return true;
+	}
+
+	void CookedMesh::DestroyGLMesh(GLMesh& mesh)
+	{
+		if (mesh.vertexArray) glDeleteVertexArrays(1, &mesh.vertexArray);
+		glDeleteBuffers(MESH_MAX_STREAMS, mesh.vertexBuffers);
+		if (mesh.indexBuffer) glDeleteBuffers(1, &mesh.indexBuffer);
+		mesh = GLMesh();
+	}
+
+	void CookedMesh::DrawSubmesh(const GLMesh& mesh, u32 submesh) const
+	{
+		const MeshSubmesh& desc = submeshes[submesh];
+		if (desc.indexCount == 0) return;
+		glDrawRangeElements(GL_TRIANGLES, desc.firstVertex, desc.firstVertex + desc.vertexCount - 1, (GLsizei)desc.indexCount,
+			mesh.indexType, (const void*)(uintptr_t)((u64)desc.firstIndex * header->indexSize));
+	}
+}
@@ -0,0 +1,68 @@
+#ifndef WF_MESH_H
+#define WF_MESH_H
+#include "wf_pch.h"
+#include "wf_mesh_format.h"
+#include "wf_culling.h"
+#include "wf_vfs.h"
+#include "wf_assets.h"
+
+namespace Wolf
+{
+	//GL objects of a CookedMesh, the vertex array has every attribute set up at its MeshAttribute location
+	struct GLMesh
+	{
+		GLuint vertexArray = 0;
+		GLuint vertexBuffers[MESH_MAX_STREAMS] = {};
+		GLuint indexBuffer = 0;
+		GLenum indexType = 0;
+	};
+
+	//A mesh cooked by MeshCooker, used straight from the memory mapped file or pack: opening only
+	//checks the header, vertex and index data are uploaded from the mapping as they are.
+	class CookedMesh
+	{
+	public:
+		//loads .wmesh files through an AssetRegistry, the data is a CookedMesh
+		static const AssetType ASSET_TYPE;
+
+		CookedMesh() = default;
+		~CookedMesh() { Close(); }
+
+		CookedMesh(const CookedMesh&) = delete;
+		CookedMesh& operator=(const CookedMesh&) = delete;
+
+		bool Open(const char* path);
+		//takes the view over, name is for errors
+		bool Open(FileView&& view, const char* name);
+		void Close();
+		bool IsOpen() const { return header != nullptr; }
+
+		u32 GetVertexCount() const { return header->vertexCount; }
+		u32 GetIndexCount() const { return header->indexCount; }
+		u32 GetIndexSize() const { return header->indexSize; }
+		const void* GetIndexData() const { return file.GetData() + header->indexOffset; }
+		u32 GetStreamCount() const { return header->streamCount; }
+		const MeshStreamDesc& GetStream(u32 stream) const { return header->streams[stream]; }
+		const u8* GetStreamData(u32 stream) const { return file.GetData() + header->streams[stream].offset; }
+		u32 GetAttributeCount() const { return header->attributeCount; }
+		const MeshAttributeDesc& GetAttribute(u32 attribute) const { return header->attributes[attribute]; }
+		//nullptr if the mesh doesn't have it
+		const MeshAttributeDesc* FindAttribute(MeshAttribute attribute) const;
+		u32 GetSubmeshCount() const { return header->submeshCount; }
+		const MeshSubmesh& GetSubmesh(u32 submesh) const { return submeshes[submesh]; }
+		AABB GetBounds() const;
+
+		//needs a current context
+		bool CreateGLMesh(GLMesh& mesh) const;
+		static void DestroyGLMesh(GLMesh& mesh);
+		//with the mesh's vertex array bound
+		void DrawSubmesh(const GLMesh& mesh, u32 submesh) const;
+
+	private:
+		FileView file;
+		const MeshFileHeader* header = nullptr;
+		const MeshSubmesh* submeshes = nullptr;
+	};
+}
+
+#endif //WF_MESH_H
@@ -0,0 +1,174 @@
+#ifndef WF_MESH_FORMAT_H
+#define WF_MESH_FORMAT_H
+#include "wf_pch.h"
+
+//Cooked mesh container, written by MeshCooker and used in place by CookedMesh. A MeshFileHeader,
+//the MeshSubmesh table, the vertex streams, then the index buffer, each one starting on a
+//MESH_DATA_ALIGNMENT boundary. One vertex and one index buffer shared by every submesh, indices
+//are absolute. Little endian.
+namespace Wolf
+{
+	static const u32 MESH_FILE_MAGIC = 0x534D4657; //"WFMS"
+	static const u32 MESH_FILE_VERSION = 2;
+	static const u32 MESH_MAX_STREAMS = 4;
+	static const u32 MESH_MAX_ATTRIBUTES = 8;
+	static const u32 MESH_MAX_NAME = 48;
+	//uploads straight from the mapping, streams start on a cache line
+	static const u32 MESH_DATA_ALIGNMENT = 64;
+
+	//also the shader attribute location
+	enum class MeshAttribute : u32
+	{
+		Position = 0,
+		Normal = 1,
+		Tangent = 2,
+		TexCoord = 3,
+		Color = 4,
+		Count
+	};
+
+	//the packed formats are the ones of wf_packing.h, the shader decodes them
+	enum class VertexFormat : u32
+	{
+		Float32x2 = 0,
+		Float32x3 = 1,
+		Float32x4 = 2,
+		Half16x2 = 3,
+		//OctNormal
+		Snorm16x2 = 4,
+		//PackedPosition relative to the mesh bounds, w is 0
+		Snorm16x4 = 5,
+		//packed tangent, handedness in w
+		Snorm10x3_2 = 6,
+		Unorm8x4 = 7,
+		Count
+	};
+
+	//MeshCooker options that change the index or vertex order but not the layout,
+	//a different set cooks the mesh again
+	enum MeshCookFlags : u32
+	{
+		MESH_COOK_TIPSIFY = 1 << 0,
+		MESH_COOK_OVERDRAW = 1 << 1,
+		//source order, none of the others apply
+		MESH_COOK_RAW = 1 << 2,
+	};
+
+	struct MeshStreamDesc
+	{
+		//from the start of the file
+		u64 offset;
+		u64 size;
+		u32 stride;
+		u32 reserved;
+	};
+
+	struct MeshAttributeDesc
+	{
+		MeshAttribute attribute;
+		VertexFormat format;
+		u32 stream;
+		//inside the vertex of the stream
+		u32 offset;
+	};
+
+	struct MeshSubmesh
+	{
+		u32 firstIndex;
+		u32 indexCount;
+		//the vertices its indices use, for glDrawRangeElements
+		u32 firstVertex;
+		u32 vertexCount;
+		f32 boundsMin[3];
+		f32 boundsMax[3];
+		//material, null terminated
+		char name[MESH_MAX_NAME];
+	};
+
+	struct MeshFileHeader
+	{
+		u32 magic;
+		u32 version;
+		u32 vertexCount;
+		u32 indexCount;
+		//2 or 4 bytes
+		u32 indexSize;
+		u32 streamCount;
+		u32 attributeCount;
+		u32 submeshCount;
+		//MeshCookFlags
+		u32 cookFlags;
+		u32 reserved;
+		f32 boundsMin[3];
+		f32 boundsMax[3];
+		u64 submeshOffset;
+		u64 indexOffset;
+		u64 fileSize;
+		MeshStreamDesc streams[MESH_MAX_STREAMS];
+		MeshAttributeDesc attributes[MESH_MAX_ATTRIBUTES];
+	};
+	static_assert(sizeof(MeshStreamDesc) == 24, "MeshStreamDesc is part of the file format");
+	static_assert(sizeof(MeshAttributeDesc) == 16, "MeshAttributeDesc is part of the file format");
+	static_assert(sizeof(MeshSubmesh) == 88, "MeshSubmesh is part of the file format");
+	static_assert(sizeof(MeshFileHeader) == 312, "MeshFileHeader is part of the file format");
+
+	inline u32 GetVertexFormatSize(VertexFormat format)
+	{
+		switch (format)
+		{
+		case VertexFormat::Float32x2: return 8;
+		case VertexFormat::Float32x3: return 12;
+		case VertexFormat::Float32x4: return 16;
+		case VertexFormat::Half16x2: return 4;
+		case VertexFormat::Snorm16x2: return 4;
+		case VertexFormat::Snorm16x4: return 8;
+		case VertexFormat::Snorm10x3_2: return 4;
+		case VertexFormat::Unorm8x4: return 4;
+		default: return 0;
+		}
+	}
+
+	//everything the runtime relies on, so a truncated or stale file is rejected instead of read out
+	//of bounds. Index values aren't checked, that would page in the whole index buffer
+	inline bool ValidateMeshFile(const void* data, u64 size)
+	{
+		if (size < sizeof(MeshFileHeader) || ((uintptr_t)data & 7)) return false;
+		const MeshFileHeader& header = *(const MeshFileHeader*)data;
+		if (header.magic != MESH_FILE_MAGIC || header.version != MESH_FILE_VERSION || header.fileSize != size) return false;
+		if (header.indexSize != 2 && header.indexSize != 4) return false;
+		if (header.indexSize == 2 && header.vertexCount > 65536) return false;
+		if (header.streamCount == 0 || header.streamCount > MESH_MAX_STREAMS) return false;
+		if (header.attributeCount == 0 || header.attributeCount > MESH_MAX_ATTRIBUTES) return false;
+
+		for (u32 i = 0; i < header.streamCount; i++)
+		{
+			const MeshStreamDesc& stream = header.streams[i];
+			if (stream.stride == 0 || stream.size != (u64)stream.stride * header.vertexCount) return false;
+			if (stream.offset % MESH_DATA_ALIGNMENT || stream.offset > size || stream.size > size - stream.offset) return false;
+		}
+		for (u32 i = 0; i < header.attributeCount; i++)
+		{
+			const MeshAttributeDesc& attribute = header.attributes[i];
+			if (attribute.attribute >= MeshAttribute::Count || attribute.format >= VertexFormat::Count) return false;
+			if (attribute.stream >= header.streamCount) return false;
+			if (attribute.offset + GetVertexFormatSize(attribute.format) > header.streams[attribute.stream].stride) return false;
+		}
+
+		const u64 indexBytes = (u64)header.indexCount * header.indexSize;
+		if (header.indexOffset % MESH_DATA_ALIGNMENT || header.indexOffset > size || indexBytes > size - header.indexOffset) return false;
+
+		const u64 submeshBytes = (u64)header.submeshCount * sizeof(MeshSubmesh);
+		if (header.submeshOffset % 8 || header.submeshOffset > size || submeshBytes > size - header.submeshOffset) return false;
+		const MeshSubmesh* submeshes = (const MeshSubmesh*)((const u8*)data + header.submeshOffset);
+		for (u32 i = 0; i < header.submeshCount; i++)
+		{
+			const MeshSubmesh& submesh = submeshes[i];
+			if (submesh.firstIndex > header.indexCount || submesh.indexCount > header.indexCount - submesh.firstIndex) return false;
+			if (submesh.firstVertex > header.vertexCount || submesh.vertexCount > header.vertexCount - submesh.firstVertex) return false;
+			if (submesh.name[MESH_MAX_NAME - 1] != '\0') return false;
+		}
+		return true;
+	}
+}
+
+#endif //WF_MESH_FORMAT_H
@@ -0,0 +1,414 @@
+#include "wf_pch.h"
+#include "wf_mesh_optimizer.h"
+#include <algorithm>
+#include <vector>
+
+namespace Wolf
+{
+	//triangles of every vertex, the first counts[v] of a vertex's list are the ones not emitted yet
+	struct TriangleAdjacency
+	{
+		std::vector<u32> offsets;
+		std::vector<u32> counts;
+		std::vector<u32> triangles;
+	};
+
+	static void BuildAdjacency(TriangleAdjacency& adjacency, const u32* indices, u32 indexCount, u32 vertexCount)
+	{
+		adjacency.counts.assign(vertexCount, 0);
+		for (u32 i = 0; i < indexCount; i++)
+			adjacency.counts[indices[i]]++;
+
+		adjacency.offsets.resize((size_t)vertexCount + 1);
+		adjacency.offsets[0] = 0;
+		for (u32 v = 0; v < vertexCount; v++)
+			adjacency.offsets[v + 1] = adjacency.offsets[v] + adjacency.counts[v];
+
+		std::vector<u32> fill(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+		adjacency.triangles.resize(indexCount);
+		for (u32 i = 0; i < indexCount; i++)
+			adjacency.triangles[fill[indices[i]]++] = i / 3;
+	}
+
+	static void RemoveTriangle(TriangleAdjacency& adjacency, u32 vertex, u32 triangle)
+	{
+		u32* list = &adjacency.triangles[adjacency.offsets[vertex]];
+		const u32 count = adjacency.counts[vertex];
+		for (u32 i = 0; i < count; i++)
+		{
+			if (list[i] == triangle)
+			{
+				list[i] = list[count - 1];
+				list[count - 1] = triangle;
+				adjacency.counts[vertex]--;
+				return;
+			}
+		}
+	}
+
+	static u64 HashVertex(const u8* vertex, u32 size)
+	{
+		u64 hash = 0xCBF29CE484222325ull;
+		for (u32 i = 0; i < size; i++)
+			hash = (hash ^ vertex[i]) * 0x100000001B3ull;
+		return hash;
+	}
+
+	u32 WeldVertices(u32* remap, const void* vertices, u32 vertexCount, u32 vertexSize)
+	{
+		const u8* bytes = (const u8*)vertices;
+		//open addressing, at most half full
+		u32 tableSize = 16;
+		while (tableSize < vertexCount * 2)
+			tableSize *= 2;
+		std::vector<u32> table(tableSize, ~0u);
+
+		u32 unique = 0;
+		for (u32 i = 0; i < vertexCount; i++)
+		{
+			const u8* vertex = bytes + (size_t)i * vertexSize;
+			for (u32 slot = (u32)HashVertex(vertex, vertexSize) & (tableSize - 1);; slot = (slot + 1) & (tableSize - 1))
+			{
+				const u32 other = table[slot];
+				if (other == ~0u)
+				{
+					table[slot] = i;
+					remap[i] = unique++;
+					break;
+				}
+				if (!memcmp(bytes + (size_t)other * vertexSize, vertex, vertexSize))
+				{
+					remap[i] = remap[other];
+					break;
+				}
+			}
+		}
+		return unique;
+	}
+
+	void RemapVertices(void* destination, const void* vertices, u32 vertexCount, u32 vertexSize, const u32* remap)
+	{
+		for (u32 i = 0; i < vertexCount; i++)
+		{
+			if (remap[i] != ~0u) memcpy((u8*)destination + (size_t)remap[i] * vertexSize, (const u8*)vertices + (size_t)i * vertexSize, vertexSize);
+		}
+	}
+
+	void RemapIndices(u32* destination, const u32* indices, u32 indexCount, const u32* remap)
+	{
+		for (u32 i = 0; i < indexCount; i++)
+			destination[i] = remap[indices[i]];
+	}
+
+	//the scores of Forsyth's article: the last triangle's vertices a bit under the rest of the
+	//cache so strips don't turn back, and a boost for vertices with few triangles left so they
+	//get finished instead of leaving lone triangles behind
+	static const u32 FORSYTH_CACHE_SIZE = 32;
+	static const u32 FORSYTH_MAX_VALENCE = 32;
+
+	struct ForsythScores
+	{
+		//by cache position + 1, 0 is out of the cache
+		f32 cache[FORSYTH_CACHE_SIZE + 1];
+		f32 valence[FORSYTH_MAX_VALENCE + 1];
+
+		ForsythScores()
+		{
+			cache[0] = 0.0f;
+			for (u32 i = 0; i < FORSYTH_CACHE_SIZE; i++)
+				cache[i + 1] = i < 3 ? 0.75f : powf(1.0f - (f32)(i - 3) / (f32)(FORSYTH_CACHE_SIZE - 3), 1.5f);
+			valence[0] = 0.0f;
+			for (u32 i = 1; i <= FORSYTH_MAX_VALENCE; i++)
+				valence[i] = 2.0f / sqrtf((f32)i);
+		}
+
+		f32 Score(s32 cachePosition, u32 liveTriangles) const
+		{
+			if (liveTriangles == 0) return -1.0f;
+			return cache[cachePosition + 1] + valence[liveTriangles < FORSYTH_MAX_VALENCE ? liveTriangles : FORSYTH_MAX_VALENCE];
+		}
+	};
+
+	void OptimizeVertexCache(u32* destination, const u32* indices, u32 indexCount, u32 vertexCount)
+	{
+		static const ForsythScores scores;
+		const u32 triangleCount = indexCount / 3;
+		const std::vector<u32> source(indices, indices + (size_t)triangleCount * 3);
+		TriangleAdjacency adjacency;
+		BuildAdjacency(adjacency, source.data(), triangleCount * 3, vertexCount);
+
+		std::vector<s32> cachePositions(vertexCount, -1);
+		std::vector<f32> vertexScores(vertexCount);
+		for (u32 v = 0; v < vertexCount; v++)
+			vertexScores[v] = scores.Score(-1, adjacency.counts[v]);
+		std::vector<u8> emitted(triangleCount, 0);
+
+		//the new cache is built in the upper half, the 3 extra slots take what falls out
+		u32 cache[(FORSYTH_CACHE_SIZE + 3) * 2];
+		u32 cacheCount = 0;
+		u32 best = ~0u;
+		u32 cursor = 0;
+		for (u32 output = 0; output < triangleCount; output++)
+		{
+			//no cached vertex has triangles left, continue with the first triangle not drawn
+			if (best == ~0u)
+			{
+				while (emitted[cursor])
+					cursor++;
+				best = cursor;
+			}
+
+			const u32* triangle = &source[(size_t)best * 3];
+			memcpy(destination + (size_t)output * 3, triangle, 3 * sizeof(u32));
+			emitted[best] = 1;
+			for (u32 corner = 0; corner < 3; corner++)
+				RemoveTriangle(adjacency, triangle[corner], best);
+
+			u32* newCache = cache + FORSYTH_CACHE_SIZE + 3;
+			u32 newCount = 0;
+			//degenerate triangles put a vertex in once
+			for (u32 corner = 0; corner < 3; corner++)
+			{
+				if (std::find(newCache, newCache + newCount, triangle[corner]) == newCache + newCount) newCache[newCount++] = triangle[corner];
+			}
+			for (u32 i = 0; i < cacheCount; i++)
+			{
+				const u32 v = cache[i];
+				if (v != triangle[0] && v != triangle[1] && v != triangle[2]) newCache[newCount++] = v;
+			}
+			for (u32 i = 0; i < newCount; i++)
+			{
+				const u32 v = newCache[i];
+				cachePositions[v] = i < FORSYTH_CACHE_SIZE ? (s32)i : -1;
+				vertexScores[v] = scores.Score(cachePositions[v], adjacency.counts[v]);
+			}
+
+			//only the triangles of cached vertices changed score
+			best = ~0u;
+			f32 bestScore = -1.0f;
+			for (u32 i = 0; i < newCount; i++)
+			{
+				const u32 v = newCache[i];
+				const u32* triangles = &adjacency.triangles[adjacency.offsets[v]];
+				for (u32 k = 0; k < adjacency.counts[v]; k++)
+				{
+					const u32* other = &source[(size_t)triangles[k] * 3];
+					const f32 score = vertexScores[other[0]] + vertexScores[other[1]] + vertexScores[other[2]];
+					if (score > bestScore)
+					{
+						bestScore = score;
+						best = triangles[k];
+					}
+				}
+			}
+
+			cacheCount = newCount < FORSYTH_CACHE_SIZE ? newCount : FORSYTH_CACHE_SIZE;
+			memmove(cache, newCache, cacheCount * sizeof(u32));
+		}
+	}
+
+	void OptimizeVertexCacheTipsify(u32* destination, const u32* indices, u32 indexCount, u32 vertexCount, u32 cacheSize)
+	{
+		const u32 triangleCount = indexCount / 3;
+		if (triangleCount == 0) return;
+		const std::vector<u32> source(indices, indices + (size_t)triangleCount * 3);
+		TriangleAdjacency adjacency;
+		BuildAdjacency(adjacency, source.data(), triangleCount * 3, vertexCount);
+
+		//the time a vertex last entered the cache, it's still there while time - timestamp <= cacheSize
+		std::vector<u32> timestamps(vertexCount, 0);
+		std::vector<u8> emitted(triangleCount, 0);
+		std::vector<u32> deadEnds;
+		std::vector<u32> candidates;
+		u32 time = cacheSize + 1;
+		u32 cursor = 0;
+		u32 output = 0;
+		u32 fan = source[0];
+		while (fan != ~0u)
+		{
+			//every triangle left around the fan vertex
+			candidates.clear();
+			const u32 first = adjacency.offsets[fan];
+			const u32 last = adjacency.offsets[fan + 1];
+			for (u32 k = first; k < last; k++)
+			{
+				const u32 t = adjacency.triangles[k];
+				if (emitted[t]) continue;
+				emitted[t] = 1;
+				const u32* triangle = &source[(size_t)t * 3];
+				memcpy(destination + (size_t)output * 3, triangle, 3 * sizeof(u32));
+				output++;
+				for (u32 corner = 0; corner < 3; corner++)
+				{
+					const u32 v = triangle[corner];
+					deadEnds.push_back(v);
+					candidates.push_back(v);
+					adjacency.counts[v]--;
+					if (time - timestamps[v] > cacheSize) timestamps[v] = time++;
+				}
+			}
+
+			//the next fan: a vertex of this one that stays in the cache while its triangles are
+			//drawn, the oldest such one first
+			fan = ~0u;
+			s32 bestPriority = -1;
+			for (u32 v : candidates)
+			{
+				if (adjacency.counts[v] == 0) continue;
+				s32 priority = 0;
+				if (time - timestamps[v] + 2 * adjacency.counts[v] <= cacheSize) priority = (s32)(time - timestamps[v]);
+				if (priority > bestPriority)
+				{
+					bestPriority = priority;
+					fan = v;
+				}
+			}
+			//dead end: a recent vertex with triangles left, then anything
+			while (fan == ~0u && !deadEnds.empty())
+			{
+				const u32 v = deadEnds.back();
+				deadEnds.pop_back();
+				if (adjacency.counts[v] > 0) fan = v;
+			}
+			while (fan == ~0u && cursor < vertexCount)
+			{
+				if (adjacency.counts[cursor] > 0) fan = cursor;
+				else cursor++;
+			}
+		}
+	}
+
+	void OptimizeOverdraw(u32* destination, const u32* indices, u32 indexCount, const Vec3* positions, u32 vertexCount,
+		f32 threshold, u32 cacheSize)
+	{
+		const u32 triangleCount = indexCount / 3;
+		if (triangleCount == 0) return;
+		const std::vector<u32> source(indices, indices + (size_t)triangleCount * 3);
+		const f32 acmr = AnalyzeVertexCache(source.data(), triangleCount * 3, vertexCount, cacheSize).acmr;
+
+		//clusters, with the same cache model as the analysis. Once reordered a cluster starts with
+		//nothing of the previous one in the cache, so the simulation is flushed at every cut
+		std::vector<u32> clusterStarts;
+		std::vector<u32> timestamps(vertexCount, 0);
+		u32 time = cacheSize + 1;
+		u32 clusterMisses = 0;
+		u32 clusterTriangles = 0;
+		for (u32 t = 0; t < triangleCount; t++)
+		{
+			const u32* triangle = &source[(size_t)t * 3];
+			//cut where the cache restarts anyway, or once the cluster does as well as the whole list
+			bool cut = t == 0 || (f32)clusterMisses <= threshold * acmr * (f32)clusterTriangles;
+			if (!cut)
+			{
+				cut = true;
+				for (u32 corner = 0; corner < 3; corner++)
+					cut &= time - timestamps[triangle[corner]] > cacheSize;
+			}
+			if (cut)
+			{
+				clusterStarts.push_back(t);
+				clusterMisses = 0;
+				clusterTriangles = 0;
+				time += cacheSize + 1;
+			}
+			for (u32 corner = 0; corner < 3; corner++)
+			{
+				const u32 v = triangle[corner];
+				if (time - timestamps[v] > cacheSize)
+				{
+					timestamps[v] = time++;
+					clusterMisses++;
+				}
+			}
+			clusterTriangles++;
+		}
+		clusterStarts.push_back(triangleCount);
+		const u32 clusterCount = (u32)clusterStarts.size() - 1;
+
+		//area weighted centroid and normal of every cluster and of the mesh
+		std::vector<Vec3> centroids(clusterCount);
+		std::vector<Vec3> normals(clusterCount);
+		Vec3 meshCentroid;
+		f32 meshArea = 0.0f;
+		for (u32 c = 0; c < clusterCount; c++)
+		{
+			Vec3 centroid;
+			Vec3 normal;
+			f32 area = 0.0f;
+			for (u32 t = clusterStarts[c]; t < clusterStarts[c + 1]; t++)
+			{
+				const Vec3& p0 = positions[source[(size_t)t * 3]];
+				const Vec3& p1 = positions[source[(size_t)t * 3 + 1]];
+				const Vec3& p2 = positions[source[(size_t)t * 3 + 2]];
+				const Vec3 cross = Vec3::cross(p1 - p0, p2 - p0);
+				const f32 triangleArea = cross.mod();
+				centroid = centroid + (triangleArea / 3.0f) * (p0 + p1 + p2);
+				normal = normal + cross;
+				area += triangleArea;
+			}
+			meshCentroid = meshCentroid + centroid;
+			meshArea += area;
+			centroids[c] = area > 0.0f ? (1.0f / area) * centroid : Vec3();
+			normals[c] = normal.sqrmod() > 0.0f ? normal.normalized() : Vec3();
+		}
+		if (meshArea > 0.0f) meshCentroid = (1.0f / meshArea) * meshCentroid;
+
+		//clusters on the outside facing out cover the most of the rest, they go first
+		std::vector<f32> keys(clusterCount);
+		std::vector<u32> order(clusterCount);
+		for (u32 c = 0; c < clusterCount; c++)
+		{
+			keys[c] = Vec3::dot(centroids[c] - meshCentroid, normals[c]);
+			order[c] = c;
+		}
+		std::stable_sort(order.begin(), order.end(), [&keys](u32 a, u32 b) { return keys[a] > keys[b]; });
+
+		u32* out = destination;
+		for (u32 c : order)
+		{
+			const u32 count = (clusterStarts[c + 1] - clusterStarts[c]) * 3;
+			memcpy(out, &source[(size_t)clusterStarts[c] * 3], count * sizeof(u32));
+			out += count;
+		}
+	}
+
+	u32 OptimizeVertexFetch(u32* remap, u32* indices, u32 indexCount, u32 vertexCount)
+	{
+		for (u32 v = 0; v < vertexCount; v++)
+			remap[v] = ~0u;
+		u32 used = 0;
+		for (u32 i = 0; i < indexCount; i++)
+		{
+			u32& index = indices[i];
+			if (remap[index] == ~0u) remap[index] = used++;
+			index = remap[index];
+		}
+		return used;
+	}
+
+	VertexCacheStats AnalyzeVertexCache(const u32* indices, u32 indexCount, u32 vertexCount, u32 cacheSize)
+	{
+		VertexCacheStats stats = {};
+		std::vector<u32> timestamps(vertexCount, 0);
+		std::vector<u8> referenced(vertexCount, 0);
+		u32 referencedCount = 0;
+		u32 time = cacheSize + 1;
+		for (u32 i = 0; i < indexCount; i++)
+		{
+			const u32 v = indices[i];
+			if (time - timestamps[v] > cacheSize)
+			{
+				timestamps[v] = time++;
+				stats.transformed++;
+			}
+			if (!referenced[v])
+			{
+				referenced[v] = 1;
+				referencedCount++;
+			}
+		}
+		stats.acmr = indexCount >= 3 ? (f32)stats.transformed / (f32)(indexCount / 3) : 0.0f;
+		stats.atvr = referencedCount ? (f32)stats.transformed / (f32)referencedCount : 0.0f;
+		return stats;
+	}
+}
@@ -0,0 +1,50 @@
+#ifndef WF_MESH_OPTIMIZER_H
+#define WF_MESH_OPTIMIZER_H
+#include "wf_pch.h"
+#include "wf_math.h"
+
+//Index and vertex buffer reordering for triangle lists, used by MeshCooker and usable on meshes
+//built at runtime. The usual order is WeldVertices, OptimizeVertexCache per submesh, optionally
+//OptimizeOverdraw per submesh, then OptimizeVertexFetch over the whole index buffer.
+//destination can be the same buffer as indices everywhere.
+namespace Wolf
+{
+	//the cache AnalyzeVertexCache and Tipsify model, about what the post transform cache of
+	//current GPUs holds for a vertex with a few attributes
+	static const u32 VERTEX_CACHE_SIZE = 16;
+
+	struct VertexCacheStats
+	{
+		//vertex shader invocations with a FIFO cache of the given size
+		u32 transformed;
+		//average cache miss ratio: transformed per triangle, 0.5 is the ideal for big grids, 3 the worst
+		f32 acmr;
+		//average transform to vertex ratio: transformed per referenced vertex, 1 is the ideal
+		f32 atvr;
+	};
+
+	//merges the vertices whose vertexSize bytes are identical, remap[old] is the new index. Returns
+	//the new vertex count, the new order is the order of first occurrence
+	u32 WeldVertices(u32* remap, const void* vertices, u32 vertexCount, u32 vertexSize);
+	//destination[remap[i]] = vertices[i], destination can't be vertices
+	void RemapVertices(void* destination, const void* vertices, u32 vertexCount, u32 vertexSize, const u32* remap);
+	void RemapIndices(u32* destination, const u32* indices, u32 indexCount, const u32* remap);
+
+	//Forsyth's linear speed vertex cache optimization: greedy on a score of the cache position and
+	//the remaining triangles of each vertex, good for any cache size
+	void OptimizeVertexCache(u32* destination, const u32* indices, u32 indexCount, u32 vertexCount);
+	//Tipsify (Sander et al. 2007): faster and close to Forsyth for a known FIFO cache size
+	void OptimizeVertexCacheTipsify(u32* destination, const u32* indices, u32 indexCount, u32 vertexCount, u32 cacheSize = VERTEX_CACHE_SIZE);
+	//on a cache optimized list: cuts it in clusters where the cache restarts or where the cluster
+	//is already within threshold of the ACMR of the list, then draws the clusters facing out of the
+	//mesh first so they occlude the rest. threshold 1.05 costs about 5% of cache efficiency
+	void OptimizeOverdraw(u32* destination, const u32* indices, u32 indexCount, const Vec3* positions, u32 vertexCount,
+		f32 threshold = 1.05f, u32 cacheSize = VERTEX_CACHE_SIZE);
+	//renumbers the vertices in the order the indices first use them so fetches walk the vertex
+	//buffer forward. remap[old] is the new index, ~0u for unused vertices. Returns the used count
+	u32 OptimizeVertexFetch(u32* remap, u32* indices, u32 indexCount, u32 vertexCount);
+
+	VertexCacheStats AnalyzeVertexCache(const u32* indices, u32 indexCount, u32 vertexCount, u32 cacheSize = VERTEX_CACHE_SIZE);
+}
+
+#endif //WF_MESH_OPTIMIZER_H
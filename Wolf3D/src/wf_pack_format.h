@@ -0,0 +1,75 @@
+#ifndef WF_PACK_FORMAT_H
+#define WF_PACK_FORMAT_H
+#include "wf_pch.h"
+
+//Pack archive, written by AssetPacker and memory mapped by Vfs. A PackFileHeader, the
+//PackEntry table sorted by path hash, the paths, then the file contents, each one starting
+//on a PACK_DATA_ALIGNMENT boundary. Paths are relative to the packed directory, '/' separated
+//and not null terminated. Little endian.
+namespace Wolf
+{
+	static const u32 PACK_FILE_MAGIC = 0x4B504657; //"WFPK"
+	static const u32 PACK_FILE_VERSION = 1;
+	//cooked files keep the alignment of their data (TEXTURE_DATA_ALIGNMENT) inside a pack
+	static const u32 PACK_DATA_ALIGNMENT = 256;
+
+	struct PackEntry
+	{
+		u64 hash;
+		//from the start of the file
+		u64 offset;
+		u64 size;
+		//from namesOffset
+		u32 nameOffset;
+		u32 nameLength;
+	};
+	static_assert(sizeof(PackEntry) == 32, "PackEntry is part of the file format");
+
+	struct PackFileHeader
+	{
+		u32 magic;
+		u32 version;
+		u32 entryCount;
+		u32 namesSize;
+		//the entries follow the header
+		u64 namesOffset;
+		u64 fileSize;
+	};
+	static_assert(sizeof(PackFileHeader) == 32, "PackFileHeader is part of the file format");
+
+	//FNV-1a, 64 bits keep collisions rare enough that names are only compared on a hash match
+	inline u64 HashPackPath(const char* path, size_t length)
+	{
+		u64 hash = 0xcbf29ce484222325ull;
+		for (size_t i = 0; i < length; i++)
+		{
+			hash ^= (u8)path[i];
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+	//everything the runtime relies on, so a truncated or stale pack is rejected instead of read out of bounds
+	inline bool ValidatePackFile(const void* data, u64 size)
+	{
+		if (size < sizeof(PackFileHeader) || ((uintptr_t)data & 7)) return false;
+		const PackFileHeader& header = *(const PackFileHeader*)data;
+		if (header.magic != PACK_FILE_MAGIC || header.version != PACK_FILE_VERSION || header.fileSize != size) return false;
+		if (header.namesOffset != sizeof(PackFileHeader) + (u64)header.entryCount * sizeof(PackEntry)) return false;
+		if (header.namesOffset > size || header.namesSize > size - header.namesOffset) return false;
+
+		const PackEntry* entries = (const PackEntry*)((const u8*)data + sizeof(PackFileHeader));
+		const char* names = (const char*)data + header.namesOffset;
+		for (u32 i = 0; i < header.entryCount; i++)
+		{
+			const PackEntry& entry = entries[i];
+			if (i > 0 && entries[i - 1].hash > entry.hash) return false;
+			if (entry.nameOffset > header.namesSize || entry.nameLength > header.namesSize - entry.nameOffset) return false;
+			if (entry.hash != HashPackPath(names + entry.nameOffset, entry.nameLength)) return false;
+			if (entry.offset % PACK_DATA_ALIGNMENT || entry.offset > size || entry.size > size - entry.offset) return false;
+		}
+		return true;
+	}
+}
+
+#endif //WF_PACK_FORMAT_H
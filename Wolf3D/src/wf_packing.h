@@ -0,0 +1,416 @@
+#ifndef WF_PACKING_H
+#define WF_PACKING_H
+#include "wf_math.h"
+#include "wf_culling.h"
+#include "wf_math_fast.h"
+
+//Compact vertex attribute formats and the converters to and from f32
+//  half        16 bit IEEE float, round to nearest even, inf/nan preserved (nan payloads are not)
+//  OctNormal   unit vector folded onto an octahedron, 2 x snorm16 (4 bytes instead of 12)
+//  tangent     xyz snorm10 + handedness in the 2 bit w (GL_INT_2_10_10_10_REV layout)
+//  position    3 x snorm16 relative to a bounds box (6 bytes instead of 12)
+//Round trip bounds (checked by MathBench --accuracy):
+//  half        relative 4.9e-4 for normal halfs, values over 65504 become inf
+//  normal      angle 7e-5 rad
+//  tangent     1e-3 per component, w exact
+//  position    1.6e-5 * extents per component (half a step of extents / 32767)
+//Batch versions process 4 elements per SSE iteration, the remainder goes through the scalar code
+namespace Wolf
+{
+	struct OctNormal
+	{
+		s16 x, y;
+	};
+
+	struct PackedPosition
+	{
+		s16 x, y, z;
+	};
+
+	namespace Pack
+	{
+		const f32 snorm16Max = 32767.0f;
+		const f32 snorm10Max = 511.0f;
+
+		//round to nearest even like _mm_cvtps_epi32, so the scalar tail matches the SSE lanes
+		inline s32 roundToInt(f32 x)
+		{
+			return (s32)Math::Fast::roundNearest(x);
+		}
+
+		//round to nearest even, based on Fabian Giesen's float_to_half_fast3_rtne
+		inline u16 floatToHalf(f32 value)
+		{
+			union { f32 f; u32 u; } bits = { value };
+			const u32 sign = bits.u & 0x80000000u;
+			bits.u ^= sign;
+
+			u32 result;
+			if (bits.u >= ((127 + 16) << 23))
+				result = bits.u > (255u << 23) ? 0x7e00 : 0x7c00; //nan stays nan, overflow goes to inf
+			else if (bits.u < ((127 - 14) << 23))
+			{
+				//subnormal half, the magic add rounds the mantissa in place
+				union { u32 u; f32 f; } magic = { ((127 - 15) + (23 - 10) + 1) << 23 };
+				bits.f += magic.f;
+				result = bits.u - magic.u;
+			}
+			else
+			{
+				const u32 mantissaOdd = (bits.u >> 13) & 1;
+				bits.u += ((u32)(15 - 127) << 23) + 0xfff + mantissaOdd;
+				result = bits.u >> 13;
+			}
+			return (u16)(result | (sign >> 16));
+		}
+
+		inline f32 halfToFloat(u16 half)
+		{
+			union { u32 u; f32 f; } magic = { 113 << 23 };
+			const u32 shiftedExponent = 0x7c00 << 13;
+			union { u32 u; f32 f; } result;
+			result.u = (half & 0x7fff) << 13;
+			const u32 exponent = shiftedExponent & result.u;
+			result.u += (127 - 15) << 23;
+			if (exponent == shiftedExponent)
+				result.u += (128 - 16) << 23; //inf/nan
+			else if (exponent == 0)
+			{
+				result.u += 1 << 23; //zero/subnormal
+				result.f -= magic.f;
+			}
+			result.u |= (u32)(half & 0x8000) << 16;
+			return result.f;
+		}
+
+		//n doesn't have to be normalized, a zero vector encodes as +z
+		inline OctNormal encodeNormal(const Vec3& n)
+		{
+			const f32 l1 = fabsf(n.x) + fabsf(n.y) + fabsf(n.z);
+			const f32 inv = l1 > 0.0f ? 1.0f / l1 : 0.0f;
+			f32 px = n.x * inv;
+			f32 py = n.y * inv;
+			if (n.z < 0.0f)
+			{
+				const f32 fx = (1.0f - fabsf(py)) * (px >= 0.0f ? 1.0f : -1.0f);
+				const f32 fy = (1.0f - fabsf(px)) * (py >= 0.0f ? 1.0f : -1.0f);
+				px = fx;
+				py = fy;
+			}
+			return OctNormal{ (s16)roundToInt(px * snorm16Max), (s16)roundToInt(py * snorm16Max) };
+		}
+
+		inline Vec3 decodeNormal(OctNormal packed)
+		{
+			Vec3 v(packed.x / snorm16Max, packed.y / snorm16Max, 0.0f);
+			v.z = 1.0f - fabsf(v.x) - fabsf(v.y);
+			const f32 t = v.z < 0.0f ? -v.z : 0.0f;
+			v.x += v.x >= 0.0f ? -t : t;
+			v.y += v.y >= 0.0f ? -t : t;
+			return v.normalized();
+		}
+
+		//xyz in [-1, 1], w is the bitangent sign and only its sign is kept
+		inline u32 packTangent(const Vec4& t)
+		{
+			const u32 x = (u32)roundToInt(Math::clamp(t.x, -1.0f, 1.0f) * snorm10Max) & 0x3ff;
+			const u32 y = (u32)roundToInt(Math::clamp(t.y, -1.0f, 1.0f) * snorm10Max) & 0x3ff;
+			const u32 z = (u32)roundToInt(Math::clamp(t.z, -1.0f, 1.0f) * snorm10Max) & 0x3ff;
+			const u32 w = t.w < 0.0f ? 3u : 1u;
+			return x | (y << 10) | (z << 20) | (w << 30);
+		}
+
+		inline Vec4 unpackTangent(u32 packed)
+		{
+			//shift each field to the top and back down so the sign extends
+			return Vec4(
+				(f32)((s32)(packed << 22) >> 22) / snorm10Max,
+				(f32)((s32)(packed << 12) >> 22) / snorm10Max,
+				(f32)((s32)(packed << 2) >> 22) / snorm10Max,
+				(f32)((s32)packed >> 30));
+		}
+
+		//per axis scale from the bounds, flat axes get 0
+		inline Vec3 positionScale(const AABB& bounds)
+		{
+			const Vec3 e = bounds.extents();
+			return Vec3(e.x > 0.0f ? snorm16Max / e.x : 0.0f, e.y > 0.0f ? snorm16Max / e.y : 0.0f, e.z > 0.0f ? snorm16Max / e.z : 0.0f);
+		}
+
+		//points outside the bounds are clamped to them
+		inline PackedPosition packPosition(const Vec3& p, const AABB& bounds)
+		{
+			const Vec3 c = bounds.center();
+			const Vec3 scale = positionScale(bounds);
+			return PackedPosition{
+				(s16)roundToInt(Math::clamp((p.x - c.x) * scale.x, -snorm16Max, snorm16Max)),
+				(s16)roundToInt(Math::clamp((p.y - c.y) * scale.y, -snorm16Max, snorm16Max)),
+				(s16)roundToInt(Math::clamp((p.z - c.z) * scale.z, -snorm16Max, snorm16Max)) };
+		}
+
+		inline Vec3 unpackPosition(PackedPosition p, const AABB& bounds)
+		{
+			const Vec3 c = bounds.center();
+			const Vec3 e = bounds.extents() * (1.0f / snorm16Max);
+			return Vec3(c.x + p.x * e.x, c.y + p.y * e.y, c.z + p.z * e.z);
+		}
+
+	#ifdef WF_SIMD_SSE
+		//SSE2 versions of floatToHalf/halfToFloat, results are in 32 bit lanes
+		//the sign is smeared over the top 16 bits so _mm_packs_epi32 narrows them without saturating
+		inline __m128i floatToHalf4(__m128 f)
+		{
+			const __m128i minNormal = _mm_set1_epi32((127 - 14) << 23);
+			const __m128i subnormalMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+			const __m128i normalBias = _mm_set1_epi32(0xfff - ((127 - 15) << 23));
+
+			const __m128 justSign = _mm_and_ps(f, _mm_set1_ps(-0.0f));
+			const __m128 absF = _mm_xor_ps(f, justSign);
+			const __m128i absBits = _mm_castps_si128(absF);
+			const __m128i isNan = _mm_castps_si128(_mm_cmpunord_ps(absF, absF));
+			const __m128i isRegular = _mm_cmpgt_epi32(_mm_set1_epi32((127 + 16) << 23), absBits);
+			const __m128i infOrNan = _mm_or_si128(_mm_and_si128(isNan, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7c00));
+
+			const __m128i isSubnormal = _mm_cmpgt_epi32(minNormal, absBits);
+			const __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absF, _mm_castsi128_ps(subnormalMagic))), subnormalMagic);
+
+			const __m128i mantissaOdd = _mm_srai_epi32(_mm_slli_epi32(absBits, 31 - 13), 31);
+			const __m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(absBits, normalBias), mantissaOdd), 13);
+
+			const __m128i finite = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal));
+			const __m128i joined = _mm_or_si128(_mm_and_si128(isRegular, finite), _mm_andnot_si128(isRegular, infOrNan));
+			return _mm_or_si128(joined, _mm_srai_epi32(_mm_castps_si128(justSign), 16));
+		}
+
+		//halfs zero extended in 32 bit lanes
+		inline __m128 halfToFloat4(__m128i h)
+		{
+			const __m128i expMantissa = _mm_and_si128(h, _mm_set1_epi32(0x7fff));
+			const __m128i justSign = _mm_xor_si128(h, expMantissa);
+			const __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(expMantissa, 13)), _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23)));
+			const __m128i wasInfNan = _mm_cmpgt_epi32(expMantissa, _mm_set1_epi32(0x7bff));
+			const __m128 infNanExponent = _mm_and_ps(_mm_castsi128_ps(wasInfNan), _mm_castsi128_ps(_mm_set1_epi32(255 << 23)));
+			return _mm_or_ps(scaled, _mm_or_ps(_mm_castsi128_ps(_mm_slli_epi32(justSign, 16)), infNanExponent));
+		}
+
+		//s16 pairs (x0 y0 x1 y1 ...) sign extended to two registers of 32 bit lanes
+		inline void unpackPairs4(__m128i pairs, __m128i& x, __m128i& y)
+		{
+			x = _mm_srai_epi32(_mm_slli_epi32(pairs, 16), 16);
+			y = _mm_srai_epi32(pairs, 16);
+		}
+	#endif
+	}
+
+	inline void PackHalfs(const f32* in, u16* out, u32 count)
+	{
+		u32 i = 0;
+	#if defined(WF_SIMD_F16C)
+		for (; i + 4 <= count; i += 4)
+			_mm_storel_epi64((__m128i*)(out + i), _mm_cvtps_ph(_mm_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT));
+	#elif defined(WF_SIMD_SSE)
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m128i lo = Pack::floatToHalf4(_mm_loadu_ps(in + i));
+			const __m128i hi = Pack::floatToHalf4(_mm_loadu_ps(in + i + 4));
+			_mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(lo, hi));
+		}
+	#endif
+		for (; i < count; i++)
+			out[i] = Pack::floatToHalf(in[i]);
+	}
+
+	inline void UnpackHalfs(const u16* in, f32* out, u32 count)
+	{
+		u32 i = 0;
+	#if defined(WF_SIMD_F16C)
+		for (; i + 4 <= count; i += 4)
+			_mm_storeu_ps(out + i, _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)(in + i))));
+	#elif defined(WF_SIMD_SSE)
+		const __m128i zero = _mm_setzero_si128();
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m128i h = _mm_loadu_si128((const __m128i*)(in + i));
+			_mm_storeu_ps(out + i, Pack::halfToFloat4(_mm_unpacklo_epi16(h, zero)));
+			_mm_storeu_ps(out + i + 4, Pack::halfToFloat4(_mm_unpackhi_epi16(h, zero)));
+		}
+	#endif
+		for (; i < count; i++)
+			out[i] = Pack::halfToFloat(in[i]);
+	}
+
+	inline void PackNormals(const Vec3* in, OctNormal* out, u32 count)
+	{
+		u32 i = 0;
+	#ifdef WF_SIMD_SSE
+		const __m128 signMask = _mm_set1_ps(-0.0f);
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 scale = _mm_set1_ps(Pack::snorm16Max);
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 x, y, z;
+			Simd::loadXYZx4(in[i].values, x, y, z);
+
+			const __m128 l1 = _mm_add_ps(_mm_add_ps(_mm_andnot_ps(signMask, x), _mm_andnot_ps(signMask, y)), _mm_andnot_ps(signMask, z));
+			const __m128 inv = _mm_and_ps(_mm_div_ps(one, l1), _mm_cmpgt_ps(l1, zero));
+			__m128 px = _mm_mul_ps(x, inv);
+			__m128 py = _mm_mul_ps(y, inv);
+
+			//lower hemisphere folds over the diagonals, sign of 0 counts as positive
+			const __m128 signX = _mm_or_ps(_mm_and_ps(_mm_cmplt_ps(px, zero), signMask), one);
+			const __m128 signY = _mm_or_ps(_mm_and_ps(_mm_cmplt_ps(py, zero), signMask), one);
+			const __m128 fx = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, py)), signX);
+			const __m128 fy = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, px)), signY);
+			const __m128 lower = _mm_cmplt_ps(z, zero);
+			px = _mm_or_ps(_mm_and_ps(lower, fx), _mm_andnot_ps(lower, px));
+			py = _mm_or_ps(_mm_and_ps(lower, fy), _mm_andnot_ps(lower, py));
+
+			const __m128i qx = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(px, scale)), _mm_setzero_si128());
+			const __m128i qy = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(py, scale)), _mm_setzero_si128());
+			_mm_storeu_si128((__m128i*)(out + i), _mm_unpacklo_epi16(qx, qy));
+		}
+	#endif
+		for (; i < count; i++)
+			out[i] = Pack::encodeNormal(in[i]);
+	}
+
+	inline void UnpackNormals(const OctNormal* in, Vec3* out, u32 count)
+	{
+		u32 i = 0;
+	#ifdef WF_SIMD_SSE
+		const __m128 signMask = _mm_set1_ps(-0.0f);
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 invScale = _mm_set1_ps(1.0f / Pack::snorm16Max);
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128i qx, qy;
+			Pack::unpackPairs4(_mm_loadu_si128((const __m128i*)(in + i)), qx, qy);
+			__m128 x = _mm_mul_ps(_mm_cvtepi32_ps(qx), invScale);
+			__m128 y = _mm_mul_ps(_mm_cvtepi32_ps(qy), invScale);
+			const __m128 z = _mm_sub_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, x)), _mm_andnot_ps(signMask, y));
+
+			//x -= copysign(t, x), sign of 0 counts as positive
+			const __m128 t = _mm_max_ps(_mm_sub_ps(zero, z), zero);
+			x = _mm_sub_ps(x, _mm_or_ps(t, _mm_and_ps(_mm_cmplt_ps(x, zero), signMask)));
+			y = _mm_sub_ps(y, _mm_or_ps(t, _mm_and_ps(_mm_cmplt_ps(y, zero), signMask)));
+
+			const __m128 len = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+			const __m128 inv = _mm_div_ps(one, len);
+			Simd::storeXYZx4(out[i].values, _mm_mul_ps(x, inv), _mm_mul_ps(y, inv), _mm_mul_ps(z, inv));
+		}
+	#endif
+		for (; i < count; i++)
+			out[i] = Pack::decodeNormal(in[i]);
+	}
+
+	inline void PackTangents(const Vec4* in, u32* out, u32 count)
+	{
+		u32 i = 0;
+	#ifdef WF_SIMD_SSE
+		const __m128 minusOne = _mm_set1_ps(-1.0f);
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 scale = _mm_set1_ps(Pack::snorm10Max);
+		const __m128i fieldMask = _mm_set1_epi32(0x3ff);
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 x = _mm_loadu_ps(&in[i].x);
+			__m128 y = _mm_loadu_ps(&in[i + 1].x);
+			__m128 z = _mm_loadu_ps(&in[i + 2].x);
+			__m128 w = _mm_loadu_ps(&in[i + 3].x);
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+
+			const __m128i qx = _mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(x, minusOne), one), scale)), fieldMask);
+			const __m128i qy = _mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(y, minusOne), one), scale)), fieldMask);
+			const __m128i qz = _mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(z, minusOne), one), scale)), fieldMask);
+			//w < 0 -> 0b11 (-1), otherwise 0b01
+			const __m128i qw = _mm_or_si128(_mm_and_si128(_mm_castps_si128(_mm_cmplt_ps(w, _mm_setzero_ps())), _mm_set1_epi32(2)), _mm_set1_epi32(1));
+
+			const __m128i packed = _mm_or_si128(_mm_or_si128(qx, _mm_slli_epi32(qy, 10)), _mm_or_si128(_mm_slli_epi32(qz, 20), _mm_slli_epi32(qw, 30)));
+			_mm_storeu_si128((__m128i*)(out + i), packed);
+		}
+	#endif
+		for (; i < count; i++)
+			out[i] = Pack::packTangent(in[i]);
+	}
+
+	inline void UnpackTangents(const u32* in, Vec4* out, u32 count)
+	{
+		u32 i = 0;
+	#ifdef WF_SIMD_SSE
+		const __m128 invScale = _mm_set1_ps(1.0f / Pack::snorm10Max);
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128i packed = _mm_loadu_si128((const __m128i*)(in + i));
+			__m128 x = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(packed, 22), 22)), invScale);
+			__m128 y = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(packed, 12), 22)), invScale);
+			__m128 z = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(packed, 2), 22)), invScale);
+			__m128 w = _mm_cvtepi32_ps(_mm_srai_epi32(packed, 30));
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+			_mm_storeu_ps(&out[i].x, x);
+			_mm_storeu_ps(&out[i + 1].x, y);
+			_mm_storeu_ps(&out[i + 2].x, z);
+			_mm_storeu_ps(&out[i + 3].x, w);
+		}
+	#endif
+		for (; i < count; i++)
+			out[i] = Pack::unpackTangent(in[i]);
+	}
+
+	//bounds usually come from the mesh, AABB::expand over its positions
+	inline void PackPositions(const Vec3* in, const AABB& bounds, PackedPosition* out, u32 count)
+	{
+		u32 i = 0;
+	#ifdef WF_SIMD_SSE
+		const Vec3 c = bounds.center();
+		const Vec3 s = Pack::positionScale(bounds);
+		const __m128 cx = _mm_set1_ps(c.x), cy = _mm_set1_ps(c.y), cz = _mm_set1_ps(c.z);
+		const __m128 sx = _mm_set1_ps(s.x), sy = _mm_set1_ps(s.y), sz = _mm_set1_ps(s.z);
+		const __m128 hi = _mm_set1_ps(Pack::snorm16Max);
+		const __m128 lo = _mm_set1_ps(-Pack::snorm16Max);
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 x, y, z;
+			Simd::loadXYZx4(in[i].values, x, y, z);
+			x = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_sub_ps(x, cx), sx), lo), hi);
+			y = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_sub_ps(y, cy), sy), lo), hi);
+			z = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_sub_ps(z, cz), sz), lo), hi);
+
+			//no cheap 16 bit shuffle in SSE2 to build the 6 byte triples, the lanes are written out one by one
+			const __m128i xy = _mm_packs_epi32(_mm_cvtps_epi32(x), _mm_cvtps_epi32(y));
+			const __m128i zz = _mm_packs_epi32(_mm_cvtps_epi32(z), _mm_setzero_si128());
+			PackedPosition* o = out + i;
+			o[0].x = (s16)_mm_extract_epi16(xy, 0); o[0].y = (s16)_mm_extract_epi16(xy, 4); o[0].z = (s16)_mm_extract_epi16(zz, 0);
+			o[1].x = (s16)_mm_extract_epi16(xy, 1); o[1].y = (s16)_mm_extract_epi16(xy, 5); o[1].z = (s16)_mm_extract_epi16(zz, 1);
+			o[2].x = (s16)_mm_extract_epi16(xy, 2); o[2].y = (s16)_mm_extract_epi16(xy, 6); o[2].z = (s16)_mm_extract_epi16(zz, 2);
+			o[3].x = (s16)_mm_extract_epi16(xy, 3); o[3].y = (s16)_mm_extract_epi16(xy, 7); o[3].z = (s16)_mm_extract_epi16(zz, 3);
+		}
+	#endif
+		for (; i < count; i++)
+			out[i] = Pack::packPosition(in[i], bounds);
+	}
+
+	inline void UnpackPositions(const PackedPosition* in, const AABB& bounds, Vec3* out, u32 count)
+	{
+		u32 i = 0;
+	#ifdef WF_SIMD_SSE
+		const Vec3 c = bounds.center();
+		const Vec3 e = bounds.extents() * (1.0f / Pack::snorm16Max);
+		const __m128 cx = _mm_set1_ps(c.x), cy = _mm_set1_ps(c.y), cz = _mm_set1_ps(c.z);
+		const __m128 ex = _mm_set1_ps(e.x), ey = _mm_set1_ps(e.y), ez = _mm_set1_ps(e.z);
+		for (; i + 4 <= count; i += 4)
+		{
+			const PackedPosition* p = in + i;
+			const __m128 x = _mm_cvtepi32_ps(_mm_setr_epi32(p[0].x, p[1].x, p[2].x, p[3].x));
+			const __m128 y = _mm_cvtepi32_ps(_mm_setr_epi32(p[0].y, p[1].y, p[2].y, p[3].y));
+			const __m128 z = _mm_cvtepi32_ps(_mm_setr_epi32(p[0].z, p[1].z, p[2].z, p[3].z));
+			Simd::storeXYZx4(out[i].values, _mm_add_ps(cx, _mm_mul_ps(x, ex)), _mm_add_ps(cy, _mm_mul_ps(y, ey)), _mm_add_ps(cz, _mm_mul_ps(z, ez)));
+		}
+	#endif
+		for (; i < count; i++)
+			out[i] = Pack::unpackPosition(in[i], bounds);
+	}
+}
+
+#endif //WF_PACKING_H
@@ -2,7 +2,6 @@
 #define WF_PCTH
 #include "glad/glad.h"
 #include "stb/stb_image.h"
-#include "textparser/textparser.h"
 #include "tinyXML2/tinyxml2.h"
 #include "SDL2/include/SDL.h"
 
@@ -20,4 +19,7 @@
 #include "Imgui/imgui.h"
 #include "Imgui/imgui_impl_opengl3.h"
 #include "Imgui/imgui_impl_sdl.h"
+
+//the old external TextParser forwards to the engine's, which needs the types above
+#include "textparser/textparser.h"
 #endif
\ No newline at end of file
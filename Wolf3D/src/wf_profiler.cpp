@@ -0,0 +1,396 @@
+#include "wf_pch.h"
+#include "wf_profiler.h"
+#include "wf_debug.h"
+#include "wf_memory.h"
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace Wolf
+{
+	//single producer (the owning thread) single consumer (NewFrame) ring
+	struct ProfilerThreadBuffer
+	{
+		ProfileEvent events[Profiler::EVENTS_PER_THREAD];
+		alignas(64) std::atomic<u64> writeIndex{ 0 };
+		alignas(64) std::atomic<u64> readIndex{ 0 };
+		std::atomic<u64> dropped{ 0 };
+		char name[32];
+		u32 index;
+	};
+
+	static const std::chrono::steady_clock::time_point profilerEpoch = std::chrono::steady_clock::now();
+
+	static ProfilerThreadBuffer* threadBuffers[Profiler::MAX_THREADS];
+	static std::atomic<u32> threadCount{ 0 };
+	static std::mutex registerLock;
+	//buffers of threads that exited, handed to the next new thread (under registerLock)
+	static std::vector<ProfilerThreadBuffer*> freeBuffers;
+	static std::atomic<u32> rejectedThreads{ 0 };
+
+	static thread_local ProfilerThreadBuffer* threadBuffer = nullptr;
+	static thread_local u32 threadDepth = 0;
+	static thread_local bool threadRejected = false;
+
+	//gives the buffer back when its thread exits. The ring is left as is, NewFrame still drains
+	//the last zones and the next owner keeps writing after them
+	struct ProfilerThreadRelease
+	{
+		ProfilerThreadBuffer* buffer = nullptr;
+
+		~ProfilerThreadRelease()
+		{
+			if (!buffer) return;
+			std::lock_guard<std::mutex> lock(registerLock);
+			freeBuffers.push_back(buffer);
+			//zones from thread_local destructors that run after this one are ignored
+			threadBuffer = nullptr;
+			threadRejected = true;
+		}
+	};
+	static thread_local ProfilerThreadRelease threadRelease;
+
+	//everything below is only touched by the main thread
+	static std::vector<ProfileEvent> lastFrame;
+	static std::vector<ProfileEvent> currentFrame;
+	static u64 lastFrameStart = 0;
+	static u64 lastFrameEnd = 0;
+	static u64 frameStart = 0;
+	static f32 frameHistory[Profiler::FRAME_HISTORY];
+	static u32 frameHistoryCount = 0;
+	static bool paused = false;
+
+	static std::vector<ProfileEvent> captureEvents;
+	static u32 captureFramesLeft = 0;
+	static char capturePath[256];
+
+	static ProfilerThreadBuffer* GetThreadBuffer()
+	{
+		if (threadBuffer || threadRejected) return threadBuffer;
+
+		std::lock_guard<std::mutex> lock(registerLock);
+		MemoryTagScope tag(MemoryTag::Profiler);
+		ProfilerThreadBuffer* buffer = nullptr;
+		if (!freeBuffers.empty())
+		{
+			buffer = freeBuffers.back();
+			freeBuffers.pop_back();
+		}
+		else
+		{
+			const u32 index = threadCount.load(std::memory_order_relaxed);
+			if (index >= Profiler::MAX_THREADS)
+			{
+				const u32 rejected = rejectedThreads.fetch_add(1, std::memory_order_relaxed) + 1;
+				WF_LOGERROR("Profiler: %u threads alive, zones of this one are ignored (%u threads over the limit so far)", Profiler::MAX_THREADS, rejected);
+				threadRejected = true;
+				return nullptr;
+			}
+			buffer = new ProfilerThreadBuffer();
+			buffer->index = index;
+			threadBuffers[index] = buffer;
+			threadCount.store(index + 1, std::memory_order_release);
+		}
+		snprintf(buffer->name, sizeof(buffer->name), "Thread %u", buffer->index);
+		threadBuffer = buffer;
+		threadRelease.buffer = buffer;
+		return buffer;
+	}
+
+	u64 Profiler::Now()
+	{
+		//+1 keeps 0 free to mean "zone not started"
+		return (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - profilerEpoch).count() + 1;
+	}
+
+	void Profiler::SetThreadName(const char* name)
+	{
+		ProfilerThreadBuffer* buffer = GetThreadBuffer();
+		if (!buffer) return;
+		std::lock_guard<std::mutex> lock(registerLock);
+		snprintf(buffer->name, sizeof(buffer->name), "%s", name);
+	}
+
+	u64 Profiler::BeginZone()
+	{
+		threadDepth++;
+		return Now();
+	}
+
+	void Profiler::EndZone(const char* name, u64 start)
+	{
+		const u64 end = Now();
+		threadDepth--;
+
+		ProfilerThreadBuffer* buffer = GetThreadBuffer();
+		if (!buffer) return;
+
+		const u64 write = buffer->writeIndex.load(std::memory_order_relaxed);
+		if (write - buffer->readIndex.load(std::memory_order_acquire) >= EVENTS_PER_THREAD)
+		{
+			buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		buffer->events[write & (EVENTS_PER_THREAD - 1)] = ProfileEvent{ name, start, end, threadDepth, buffer->index };
+		buffer->writeIndex.store(write + 1, std::memory_order_release);
+	}
+
+	u64 Profiler::GetDroppedEvents()
+	{
+		u64 dropped = 0;
+		const u32 count = threadCount.load(std::memory_order_acquire);
+		for (u32 i = 0; i < count; i++)
+			dropped += threadBuffers[i]->dropped.load(std::memory_order_relaxed);
+		return dropped;
+	}
+
+	u32 Profiler::GetRejectedThreads()
+	{
+		return rejectedThreads.load(std::memory_order_relaxed);
+	}
+
+	static void WriteJsonString(FILE* file, const char* text)
+	{
+		fputc('"', file);
+		for (const char* c = text; *c; c++)
+		{
+			if (*c == '"' || *c == '\\') fputc('\\', file);
+			if ((u8)*c >= 0x20) fputc(*c, file);
+		}
+		fputc('"', file);
+	}
+
+	static bool WriteChromeTrace(const char* path, const std::vector<ProfileEvent>& events)
+	{
+		FILE* file = fopen(path, "w");
+		if (!file)
+		{
+			WF_LOGERROR("Profiler: can't open %s", path);
+			return false;
+		}
+
+		//complete events ("ph":"X") in microseconds, thread names as metadata
+		fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+		const u32 count = threadCount.load(std::memory_order_acquire);
+		{
+			std::lock_guard<std::mutex> lock(registerLock);
+			for (u32 i = 0; i < count; i++)
+			{
+				fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", i);
+				WriteJsonString(file, threadBuffers[i]->name);
+				fprintf(file, "}},\n");
+			}
+		}
+		for (size_t i = 0; i < events.size(); i++)
+		{
+			const ProfileEvent& event = events[i];
+			fprintf(file, "{\"name\":");
+			WriteJsonString(file, event.name);
+			fprintf(file, ",\"cat\":\"cpu\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}%s\n",
+				event.start / 1000.0, (event.end - event.start) / 1000.0, event.thread, i + 1 < events.size() ? "," : "");
+		}
+		fprintf(file, "]}\n");
+		fclose(file);
+		return true;
+	}
+
+	void Profiler::NewFrame()
+	{
+		const u64 now = Now();
+		MemoryTagScope tag(MemoryTag::Profiler);
+
+		//drain every ring, zones still open on other threads show up in a later frame
+		currentFrame.clear();
+		const u32 count = threadCount.load(std::memory_order_acquire);
+		for (u32 i = 0; i < count; i++)
+		{
+			ProfilerThreadBuffer* buffer = threadBuffers[i];
+			const u64 read = buffer->readIndex.load(std::memory_order_relaxed);
+			const u64 write = buffer->writeIndex.load(std::memory_order_acquire);
+			for (u64 e = read; e < write; e++)
+				currentFrame.push_back(buffer->events[e & (EVENTS_PER_THREAD - 1)]);
+			buffer->readIndex.store(write, std::memory_order_release);
+		}
+
+		if (frameStart)
+		{
+			frameHistory[frameHistoryCount++ % FRAME_HISTORY] = (f32)((now - frameStart) / 1e6);
+
+			if (captureFramesLeft)
+			{
+				captureEvents.insert(captureEvents.end(), currentFrame.begin(), currentFrame.end());
+				if (--captureFramesLeft == 0)
+				{
+					if (WriteChromeTrace(capturePath, captureEvents))
+						WF_LOG("Profiler: trace written to %s", capturePath);
+					captureEvents.clear();
+					captureEvents.shrink_to_fit();
+				}
+			}
+
+			if (!paused)
+			{
+				//parents before children, the ImGui tree relies on it
+				std::sort(currentFrame.begin(), currentFrame.end(), [](const ProfileEvent& a, const ProfileEvent& b)
+				{
+					if (a.thread != b.thread) return a.thread < b.thread;
+					if (a.start != b.start) return a.start < b.start;
+					return a.depth < b.depth;
+				});
+				lastFrame.swap(currentFrame);
+				lastFrameStart = frameStart;
+				lastFrameEnd = now;
+			}
+		}
+		frameStart = now;
+	}
+
+	void Profiler::BeginCapture(u32 frameCount, const char* path)
+	{
+		snprintf(capturePath, sizeof(capturePath), "%s", path);
+		MemoryTagScope tag(MemoryTag::Profiler);
+		captureEvents.clear();
+		//guess from the last frame so the capture doesn't grow every frame
+		captureEvents.reserve((size_t)frameCount * (lastFrame.size() + 64));
+		captureFramesLeft = frameCount;
+	}
+
+	bool Profiler::IsCapturing()
+	{
+		return captureFramesLeft > 0;
+	}
+
+	static void DrawThread(const ProfileEvent* events, u32 count, f64 frameNs)
+	{
+		struct OpenNode
+		{
+			u32 depth;
+			bool opened;
+		};
+		OpenNode stack[64];
+		u32 top = 0;
+
+		for (u32 i = 0; i < count; i++)
+		{
+			const ProfileEvent& event = events[i];
+			while (top && stack[top - 1].depth >= event.depth)
+			{
+				if (stack[top - 1].opened) ImGui::TreePop();
+				top--;
+			}
+
+			const bool visible = top == 0 || stack[top - 1].opened;
+			const bool hasChildren = i + 1 < count && events[i + 1].depth > event.depth && events[i + 1].start < event.end;
+			const f64 ns = (f64)(event.end - event.start);
+			if (!visible)
+			{
+				if (hasChildren && top < 64) stack[top++] = OpenNode{ event.depth, false };
+				continue;
+			}
+
+			if (hasChildren && top < 64)
+			{
+				const bool opened = ImGui::TreeNodeEx((void*)(intptr_t)i, ImGuiTreeNodeFlags_SpanAvailWidth, "%s  %.3f ms  %.1f%%", event.name, ns / 1e6, 100.0 * ns / frameNs);
+				stack[top++] = OpenNode{ event.depth, opened };
+			}
+			else
+			{
+				ImGui::TreeNodeEx((void*)(intptr_t)i, ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen | ImGuiTreeNodeFlags_SpanAvailWidth,
+					"%s  %.3f ms  %.1f%%", event.name, ns / 1e6, 100.0 * ns / frameNs);
+			}
+		}
+		while (top)
+		{
+			if (stack[top - 1].opened) ImGui::TreePop();
+			top--;
+		}
+	}
+
+	void Profiler::DrawImGui(bool* open)
+	{
+		if (!ImGui::Begin("Profiler", open))
+		{
+			ImGui::End();
+			return;
+		}
+
+		const u32 historyCount = frameHistoryCount < FRAME_HISTORY ? frameHistoryCount : FRAME_HISTORY;
+		f32 average = 0.0f, worst = 0.0f;
+		for (u32 i = 0; i < historyCount; i++)
+		{
+			average += frameHistory[i];
+			worst = frameHistory[i] > worst ? frameHistory[i] : worst;
+		}
+		if (historyCount) average /= historyCount;
+		ImGui::Text("frame avg %.2f ms  max %.2f ms  dropped zones %llu", average, worst, (unsigned long long)GetDroppedEvents());
+		const u32 rejected = GetRejectedThreads();
+		if (rejected) ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.3f, 1.0f), "%u threads not profiled, more than %u alive at once", rejected, MAX_THREADS);
+		ImGui::PlotLines("##frames", frameHistory, (int)historyCount, historyCount < FRAME_HISTORY ? 0 : (int)(frameHistoryCount % FRAME_HISTORY),
+			nullptr, 0.0f, worst * 1.2f, ImVec2(0.0f, 60.0f));
+
+		bool enabled = IsEnabled();
+		if (ImGui::Checkbox("Enabled", &enabled)) SetEnabled(enabled);
+		ImGui::SameLine();
+		ImGui::Checkbox("Pause", &paused);
+		ImGui::SameLine();
+		if (IsCapturing())
+			ImGui::Text("capturing, %u frames left", captureFramesLeft);
+		else if (ImGui::Button("Capture 120 frames"))
+			BeginCapture(120, "profile.json");
+
+		const f64 frameNs = lastFrameEnd > lastFrameStart ? (f64)(lastFrameEnd - lastFrameStart) : 1.0;
+		ImGui::Text("last frame %.3f ms, %u zones", frameNs / 1e6, (u32)lastFrame.size());
+
+		//flat view, total time per zone name
+		if (ImGui::CollapsingHeader("Top zones", ImGuiTreeNodeFlags_DefaultOpen))
+		{
+			struct Total
+			{
+				const char* name;
+				u64 ns;
+				u32 calls;
+			};
+			Total totals[64];
+			u32 totalCount = 0;
+			for (const ProfileEvent& event : lastFrame)
+			{
+				u32 t = 0;
+				while (t < totalCount && totals[t].name != event.name) t++;
+				if (t == totalCount)
+				{
+					if (totalCount == 64) continue;
+					totals[totalCount++] = Total{ event.name, 0, 0 };
+				}
+				totals[t].ns += event.end - event.start;
+				totals[t].calls++;
+			}
+			std::sort(totals, totals + totalCount, [](const Total& a, const Total& b) { return a.ns > b.ns; });
+			for (u32 t = 0; t < totalCount && t < 16; t++)
+				ImGui::Text("%8.3f ms  %5u  %s", totals[t].ns / 1e6, totals[t].calls, totals[t].name);
+		}
+
+		//hierarchy per thread
+		u32 begin = 0;
+		while (begin < lastFrame.size())
+		{
+			const u32 thread = lastFrame[begin].thread;
+			u32 end = begin;
+			while (end < lastFrame.size() && lastFrame[end].thread == thread) end++;
+			char name[sizeof(ProfilerThreadBuffer::name)];
+			{
+				std::lock_guard<std::mutex> lock(registerLock);
+				memcpy(name, threadBuffers[thread]->name, sizeof(name));
+			}
+			if (ImGui::CollapsingHeader(name, thread == 0 ? ImGuiTreeNodeFlags_DefaultOpen : 0))
+			{
+				ImGui::PushID((int)thread);
+				DrawThread(lastFrame.data() + begin, end - begin, frameNs);
+				ImGui::PopID();
+			}
+			begin = end;
+		}
+
+		ImGui::End();
+	}
+}
@@ -0,0 +1,102 @@
+#ifndef WF_PROFILER_H
+#define WF_PROFILER_H
+#include "wf_pch.h"
+#include <atomic>
+
+//CPU zones: WF_PROFILE_SCOPE("name") times the enclosing scope on whatever thread runs it.
+//Each thread writes finished zones to its own ring buffer without locks, Profiler::NewFrame
+//(called by Application::Run) drains the rings once per frame. The last frame is shown by
+//Profiler::DrawImGui and frames can be captured to a Chrome trace / Perfetto json file.
+//Building with WF_NO_PROFILE compiles the macros out, Profiler::SetEnabled(false) turns
+//zones into a single branch at runtime.
+#if !defined(WF_NO_PROFILE) && !defined(WF_PROFILE)
+	#define WF_PROFILE 1
+#endif
+
+#define WF_PROFILE_CONCAT_INNER(a, b) a##b
+#define WF_PROFILE_CONCAT(a, b) WF_PROFILE_CONCAT_INNER(a, b)
+
+#ifdef WF_PROFILE
+//name has to outlive the profiler, use string literals
+#define WF_PROFILE_SCOPE(name) Wolf::ProfileScope WF_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define WF_PROFILE_FUNCTION() WF_PROFILE_SCOPE(__FUNCTION__)
+#define WF_PROFILE_THREAD(name) Wolf::Profiler::SetThreadName(name)
+#else
+#define WF_PROFILE_SCOPE(name) void(0)
+#define WF_PROFILE_FUNCTION() void(0)
+#define WF_PROFILE_THREAD(name) void(0)
+#endif
+
+namespace Wolf
+{
+	struct ProfileEvent
+	{
+		const char* name;
+		//ns since the profiler started
+		u64 start;
+		u64 end;
+		u32 depth;
+		u32 thread;
+	};
+
+	class Profiler
+	{
+	public:
+		//finished zones a thread can buffer between two NewFrame, more are dropped and counted
+		static const u32 EVENTS_PER_THREAD = 64 * 1024;
+		//threads profiled at the same time, the buffer of a thread that exits is reused
+		static const u32 MAX_THREADS = 64;
+		static const u32 FRAME_HISTORY = 256;
+
+		static void SetEnabled(bool enabled) { enabledFlag.store(enabled, std::memory_order_relaxed); }
+		static bool IsEnabled() { return enabledFlag.load(std::memory_order_relaxed); }
+
+		//copied, shown in the ImGui view and the trace
+		static void SetThreadName(const char* name);
+
+		//closes the current frame, call once per frame from the main thread
+		static void NewFrame();
+
+		//records the next frameCount frames and writes them to path when done
+		static void BeginCapture(u32 frameCount, const char* path);
+		static bool IsCapturing();
+
+		//call between ImGui::NewFrame and ImGui::Render
+		static void DrawImGui(bool* open = nullptr);
+
+		static u64 GetDroppedEvents();
+		//threads that started while MAX_THREADS others were alive, their zones are ignored
+		static u32 GetRejectedThreads();
+		//ns, same clock as the event timestamps
+		static u64 Now();
+
+		//used by ProfileScope
+		static u64 BeginZone();
+		static void EndZone(const char* name, u64 start);
+
+	private:
+		static inline std::atomic<bool> enabledFlag{ true };
+	};
+
+	class ProfileScope
+	{
+	public:
+		explicit ProfileScope(const char* a_name)
+			: name(a_name), start(Profiler::IsEnabled() ? Profiler::BeginZone() : 0)
+		{}
+
+		~ProfileScope()
+		{
+			if (start) Profiler::EndZone(name, start);
+		}
+
+		ProfileScope(const ProfileScope&) = delete;
+		ProfileScope& operator=(const ProfileScope&) = delete;
+
+	private:
+		const char* name;
+		u64 start;
+	};
+}
+
+#endif //WF_PROFILER_H
@@ -0,0 +1,90 @@
+#ifndef WF_SIMD_H
+#define WF_SIMD_H
+
+//SIMD backend selection, done at compile time
+//x86_64 always has SSE2 so WF_SIMD_SSE is on for every config we ship
+//WF_SIMD_AVX is only on when the compiler is told to emit AVX (/arch:AVX, -mavx)
+//WF_SIMD_F16C follows the compiler's F16C flag (-mf16c, implied by /arch:AVX2)
+//define WF_SIMD_NONE to force the scalar reference paths
+#if !defined(WF_SIMD_NONE) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+	#define WF_SIMD_SSE 1
+	#include <emmintrin.h>
+	#if defined(__AVX__)
+		#define WF_SIMD_AVX 1
+		#include <immintrin.h>
+	#endif
+	#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+		#define WF_SIMD_F16C 1
+		#include <immintrin.h>
+	#endif
+#endif
+
+#ifdef WF_SIMD_SSE
+
+#define WF_SHUFFLE_MASK(x, y, z, w) ((x) | ((y) << 2) | ((z) << 4) | ((w) << 6))
+#define WF_SWIZZLE(v, x, y, z, w) _mm_shuffle_ps((v), (v), WF_SHUFFLE_MASK(x, y, z, w))
+#define WF_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps((a), (b), WF_SHUFFLE_MASK(x, y, z, w))
+
+namespace Wolf
+{
+	namespace Simd
+	{
+		//horizontal add of the 4 lanes, result splatted in every lane
+		inline __m128 hsum(__m128 v)
+		{
+			v = _mm_add_ps(v, WF_SWIZZLE(v, 2, 3, 0, 1));
+			return _mm_add_ps(v, WF_SWIZZLE(v, 1, 0, 3, 2));
+		}
+
+		//xyz cross product, w ends up 0
+		inline __m128 cross(__m128 a, __m128 b)
+		{
+			return _mm_sub_ps(_mm_mul_ps(WF_SWIZZLE(a, 1, 2, 0, 3), WF_SWIZZLE(b, 2, 0, 1, 3)),
+				_mm_mul_ps(WF_SWIZZLE(a, 2, 0, 1, 3), WF_SWIZZLE(b, 1, 2, 0, 3)));
+		}
+
+		//2x2 row major matrices packed as (m00, m01, m10, m11)
+		//A * B
+		inline __m128 mat2Mul(__m128 a, __m128 b)
+		{
+			return _mm_add_ps(_mm_mul_ps(a, WF_SWIZZLE(b, 0, 3, 0, 3)),
+				_mm_mul_ps(WF_SWIZZLE(a, 1, 0, 3, 2), WF_SWIZZLE(b, 2, 1, 2, 1)));
+		}
+
+		//adj(A) * B
+		inline __m128 mat2AdjMul(__m128 a, __m128 b)
+		{
+			return _mm_sub_ps(_mm_mul_ps(WF_SWIZZLE(a, 3, 3, 0, 0), b),
+				_mm_mul_ps(WF_SWIZZLE(a, 1, 1, 2, 2), WF_SWIZZLE(b, 2, 3, 0, 1)));
+		}
+
+		//A * adj(B)
+		inline __m128 mat2MulAdj(__m128 a, __m128 b)
+		{
+			return _mm_sub_ps(_mm_mul_ps(a, WF_SWIZZLE(b, 3, 0, 3, 0)),
+				_mm_mul_ps(WF_SWIZZLE(a, 1, 0, 3, 2), WF_SWIZZLE(b, 2, 1, 2, 1)));
+		}
+
+		//4 packed xyz triples (12 floats, Vec3 arrays) to one register per component
+		inline void loadXYZx4(const f32* p, __m128& x, __m128& y, __m128& z)
+		{
+			const __m128 a = _mm_loadu_ps(p);     //x0 y0 z0 x1
+			const __m128 b = _mm_loadu_ps(p + 4); //y1 z1 x2 y2
+			const __m128 c = _mm_loadu_ps(p + 8); //z2 x3 y3 z3
+			x = WF_SHUFFLE(a, WF_SHUFFLE(b, c, 2, 2, 1, 1), 0, 3, 0, 2);
+			y = WF_SHUFFLE(WF_SHUFFLE(a, b, 1, 1, 0, 0), WF_SHUFFLE(b, c, 3, 3, 2, 2), 0, 2, 0, 2);
+			z = WF_SHUFFLE(WF_SHUFFLE(a, b, 2, 2, 1, 1), c, 0, 2, 0, 3);
+		}
+
+		inline void storeXYZx4(f32* p, __m128 x, __m128 y, __m128 z)
+		{
+			_mm_storeu_ps(p, WF_SHUFFLE(WF_SHUFFLE(x, y, 0, 0, 0, 0), WF_SHUFFLE(z, x, 0, 0, 1, 1), 0, 2, 0, 2));
+			_mm_storeu_ps(p + 4, WF_SHUFFLE(WF_SHUFFLE(y, z, 1, 1, 1, 1), WF_SHUFFLE(x, y, 2, 2, 2, 2), 0, 2, 0, 2));
+			_mm_storeu_ps(p + 8, WF_SHUFFLE(WF_SHUFFLE(z, x, 2, 2, 3, 3), WF_SHUFFLE(y, z, 3, 3, 3, 3), 0, 2, 0, 2));
+		}
+	}
+}
+
+#endif //WF_SIMD_SSE
+
+#endif //WF_SIMD_H
@@ -0,0 +1,374 @@
+#include "wf_pch.h"
+#include "wf_text_parser.h"
+#include <charconv>
+#include <locale.h>
+#if _MSC_VER
+#include <intrin.h>
+#endif
+#if __APPLE__
+#include <xlocale.h>
+#endif
+
+namespace Wolf
+{
+	//every power a double holds exactly
+	static const f64 POWERS_OF_TEN[] =
+	{
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+	};
+	static const u32 MAX_MANTISSA_DIGITS = 19;
+
+	static bool IsDigit(char c)
+	{
+		return (u8)(c - '0') < 10;
+	}
+
+	static bool IsSpace(char c)
+	{
+		return (u8)c <= ' ';
+	}
+
+	static char ToUpper(char c)
+	{
+		return c >= 'a' && c <= 'z' ? (char)(c - ('a' - 'A')) : c;
+	}
+
+	static u32 CountTrailingZeros(u64 value)
+	{
+	#if _MSC_VER
+		unsigned long index;
+		_BitScanForward64(&index, value);
+		return (u32)index;
+	#else
+		return (u32)__builtin_ctzll(value);
+	#endif
+	}
+
+	//end of the token starting at p, tokens are short so this takes 8 bytes a step: the
+	//subtraction flags the bytes below '!' exactly up to the first one (later ones can be
+	//flagged by the borrow, only the first counts). Little endian
+	static size_t FindTokenEnd(const char* text, size_t p, size_t size)
+	{
+		const u64 ones = 0x0101010101010101ull;
+		while (p + 8 <= size)
+		{
+			u64 bytes;
+			memcpy(&bytes, text + p, 8);
+			const u64 spaces = (bytes - ones * '!') & ~bytes & (ones * 0x80);
+			if (spaces) return p + CountTrailingZeros(spaces) / 8;
+			p += 8;
+		}
+		while (p < size && !IsSpace(text[p]))
+			p++;
+		return p;
+	}
+
+	static bool EqualNoCase(const char* a, std::string_view b)
+	{
+		for (size_t i = 0; i < b.size(); i++)
+		{
+			if (ToUpper(a[i]) != ToUpper(b[i])) return false;
+		}
+		return true;
+	}
+
+	//strtod in the C locale: ±inf on overflow, the rounded subnormal or 0 on underflow
+	static f64 ParseOutOfRange(const char* begin, const char* end)
+	{
+		const std::string text(begin, end);
+	#if _WIN32
+		static const _locale_t c = _create_locale(LC_ALL, "C");
+		return _strtod_l(text.c_str(), nullptr, c);
+	#else
+		static const locale_t c = newlocale(LC_ALL_MASK, "C", (locale_t)0);
+		return strtod_l(text.c_str(), nullptr, c);
+	#endif
+	}
+
+	size_t ParseFloat(const char* begin, const char* end, f64& value)
+	{
+		const char* p = begin;
+		const bool negative = p < end && *p == '-';
+		if (p < end && (*p == '-' || *p == '+')) p++;
+		const char* number = p;
+
+		//up to 19 significant digits fit a u64, the rest only moves the exponent
+		u64 mantissa = 0;
+		s32 exponent = 0;
+		u32 digits = 0;
+		bool truncated = false;
+		bool anyDigit = false;
+		for (; p < end && IsDigit(*p); p++)
+		{
+			anyDigit = true;
+			if (digits < MAX_MANTISSA_DIGITS)
+			{
+				mantissa = mantissa * 10 + (u64)(*p - '0');
+				if (mantissa) digits++;
+			}
+			else
+			{
+				exponent++;
+				truncated |= *p != '0';
+			}
+		}
+		if (p < end && *p == '.')
+		{
+			const char* fraction = p + 1;
+			for (p = fraction; p < end && IsDigit(*p); p++)
+			{
+				if (digits < MAX_MANTISSA_DIGITS)
+				{
+					mantissa = mantissa * 10 + (u64)(*p - '0');
+					exponent--;
+					if (mantissa) digits++;
+				}
+				else truncated |= *p != '0';
+			}
+			anyDigit |= p != fraction;
+		}
+		if (!anyDigit)
+		{
+			//inf and nan
+			const std::from_chars_result result = std::from_chars(number, end, value);
+			if (result.ec != std::errc() || result.ptr == number) return 0;
+			if (negative) value = -value;
+			return (size_t)(result.ptr - begin);
+		}
+
+		if (p < end && (*p == 'e' || *p == 'E'))
+		{
+			const char* q = p + 1;
+			const bool negativeExponent = q < end && *q == '-';
+			if (q < end && (*q == '-' || *q == '+')) q++;
+			if (q < end && IsDigit(*q))
+			{
+				s32 written = 0;
+				for (; q < end && IsDigit(*q); q++)
+				{
+					if (written < 100000) written = written * 10 + (*q - '0');
+				}
+				exponent += negativeExponent ? -written : written;
+				p = q;
+			}
+		}
+
+		//exact operands give the correctly rounded result (Clinger's fast path), which covers
+		//the numbers exporters write. The rest goes through the exact conversion of the library
+		if (!truncated && mantissa <= (1ull << 53) && exponent >= -22 && exponent <= 22)
+		{
+			value = exponent < 0 ? (f64)mantissa / POWERS_OF_TEN[-exponent] : (f64)mantissa * POWERS_OF_TEN[exponent];
+		}
+		else
+		{
+			//from_chars leaves value alone when it doesn't fit, and some libraries refuse
+			//subnormals too. Rare enough to go through strtod for the rounded result
+			const std::from_chars_result result = std::from_chars(number, p, value);
+			if (result.ec == std::errc::result_out_of_range)
+				value = ParseOutOfRange(number, p);
+		}
+		if (negative) value = -value;
+		return (size_t)(p - begin);
+	}
+
+	size_t ParseInt(const char* begin, const char* end, s64& value)
+	{
+		const char* p = begin;
+		const bool negative = p < end && *p == '-';
+		if (p < end && (*p == '-' || *p == '+')) p++;
+		if (p == end || !IsDigit(*p)) return 0;
+
+		//wraps on overflow, like atoi in practice
+		u64 magnitude = 0;
+		for (; p < end && IsDigit(*p); p++)
+			magnitude = magnitude * 10 + (u64)(*p - '0');
+		value = negative ? (s64)(0 - magnitude) : (s64)magnitude;
+		return (size_t)(p - begin);
+	}
+
+	bool TextParser::Open(const char* path)
+	{
+		FileView view;
+		if (!view.Open(path))
+		{
+			Close();
+			return false;
+		}
+		return Open(std::move(view));
+	}
+
+	bool TextParser::Open(FileView&& view)
+	{
+		Close();
+		if (!view.IsOpen()) return false;
+		file = std::move(view);
+		text = (const char*)file.GetData();
+		size = (size_t)file.GetSize();
+		return true;
+	}
+
+	void TextParser::SetText(const char* a_text, size_t length)
+	{
+		Close();
+		text = a_text;
+		size = length;
+	}
+
+	void TextParser::Close()
+	{
+		file.Close();
+		text = nullptr;
+		size = 0;
+		position = 0;
+	}
+
+	std::string_view TextParser::NextToken()
+	{
+		size_t p = position;
+		while (p < size && IsSpace(text[p]))
+			p++;
+		const size_t start = p;
+		p = FindTokenEnd(text, p, size);
+		position = p;
+		return std::string_view(text + start, p - start);
+	}
+
+	std::string_view TextParser::NextQuoted()
+	{
+		const char* open = position < size ? (const char*)memchr(text + position, '"', size - position) : nullptr;
+		if (!open)
+		{
+			position = size;
+			return std::string_view();
+		}
+		const size_t start = (size_t)(open - text) + 1;
+		const char* close = (const char*)memchr(text + start, '"', size - start);
+		const size_t stop = close ? (size_t)(close - text) : size;
+		position = close ? stop + 1 : size;
+		return std::string_view(text + start, stop - start);
+	}
+
+	std::string_view TextParser::NextLine()
+	{
+		const size_t start = position;
+		const char* newline = position < size ? (const char*)memchr(text + position, '\n', size - position) : nullptr;
+		size_t stop = newline ? (size_t)(newline - text) : size;
+		position = newline ? stop + 1 : size;
+		if (stop > start && text[stop - 1] == '\r') stop--;
+		return std::string_view(text + start, stop - start);
+	}
+
+	f64 TextParser::NextDouble()
+	{
+		const std::string_view token = NextToken();
+		f64 value;
+		return ParseFloat(token.data(), token.data() + token.size(), value) ? value : 0.0;
+	}
+
+	s32 TextParser::NextInt()
+	{
+		const std::string_view token = NextToken();
+		s64 value;
+		return ParseInt(token.data(), token.data() + token.size(), value) ? (s32)value : 0;
+	}
+
+	bool TextParser::AtEnd()
+	{
+		while (position < size && IsSpace(text[position]))
+			position++;
+		return position == size;
+	}
+
+	u32 TextParser::CountTokens(std::string_view word, bool fromHere) const
+	{
+		u32 count = 0;
+		CountTokens(&word, 1, &count, fromHere);
+		return count;
+	}
+
+	void TextParser::CountTokens(const std::string_view* words, u32 wordCount, u32* counts, bool fromHere) const
+	{
+		size_t shortest = ~(size_t)0;
+		size_t longest = 0;
+		for (u32 i = 0; i < wordCount; i++)
+		{
+			counts[i] = 0;
+			shortest = words[i].size() < shortest ? words[i].size() : shortest;
+			longest = words[i].size() > longest ? words[i].size() : longest;
+		}
+
+		size_t p = fromHere ? position : 0;
+		while (p < size)
+		{
+			while (p < size && IsSpace(text[p]))
+				p++;
+			const size_t start = p;
+			p = FindTokenEnd(text, p, size);
+			const size_t length = p - start;
+			if (length < shortest || length > longest) continue;
+			for (u32 i = 0; i < wordCount; i++)
+			{
+				if (words[i].size() == length && EqualNoCase(text + start, words[i]))
+				{
+					counts[i]++;
+					break;
+				}
+			}
+		}
+	}
+
+	char* TextParser::ReturnWord(std::string_view word, bool upperCase)
+	{
+		wordBuffer.assign(word.data(), word.size());
+		if (upperCase)
+		{
+			for (char& c : wordBuffer)
+				c = ToUpper(c);
+		}
+		return &wordBuffer[0];
+	}
+
+	char* TextParser::getword()
+	{
+		const std::string_view token = NextToken();
+		return token.empty() ? nullptr : ReturnWord(token, true);
+	}
+
+	char* TextParser::getcommaword()
+	{
+		const std::string_view quoted = NextQuoted();
+		return quoted.data() ? ReturnWord(quoted, false) : nullptr;
+	}
+
+	int TextParser::countchar(char c)
+	{
+		int count = 0;
+		for (const char* p = text; p && p < text + size; p++)
+		{
+			p = (const char*)memchr(p, c, (size_t)(text + size - p));
+			if (!p) break;
+			count++;
+		}
+		return count;
+	}
+
+	void TextParser::goback()
+	{
+		size_t p = position;
+		while (p > 0 && IsSpace(text[p - 1]))
+			p--;
+		while (p > 0 && !IsSpace(text[p - 1]))
+			p--;
+		position = p;
+	}
+
+	void TextParser::seek(const char* token)
+	{
+		const std::string_view wanted(token);
+		for (std::string_view word = NextToken(); !word.empty(); word = NextToken())
+		{
+			if (word.size() == wanted.size() && EqualNoCase(word.data(), wanted)) return;
+		}
+	}
+}
@@ -0,0 +1,90 @@
+#ifndef WF_TEXT_PARSER_H
+#define WF_TEXT_PARSER_H
+#include "wf_pch.h"
+#include "wf_vfs.h"
+#include <string_view>
+
+namespace Wolf
+{
+	//locale free number parsing: reads the longest number at begin like strtod/strtol and returns
+	//how many characters it used, 0 if there's no number there
+	size_t ParseFloat(const char* begin, const char* end, f64& value);
+	size_t ParseInt(const char* begin, const char* end, s64& value);
+
+	//Tokenizer for formatted text files (OBJ, ASE, level files) over a memory mapped file or text
+	//in memory. Tokens are the runs of characters above ' ' and come back as string_views into
+	//the text, nothing is copied. The lowercase functions keep the interface of the old TextParser:
+	//words come back upper cased in a buffer of the parser, valid until its next call.
+	class TextParser
+	{
+	public:
+		TextParser() = default;
+		explicit TextParser(const char* path) { Open(path); }
+
+		TextParser(const TextParser&) = delete;
+		TextParser& operator=(const TextParser&) = delete;
+
+		bool Open(const char* path);
+		//takes the view over, from Vfs::Open or AssetLoadContext::OpenFile
+		bool Open(FileView&& view);
+		//the caller keeps the text alive
+		void SetText(const char* a_text, size_t length);
+		void Close();
+
+		//empty at the end
+		std::string_view NextToken();
+		//the text between the next two double quotes, a null view if there's no quote left
+		std::string_view NextQuoted();
+		//the rest of the line without the line break, for names with spaces
+		std::string_view NextLine();
+		//the next token as a number, 0 if it doesn't start with one
+		f64 NextDouble();
+		f32 NextFloat() { return (f32)NextDouble(); }
+		s32 NextInt();
+		//only whitespace left
+		bool AtEnd();
+
+		size_t GetPosition() const { return position; }
+		void SetPosition(size_t a_position) { position = a_position < size ? a_position : size; }
+		const char* GetText() const { return text; }
+		size_t GetSize() const { return size; }
+
+		//tokens equal to word (ASCII case insensitive)
+		u32 CountTokens(std::string_view word, bool fromHere = false) const;
+		//counts[i] for words[i] in a single pass, enough to size every array of a mesh before parsing it
+		void CountTokens(const std::string_view* words, u32 wordCount, u32* counts, bool fromHere = false) const;
+
+		//old TextParser interface
+		bool create(const char* path) { return Open(path); }
+		//nullptr at the end
+		char* getword();
+		//case kept, nullptr if there's no quote left
+		char* getcommaword();
+		int getint() { return (int)NextInt(); }
+		double getfloat() { return NextDouble(); }
+		//whole words, the old parser also counted the word inside longer ones
+		int countword(const char* word) { return (int)CountTokens(word); }
+		int countwordfromhere(const char* word) { return (int)CountTokens(word, true); }
+		int countchar(char c);
+		void reset() { position = 0; }
+		void destroy() { Close(); }
+		//back to the start of the previous word
+		void goback();
+		//past the next word equal to token, case insensitive
+		void seek(const char* token);
+		int eof() { return AtEnd(); }
+		//*GEOMOBJECT words left in an ASE file, the position doesn't move
+		int CountObjs() { return (int)CountTokens("*GEOMOBJECT", true); }
+
+	private:
+		char* ReturnWord(std::string_view word, bool upperCase);
+
+		FileView file;
+		const char* text = nullptr;
+		size_t size = 0;
+		size_t position = 0;
+		std::string wordBuffer;
+	};
+}
+
+#endif //WF_TEXT_PARSER_H
@@ -0,0 +1,94 @@
+#include "wf_pch.h"
+#include "wf_texture.h"
+#include "wf_debug.h"
+#include "wf_memory.h"
+
+namespace Wolf
+{
+	static void* LoadCookedTexture(AssetLoadContext& context, const char* path)
+	{
+		FileView view;
+		if (!context.OpenFile(path, view))
+		{
+			WF_LOGERROR("CookedTexture: can't open %s", path);
+			return nullptr;
+		}
+		CookedTexture* texture = new CookedTexture();
+		if (!texture->Open(std::move(view), path))
+		{
+			delete texture;
+			return nullptr;
+		}
+		return texture;
+	}
+
+	static void UnloadCookedTexture(void* data)
+	{
+		delete (CookedTexture*)data;
+	}
+
+	const AssetType CookedTexture::ASSET_TYPE = { "texture", LoadCookedTexture, UnloadCookedTexture, nullptr };
+
+	bool CookedTexture::Open(const char* path)
+	{
+		FileView view;
+		if (!view.Open(path))
+		{
+			WF_LOGERROR("CookedTexture: can't map %s", path);
+			return false;
+		}
+		return Open(std::move(view), path);
+	}
+
+	bool CookedTexture::Open(FileView&& view, const char* name)
+	{
+		Close();
+		file = std::move(view);
+		if (!ValidateTextureFile(file.GetData(), file.GetSize()))
+		{
+			WF_LOGERROR("CookedTexture: %s isn't a valid version %u texture, cook it again", name, TEXTURE_FILE_VERSION);
+			file.Close();
+			return false;
+		}
+		header = (const TextureFileHeader*)file.GetData();
+		Memory::Track(MemoryTag::Textures, file.GetSize());
+		return true;
+	}
+
+	void CookedTexture::Close()
+	{
+		if (!header) return;
+		Memory::Untrack(MemoryTag::Textures, file.GetSize());
+		header = nullptr;
+		file.Close();
+	}
+
+	GLuint CookedTexture::CreateGLTexture() const
+	{
+		if (!header) return 0;
+
+		//mips are tightly packed rows of RGBA8
+		GLint previousAlignment;
+		glGetIntegerv(GL_UNPACK_ALIGNMENT, &previousAlignment);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+		GLuint texture;
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		const GLint internalFormat = header->format == TextureFormat::RGBA8_SRGB ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+		for (u32 mip = 0; mip < header->mipCount; mip++)
+		{
+			const TextureMipDesc& desc = header->mips[mip];
+			glTexImage2D(GL_TEXTURE_2D, (GLint)mip, internalFormat, (GLsizei)desc.width, (GLsizei)desc.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, GetMipData(mip));
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)header->mipCount - 1);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, header->mipCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		const GLint wrap = (header->flags & TEXTURE_FLAG_WRAP) ? GL_REPEAT : GL_CLAMP_TO_EDGE;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+
+		glPixelStorei(GL_UNPACK_ALIGNMENT, previousAlignment);
+		return texture;
+	}
+}
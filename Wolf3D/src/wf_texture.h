@@ -0,0 +1,47 @@
+#ifndef WF_TEXTURE_H
+#define WF_TEXTURE_H
+#include "wf_pch.h"
+#include "wf_texture_format.h"
+#include "wf_vfs.h"
+#include "wf_assets.h"
+
+namespace Wolf
+{
+	//A texture cooked by TextureCooker, used straight from the memory mapped file or pack: opening
+	//only checks the header, mips are paged in when they are read or uploaded. No decoding, no copy.
+	class CookedTexture
+	{
+	public:
+		//loads .wtex files through an AssetRegistry, the data is a CookedTexture
+		static const AssetType ASSET_TYPE;
+
+		CookedTexture() = default;
+		~CookedTexture() { Close(); }
+
+		CookedTexture(const CookedTexture&) = delete;
+		CookedTexture& operator=(const CookedTexture&) = delete;
+
+		bool Open(const char* path);
+		//takes the view over, name is for errors
+		bool Open(FileView&& view, const char* name);
+		void Close();
+		bool IsOpen() const { return header != nullptr; }
+
+		TextureFormat GetFormat() const { return header->format; }
+		u32 GetFlags() const { return header->flags; }
+		u32 GetWidth() const { return header->width; }
+		u32 GetHeight() const { return header->height; }
+		u32 GetMipCount() const { return header->mipCount; }
+		const TextureMipDesc& GetMip(u32 mip) const { return header->mips[mip]; }
+		const u8* GetMipData(u32 mip) const { return file.GetData() + header->mips[mip].offset; }
+
+		//creates a GL texture with every mip uploaded from the mapping, needs a current context
+		GLuint CreateGLTexture() const;
+
+	private:
+		FileView file;
+		const TextureFileHeader* header = nullptr;
+	};
+}
+
+#endif //WF_TEXTURE_H
@@ -0,0 +1,91 @@
+#ifndef WF_TEXTURE_FORMAT_H
+#define WF_TEXTURE_FORMAT_H
+#include "wf_pch.h"
+
+//Cooked texture container, written by TextureCooker and used in place by CookedTexture.
+//A TextureFileHeader, then the mips from largest to smallest, each one starting on a
+//TEXTURE_DATA_ALIGNMENT boundary and tightly packed inside. Little endian.
+namespace Wolf
+{
+	static const u32 TEXTURE_FILE_MAGIC = 0x58544657; //"WFTX"
+	static const u32 TEXTURE_FILE_VERSION = 1;
+	static const u32 TEXTURE_MAX_MIPS = 16;
+	//enough for uploads straight from the mapping and for SIMD reads
+	static const u32 TEXTURE_DATA_ALIGNMENT = 256;
+
+	enum class TextureFormat : u32
+	{
+		RGBA8 = 0,
+		//color data, mips were filtered in linear space
+		RGBA8_SRGB = 1,
+	};
+
+	enum TextureFlags : u32
+	{
+		TEXTURE_FLAG_NORMAL_MAP = 1 << 0,
+		//mips were filtered as a tiling texture, sample it with repeat
+		TEXTURE_FLAG_WRAP = 1 << 1,
+	};
+
+	struct TextureMipDesc
+	{
+		//from the start of the file
+		u64 offset;
+		u64 size;
+		u32 width;
+		u32 height;
+	};
+
+	struct TextureFileHeader
+	{
+		u32 magic;
+		u32 version;
+		TextureFormat format;
+		u32 flags;
+		u32 width;
+		u32 height;
+		u32 mipCount;
+		u32 bytesPerPixel;
+		u64 fileSize;
+		u64 reserved;
+		TextureMipDesc mips[TEXTURE_MAX_MIPS];
+	};
+	static_assert(sizeof(TextureFileHeader) == 432, "TextureFileHeader is part of the file format");
+
+	inline u32 GetTextureFormatBytesPerPixel(TextureFormat format)
+	{
+		switch (format)
+		{
+		case TextureFormat::RGBA8:
+		case TextureFormat::RGBA8_SRGB:
+			return 4;
+		}
+		return 0;
+	}
+
+	//everything the runtime relies on, so a truncated or stale file is rejected instead of read out of bounds
+	inline bool ValidateTextureFile(const void* data, u64 size)
+	{
+		if (size < sizeof(TextureFileHeader) || ((uintptr_t)data & 7)) return false;
+		const TextureFileHeader& header = *(const TextureFileHeader*)data;
+		if (header.magic != TEXTURE_FILE_MAGIC || header.version != TEXTURE_FILE_VERSION) return false;
+		if (header.fileSize != size || header.mipCount == 0 || header.mipCount > TEXTURE_MAX_MIPS) return false;
+		if (header.bytesPerPixel == 0 || header.bytesPerPixel != GetTextureFormatBytesPerPixel(header.format)) return false;
+
+		u32 width = header.width;
+		u32 height = header.height;
+		for (u32 i = 0; i < header.mipCount; i++)
+		{
+			const TextureMipDesc& mip = header.mips[i];
+			if (mip.width != width || mip.height != height) return false;
+			if (mip.size != (u64)width * height * header.bytesPerPixel) return false;
+			if (mip.offset % TEXTURE_DATA_ALIGNMENT || mip.offset < sizeof(TextureFileHeader)) return false;
+			if (mip.offset > size || mip.size > size - mip.offset) return false;
+			width = width > 1 ? width / 2 : 1;
+			height = height > 1 ? height / 2 : 1;
+		}
+		return true;
+	}
+}
+
+#endif //WF_TEXTURE_FORMAT_H
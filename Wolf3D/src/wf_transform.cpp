@@ -0,0 +1,356 @@
+#include "wf_pch.h"
+#include "wf_transform.h"
+#include "wf_debug.h"
+#include <algorithm>
+
+namespace Wolf
+{
+	template<typename F>
+	static void ForRange(JobSystem* jobs, u32 count, const F& body)
+	{
+		if (jobs && count >= TransformHierarchy::PARALLEL_GRAIN)
+			jobs->ParallelFor(count, TransformHierarchy::PARALLEL_GRAIN, body);
+		else
+			body(0u, count);
+	}
+
+	template<typename T>
+	static void Permute(std::vector<T>& values, const std::vector<u32>& order)
+	{
+		std::vector<T> permuted(values.size());
+		for (size_t i = 0; i < order.size(); i++)
+			permuted[i] = values[order[i]];
+		values.swap(permuted);
+	}
+
+	TransformId TransformHierarchy::Create(TransformId parent)
+	{
+		u32 index;
+		if (!freeIndices.empty())
+		{
+			index = freeIndices.back();
+			freeIndices.pop_back();
+		}
+		else
+		{
+			index = (u32)records.size();
+			records.push_back(Record{ INVALID, 1, TransformId::Null() });
+		}
+
+		if (!parent.IsNull() && !IsAlive(parent))
+		{
+			WF_LOGERROR("TransformHierarchy::Create: parent is not alive, creating a root");
+			parent = TransformId::Null();
+		}
+
+		Record& record = records[index];
+		record.dense = (u32)handles.size();
+		record.parent = parent;
+
+		positions.push_back(Vec3(0.0f, 0.0f, 0.0f));
+		rotations.push_back(Quaternion(0.0f, 0.0f, 0.0f, 1.0f));
+		scales.push_back(Vec3(1.0f, 1.0f, 1.0f));
+		worlds.push_back(Mat44f());
+		parents.push_back(INVALID);
+		firstChildren.push_back(0);
+		childCounts.push_back(0);
+		levels.push_back(0);
+		dirty.push_back(0);
+		handles.push_back(index);
+
+		structureChanged = true;
+		return TransformId{ index, record.generation };
+	}
+
+	void TransformHierarchy::Destroy(TransformId node)
+	{
+		if (!IsAlive(node)) return;
+
+		//swap with the last dense node, the order is restored by Rebuild
+		Record& record = records[node.index];
+		const u32 dense = record.dense;
+		const u32 last = (u32)handles.size() - 1;
+		if (dense != last)
+		{
+			positions[dense] = positions[last];
+			rotations[dense] = rotations[last];
+			scales[dense] = scales[last];
+			worlds[dense] = worlds[last];
+			handles[dense] = handles[last];
+			records[handles[dense]].dense = dense;
+		}
+		positions.pop_back();
+		rotations.pop_back();
+		scales.pop_back();
+		worlds.pop_back();
+		parents.pop_back();
+		firstChildren.pop_back();
+		childCounts.pop_back();
+		levels.pop_back();
+		dirty.pop_back();
+		handles.pop_back();
+
+		record.dense = INVALID;
+		record.parent = TransformId::Null();
+		//generation 0 is reserved for TransformId::Null()
+		record.generation = record.generation + 1 ? record.generation + 1 : 1;
+		freeIndices.push_back(node.index);
+		structureChanged = true;
+	}
+
+	bool TransformHierarchy::IsAlive(TransformId node) const
+	{
+		return node.index < records.size() && records[node.index].generation == node.generation && records[node.index].dense != INVALID;
+	}
+
+	bool TransformHierarchy::IsAncestor(TransformId ancestor, TransformId node) const
+	{
+		TransformId current = records[node.index].parent;
+		while (IsAlive(current))
+		{
+			if (current == ancestor) return true;
+			current = records[current.index].parent;
+		}
+		return false;
+	}
+
+	bool TransformHierarchy::SetParent(TransformId node, TransformId parent)
+	{
+		if (!IsAlive(node)) return false;
+		if (!parent.IsNull() && (!IsAlive(parent) || parent == node || IsAncestor(node, parent)))
+			return false;
+
+		records[node.index].parent = parent;
+		structureChanged = true;
+		return true;
+	}
+
+	TransformId TransformHierarchy::GetParent(TransformId node) const
+	{
+		if (!IsAlive(node)) return TransformId::Null();
+		const TransformId parent = records[node.index].parent;
+		return IsAlive(parent) ? parent : TransformId::Null();
+	}
+
+	void TransformHierarchy::MarkDirty(u32 dense)
+	{
+		//everything is recomputed after a rebuild anyway
+		if (structureChanged || dirty[dense]) return;
+		dirty[dense] = 1;
+		dirtyLevels[levels[dense]].push_back(dense);
+	}
+
+	void TransformHierarchy::SetLocalPosition(TransformId node, const Vec3& position)
+	{
+		if (!IsAlive(node)) return;
+		const u32 dense = records[node.index].dense;
+		positions[dense] = position;
+		MarkDirty(dense);
+	}
+
+	void TransformHierarchy::SetLocalRotation(TransformId node, const Quaternion& rotation)
+	{
+		if (!IsAlive(node)) return;
+		const u32 dense = records[node.index].dense;
+		rotations[dense] = rotation;
+		MarkDirty(dense);
+	}
+
+	void TransformHierarchy::SetLocalScale(TransformId node, const Vec3& scale)
+	{
+		if (!IsAlive(node)) return;
+		const u32 dense = records[node.index].dense;
+		scales[dense] = scale;
+		MarkDirty(dense);
+	}
+
+	void TransformHierarchy::SetLocal(TransformId node, const Vec3& position, const Quaternion& rotation, const Vec3& scale)
+	{
+		if (!IsAlive(node)) return;
+		const u32 dense = records[node.index].dense;
+		positions[dense] = position;
+		rotations[dense] = rotation;
+		scales[dense] = scale;
+		MarkDirty(dense);
+	}
+
+	void TransformHierarchy::ComputeWorld(u32 dense)
+	{
+		//scale * rotation * translation with row vectors, the rotation rows are the quaternion axes
+		const Quaternion& rotation = rotations[dense];
+		const Vec3& scale = scales[dense];
+		const Vec3 right = rotation.right() * scale.x;
+		const Vec3 up = rotation.up() * scale.y;
+		const Vec3 forward = rotation.forward() * scale.z;
+		const Vec3& position = positions[dense];
+
+		Mat44f local;
+		local.m[0][0] = right.x; local.m[0][1] = right.y; local.m[0][2] = right.z;
+		local.m[1][0] = up.x; local.m[1][1] = up.y; local.m[1][2] = up.z;
+		local.m[2][0] = forward.x; local.m[2][1] = forward.y; local.m[2][2] = forward.z;
+		local.m[3][0] = position.x; local.m[3][1] = position.y; local.m[3][2] = position.z;
+
+		const u32 parent = parents[dense];
+		worlds[dense] = parent == INVALID ? local : local * worlds[parent];
+	}
+
+	void TransformHierarchy::Rebuild()
+	{
+		const u32 count = (u32)handles.size();
+
+		//parent of every node in the current dense order, dead parents make roots
+		for (u32 i = 0; i < count; i++)
+		{
+			const TransformId parent = records[handles[i]].parent;
+			parents[i] = IsAlive(parent) ? records[parent.index].dense : INVALID;
+		}
+
+		//children of every node, counting sort by parent
+		childStarts.assign(count + 1, 0);
+		for (u32 i = 0; i < count; i++)
+			if (parents[i] != INVALID) childStarts[parents[i] + 1]++;
+		for (u32 i = 0; i < count; i++)
+			childStarts[i + 1] += childStarts[i];
+		remap.assign(childStarts.begin(), childStarts.end() - 1);
+		childList.resize(count);
+		for (u32 i = 0; i < count; i++)
+			if (parents[i] != INVALID) childList[remap[parents[i]]++] = i;
+
+		//breadth first from the roots, each node's children end up contiguous in the next level
+		order.clear();
+		for (u32 i = 0; i < count; i++)
+			if (parents[i] == INVALID) order.push_back(i);
+
+		levelStarts.clear();
+		levelStarts.push_back(0);
+		u32 levelEnd = (u32)order.size();
+		u16 level = 0;
+		for (u32 head = 0; head < order.size(); head++)
+		{
+			if (head == levelEnd)
+			{
+				levelStarts.push_back(head);
+				levelEnd = (u32)order.size();
+				level++;
+			}
+			const u32 node = order[head];
+			firstChildren[head] = (u32)order.size();
+			childCounts[head] = childStarts[node + 1] - childStarts[node];
+			levels[head] = level;
+			order.insert(order.end(), childList.begin() + childStarts[node], childList.begin() + childStarts[node + 1]);
+		}
+		levelStarts.push_back((u32)order.size());
+		levelCount = count ? (u32)levelStarts.size() - 1 : 0;
+
+		//nodes are never their own ancestor so every node is reached
+		if (order.size() != count)
+			WF_LOGERROR("TransformHierarchy: %u of %u nodes unreachable from a root", count - (u32)order.size(), count);
+
+		remap.resize(count);
+		for (u32 i = 0; i < count; i++)
+			remap[order[i]] = i;
+		for (u32 i = 0; i < count; i++)
+			childList[remap[i]] = parents[i] == INVALID ? INVALID : remap[parents[i]];
+		parents.swap(childList);
+
+		Permute(positions, order);
+		Permute(rotations, order);
+		Permute(scales, order);
+		Permute(handles, order);
+		for (u32 i = 0; i < count; i++)
+			records[handles[i]].dense = i;
+
+		std::fill(dirty.begin(), dirty.end(), 0);
+		dirtyLevels.resize(levelCount);
+		for (std::vector<u32>& list : dirtyLevels)
+			list.clear();
+	}
+
+	void TransformHierarchy::UpdateLevels(JobSystem* jobs)
+	{
+		if (structureChanged)
+		{
+			Rebuild();
+			structureChanged = false;
+			for (u32 level = 0; level < levelCount; level++)
+			{
+				const u32 start = levelStarts[level];
+				ForRange(jobs, levelStarts[level + 1] - start, [this, start](u32 begin, u32 end)
+				{
+					for (u32 i = begin; i < end; i++)
+						ComputeWorld(start + i);
+				});
+			}
+			lastUpdateCount = GetCount();
+			return;
+		}
+
+		u32 updated = 0;
+		for (u32 level = 0; level < levelCount; level++)
+		{
+			std::vector<u32>& list = dirtyLevels[level];
+			if (list.empty()) continue;
+
+			//lists are in marking order, when a good part of the level is dirty sweeping the
+			//whole level in memory order beats jumping around the arrays
+			const u32 start = levelStarts[level];
+			const u32 levelSize = levelStarts[level + 1] - start;
+			const bool sweep = list.size() * 4 >= levelSize;
+			if (sweep)
+			{
+				ForRange(jobs, levelSize, [this, start](u32 begin, u32 end)
+				{
+					for (u32 i = start + begin; i < start + end; i++)
+						if (dirty[i]) ComputeWorld(i);
+				});
+			}
+			else
+			{
+				const u32* nodes = list.data();
+				ForRange(jobs, (u32)list.size(), [this, nodes](u32 begin, u32 end)
+				{
+					for (u32 i = begin; i < end; i++)
+						ComputeWorld(nodes[i]);
+				});
+			}
+			updated += (u32)list.size();
+
+			//the whole subtree of a changed node has to follow it
+			std::vector<u32>* next = level + 1 < levelCount ? &dirtyLevels[level + 1] : nullptr;
+			auto propagate = [this, next](u32 node)
+			{
+				dirty[node] = 0;
+				if (!next) return;
+				const u32 end = firstChildren[node] + childCounts[node];
+				for (u32 child = firstChildren[node]; child < end; child++)
+				{
+					if (dirty[child]) continue;
+					dirty[child] = 1;
+					next->push_back(child);
+				}
+			};
+			if (sweep)
+			{
+				for (u32 i = start; i < start + levelSize; i++)
+					if (dirty[i]) propagate(i);
+			}
+			else
+			{
+				for (u32 node : list)
+					propagate(node);
+			}
+			list.clear();
+		}
+		lastUpdateCount = updated;
+	}
+
+	void TransformHierarchy::Update()
+	{
+		UpdateLevels(nullptr);
+	}
+
+	void TransformHierarchy::Update(JobSystem& jobs)
+	{
+		UpdateLevels(&jobs);
+	}
+}
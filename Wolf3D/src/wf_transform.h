@@ -0,0 +1,108 @@
+#ifndef WF_TRANSFORM_H
+#define WF_TRANSFORM_H
+#include "wf_pch.h"
+#include "wf_math.h"
+#include "wf_jobs.h"
+#include <vector>
+
+//Parent/child transforms stored in flat arrays sorted breadth first: roots come first, then
+//every level after the previous one, and the children of a node are contiguous in the next level.
+//World matrices are only recomputed for nodes whose local transform changed and their subtrees,
+//one level at a time so a level can be spread over the job system. Static nodes cost nothing.
+//Creating, destroying or reparenting re-sorts the arrays on the next Update, keep those out of hot loops.
+namespace Wolf
+{
+	struct TransformId
+	{
+		u32 index;
+		u32 generation;
+
+		bool operator==(const TransformId& other) const { return index == other.index && generation == other.generation; }
+		bool operator!=(const TransformId& other) const { return !(*this == other); }
+		bool IsNull() const { return generation == 0; }
+		static constexpr TransformId Null() { return TransformId{ 0, 0 }; }
+	};
+
+	class TransformHierarchy
+	{
+	public:
+		//levels with fewer dirty nodes than this are updated on the calling thread
+		static const u32 PARALLEL_GRAIN = 256;
+
+		TransformId Create(TransformId parent = TransformId::Null());
+		//children become roots and keep their local transform as their world transform
+		void Destroy(TransformId node);
+		bool IsAlive(TransformId node) const;
+
+		//false if parent is node itself or one of its descendants, Null() makes it a root
+		bool SetParent(TransformId node, TransformId parent);
+		TransformId GetParent(TransformId node) const;
+
+		void SetLocalPosition(TransformId node, const Vec3& position);
+		void SetLocalRotation(TransformId node, const Quaternion& rotation);
+		void SetLocalScale(TransformId node, const Vec3& scale);
+		void SetLocal(TransformId node, const Vec3& position, const Quaternion& rotation, const Vec3& scale);
+
+		const Vec3& GetLocalPosition(TransformId node) const { return positions[records[node.index].dense]; }
+		const Quaternion& GetLocalRotation(TransformId node) const { return rotations[records[node.index].dense]; }
+		const Vec3& GetLocalScale(TransformId node) const { return scales[records[node.index].dense]; }
+		//as of the last Update
+		const Mat44f& GetWorldMatrix(TransformId node) const { return worlds[records[node.index].dense]; }
+
+		//recomputes the world matrices of dirty subtrees, level by level
+		void Update();
+		void Update(JobSystem& jobs);
+
+		u32 GetCount() const { return (u32)handles.size(); }
+		u32 GetLevelCount() const { return levelCount; }
+		//world matrices recomputed by the last Update
+		u32 GetLastUpdateCount() const { return lastUpdateCount; }
+
+	private:
+		static constexpr u32 INVALID = 0xFFFFFFFF;
+
+		struct Record
+		{
+			u32 dense;
+			u32 generation;
+			TransformId parent;
+		};
+
+		void UpdateLevels(JobSystem* jobs);
+		void Rebuild();
+		void MarkDirty(u32 dense);
+		void ComputeWorld(u32 dense);
+		bool IsAncestor(TransformId ancestor, TransformId node) const;
+
+		std::vector<Record> records;
+		std::vector<u32> freeIndices;
+
+		//dense arrays in breadth first order once rebuilt, new nodes are appended until then
+		std::vector<Vec3> positions;
+		std::vector<Quaternion> rotations;
+		std::vector<Vec3> scales;
+		std::vector<Mat44f> worlds;
+		std::vector<u32> parents;
+		std::vector<u32> firstChildren;
+		std::vector<u32> childCounts;
+		std::vector<u16> levels;
+		std::vector<u8> dirty;
+		//record index of each dense node
+		std::vector<u32> handles;
+
+		//dirty nodes of each level, children are added while the level above is processed
+		std::vector<std::vector<u32>> dirtyLevels;
+		std::vector<u32> levelStarts;
+		u32 levelCount = 0;
+		u32 lastUpdateCount = 0;
+		bool structureChanged = false;
+
+		//reused by Rebuild
+		std::vector<u32> order;
+		std::vector<u32> remap;
+		std::vector<u32> childStarts;
+		std::vector<u32> childList;
+	};
+}
+
+#endif //WF_TRANSFORM_H
@@ -0,0 +1,274 @@
+#include "wf_pch.h"
+#include "wf_vfs.h"
+#include "wf_debug.h"
+#include <algorithm>
+#include <filesystem>
+
+namespace Wolf
+{
+	FileView::FileView(FileView&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	FileView& FileView::operator=(FileView&& other) noexcept
+	{
+		if (this == &other) return *this;
+		file = std::move(other.file);
+		data = other.data;
+		size = other.size;
+		open = other.open;
+		other.data = nullptr;
+		other.size = 0;
+		other.open = false;
+		return *this;
+	}
+
+	bool FileView::Open(const char* path)
+	{
+		Close();
+		if (file.Open(path))
+		{
+			data = file.GetData();
+			size = file.GetSize();
+			open = true;
+			return true;
+		}
+
+		//empty files can't be mapped
+		std::error_code error;
+		if (std::filesystem::is_regular_file(path, error) && std::filesystem::file_size(path, error) == 0 && !error)
+		{
+			open = true;
+			return true;
+		}
+		return false;
+	}
+
+	void FileView::Close()
+	{
+		file.Close();
+		data = nullptr;
+		size = 0;
+		open = false;
+	}
+
+	std::string Vfs::NormalizePath(const char* path)
+	{
+		std::string generic = path;
+		std::replace(generic.begin(), generic.end(), '\\', '/');
+		std::string normalized = std::filesystem::path(generic).lexically_normal().generic_string();
+		if (normalized == ".") normalized.clear();
+		return normalized;
+	}
+
+	bool Vfs::IsAboveRoot(const std::string& normalized)
+	{
+		//lexically_normal leaves .. only at the start
+		return normalized.compare(0, 2, "..") == 0 && (normalized.size() == 2 || normalized[2] == '/');
+	}
+
+	bool Vfs::AddMount(const char* mountPoint, Mount*& mount)
+	{
+		if (mountCount == MAX_MOUNTS)
+		{
+			WF_LOGERROR("Vfs: more than %u mounts", MAX_MOUNTS);
+			return false;
+		}
+		mount = &mounts[mountCount];
+		mount->mountPoint = NormalizePath(mountPoint);
+		while (!mount->mountPoint.empty() && mount->mountPoint.back() == '/')
+			mount->mountPoint.pop_back();
+		return true;
+	}
+
+	bool Vfs::MountDirectory(const char* directory, const char* mountPoint)
+	{
+		std::error_code error;
+		if (!std::filesystem::is_directory(directory, error))
+		{
+			WF_LOGERROR("Vfs: %s isn't a directory", directory);
+			return false;
+		}
+		Mount* mount;
+		if (!AddMount(mountPoint, mount)) return false;
+		mount->directory = NormalizePath(directory);
+		if (mount->directory.empty()) mount->directory = ".";
+		mountCount++;
+		return true;
+	}
+
+	Vfs::PackMapping* Vfs::MapPack(const char* path)
+	{
+		std::unique_ptr<PackMapping> pack(new PackMapping());
+		if (!pack->file.Open(path))
+		{
+			WF_LOGERROR("Vfs: can't map %s", path);
+			return nullptr;
+		}
+		if (!ValidatePackFile(pack->file.GetData(), pack->file.GetSize()))
+		{
+			WF_LOGERROR("Vfs: %s isn't a valid version %u pack, build it again", path, PACK_FILE_VERSION);
+			return nullptr;
+		}
+
+		const u8* data = pack->file.GetData();
+		const PackFileHeader& header = *(const PackFileHeader*)data;
+		pack->entries = (const PackEntry*)(data + sizeof(PackFileHeader));
+		pack->names = (const char*)data + header.namesOffset;
+		pack->entryCount = header.entryCount;
+		return pack.release();
+	}
+
+	bool Vfs::MountPack(const char* path, const char* mountPoint)
+	{
+		Mount* mount;
+		if (!AddMount(mountPoint, mount)) return false;
+		PackMapping* pack = MapPack(path);
+		if (!pack) return false;
+
+		std::lock_guard<std::mutex> guard(remapLock);
+		packMappings.emplace_back(pack);
+		mount->pack.store(pack, std::memory_order_release);
+		mount->packPath = path;
+		mount->directory.clear();
+		mountCount++;
+		return true;
+	}
+
+	bool Vfs::RemapPack(const char* path)
+	{
+		std::lock_guard<std::mutex> guard(remapLock);
+		std::error_code error;
+		bool remapped = false;
+		for (u32 i = 0; i < mountCount; i++)
+		{
+			Mount& mount = mounts[i];
+			if (!mount.pack.load(std::memory_order_relaxed) || !std::filesystem::equivalent(mount.packPath, path, error)) continue;
+
+			//the old mapping still shows the replaced file, loaders may hold views into it
+			PackMapping* pack = MapPack(mount.packPath.c_str());
+			if (!pack) continue;
+			packMappings.emplace_back(pack);
+			mount.pack.store(pack, std::memory_order_release);
+			remapped = true;
+		}
+		return remapped;
+	}
+
+	void Vfs::UnmountAll()
+	{
+		std::lock_guard<std::mutex> guard(remapLock);
+		for (u32 i = 0; i < mountCount; i++)
+		{
+			mounts[i].mountPoint.clear();
+			mounts[i].directory.clear();
+			mounts[i].packPath.clear();
+			mounts[i].pack.store(nullptr, std::memory_order_relaxed);
+		}
+		mountCount = 0;
+		packMappings.clear();
+	}
+
+	const char* Vfs::GetLocalPath(const Mount& mount, const std::string& path)
+	{
+		//absolute paths are never inside a mount
+		if (!path.empty() && (path[0] == '/' || (path.size() > 1 && path[1] == ':'))) return nullptr;
+		const size_t length = mount.mountPoint.size();
+		if (length == 0) return path.c_str();
+		if (path.compare(0, length, mount.mountPoint) != 0) return nullptr;
+		if (path.size() == length) return path.c_str() + length;
+		if (path[length] != '/') return nullptr;
+		return path.c_str() + length + 1;
+	}
+
+	const PackEntry* Vfs::FindEntry(const PackMapping& pack, const char* localPath)
+	{
+		const size_t length = strlen(localPath);
+		const u64 hash = HashPackPath(localPath, length);
+		const PackEntry* end = pack.entries + pack.entryCount;
+		const PackEntry* entry = std::lower_bound(pack.entries, end, hash, [](const PackEntry& a, u64 b) { return a.hash < b; });
+		for (; entry != end && entry->hash == hash; entry++)
+		{
+			if (entry->nameLength == length && memcmp(pack.names + entry->nameOffset, localPath, length) == 0)
+				return entry;
+		}
+		return nullptr;
+	}
+
+	bool Vfs::Open(const char* a_path, FileView& view) const
+	{
+		view.Close();
+		const std::string path = NormalizePath(a_path);
+		if (IsAboveRoot(path))
+		{
+			WF_LOGERROR("Vfs: %s is above the root", a_path);
+			return false;
+		}
+		for (u32 i = mountCount; i-- > 0;)
+		{
+			const Mount& mount = mounts[i];
+			const char* localPath = GetLocalPath(mount, path);
+			if (!localPath) continue;
+
+			if (const PackMapping* pack = mount.pack.load(std::memory_order_acquire))
+			{
+				const PackEntry* entry = FindEntry(*pack, localPath);
+				if (!entry) continue;
+				view.data = pack->file.GetData() + entry->offset;
+				view.size = entry->size;
+				view.open = true;
+				return true;
+			}
+			if (view.Open((mount.directory + "/" + localPath).c_str())) return true;
+		}
+		//loose file outside of the mounts
+		return view.Open(path.c_str());
+	}
+
+	bool Vfs::Exists(const char* a_path) const
+	{
+		const std::string path = NormalizePath(a_path);
+		if (IsAboveRoot(path)) return false;
+		std::error_code error;
+		for (u32 i = mountCount; i-- > 0;)
+		{
+			const Mount& mount = mounts[i];
+			const char* localPath = GetLocalPath(mount, path);
+			if (!localPath) continue;
+
+			if (const PackMapping* pack = mount.pack.load(std::memory_order_acquire))
+			{
+				if (FindEntry(*pack, localPath)) return true;
+			}
+			else if (std::filesystem::is_regular_file(mount.directory + "/" + localPath, error)) return true;
+		}
+		return std::filesystem::is_regular_file(path, error);
+	}
+
+	std::string Vfs::Resolve(const char* a_path) const
+	{
+		const std::string path = NormalizePath(a_path);
+		if (IsAboveRoot(path)) return path;
+		std::error_code error;
+		const Mount* newestDirectory = nullptr;
+		for (u32 i = mountCount; i-- > 0;)
+		{
+			const Mount& mount = mounts[i];
+			const char* localPath = GetLocalPath(mount, path);
+			if (!localPath) continue;
+
+			if (const PackMapping* pack = mount.pack.load(std::memory_order_acquire))
+			{
+				//the whole pack is watched, RemapPack picks up the new file before reloading
+				if (FindEntry(*pack, localPath)) return mount.packPath;
+				continue;
+			}
+			const std::string loose = mount.directory + "/" + localPath;
+			if (std::filesystem::is_regular_file(loose, error)) return loose;
+			if (!newestDirectory) newestDirectory = &mount;
+		}
+		if (!newestDirectory || std::filesystem::is_regular_file(path, error)) return path;
+		return newestDirectory->directory + "/" + GetLocalPath(*newestDirectory, path);
+	}
+}
@@ -0,0 +1,112 @@
+#ifndef WF_VFS_H
+#define WF_VFS_H
+#include "wf_pch.h"
+#include "wf_mapped_file.h"
+#include "wf_pack_format.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Wolf
+{
+	//Read only bytes of one file, nothing is copied: a view into a mounted pack (valid while the
+	//pack stays mounted) or a loose file mapped for this view.
+	class FileView
+	{
+	public:
+		FileView() = default;
+
+		FileView(const FileView&) = delete;
+		FileView& operator=(const FileView&) = delete;
+		FileView(FileView&& other) noexcept;
+		FileView& operator=(FileView&& other) noexcept;
+
+		//maps a loose file, an empty file gives an open view of size 0
+		bool Open(const char* path);
+		void Close();
+
+		bool IsOpen() const { return open; }
+		const u8* GetData() const { return data; }
+		u64 GetSize() const { return size; }
+
+	private:
+		friend class Vfs;
+
+		const u8* data = nullptr;
+		u64 size = 0;
+		bool open = false;
+		MappedFile file;
+	};
+
+	//Virtual file system: directories and pack archives mounted under a path prefix, searched
+	//newest mount first, so a directory mounted after the shipping packs overrides them with loose
+	//files during development. Paths are relative and '/' separated, paths climbing above the
+	//root with .. are refused. A path no mount has is opened as a plain OS path, with nothing
+	//mounted the Vfs reads loose files like fopen would. Mount before loading anything, opening
+	//is thread safe.
+	class Vfs
+	{
+	public:
+		static const u32 MAX_MOUNTS = 16;
+
+		Vfs() = default;
+
+		Vfs(const Vfs&) = delete;
+		Vfs& operator=(const Vfs&) = delete;
+
+		//mountPoint prefixes the paths inside, "" mounts at the root
+		bool MountDirectory(const char* directory, const char* mountPoint = "");
+		bool MountPack(const char* path, const char* mountPoint = "");
+		//views into the packs become invalid
+		void UnmountAll();
+		//maps a mounted pack again after its file was replaced (hot reload), opening and RemapPack
+		//can run at the same time. Views into the old mapping stay valid until UnmountAll.
+		//false if path isn't a mounted pack or the new file isn't a valid pack
+		bool RemapPack(const char* path);
+		u32 GetMountCount() const { return mountCount; }
+
+		bool Open(const char* path, FileView& view) const;
+		bool Exists(const char* path) const;
+		//the OS file behind a path: the loose file or the pack that has it, otherwise where the
+		//file would be created in the newest directory mount. Used to follow files for hot reload
+		std::string Resolve(const char* path) const;
+
+		//no . or .. (but the leading .. of a path climbing above the root), forward slashes, no leading ./
+		static std::string NormalizePath(const char* path);
+
+	private:
+		struct PackMapping
+		{
+			MappedFile file;
+			const PackEntry* entries = nullptr;
+			const char* names = nullptr;
+			u32 entryCount = 0;
+		};
+
+		struct Mount
+		{
+			std::string mountPoint;
+			//empty for packs
+			std::string directory;
+			std::string packPath;
+			//nullptr for directories, RemapPack swaps it
+			std::atomic<const PackMapping*> pack{ nullptr };
+		};
+
+		static bool IsAboveRoot(const std::string& normalized);
+		bool AddMount(const char* mountPoint, Mount*& mount);
+		static PackMapping* MapPack(const char* path);
+		//the path inside the mount, nullptr if the mount point doesn't match
+		static const char* GetLocalPath(const Mount& mount, const std::string& path);
+		static const PackEntry* FindEntry(const PackMapping& pack, const char* localPath);
+
+		Mount mounts[MAX_MOUNTS];
+		u32 mountCount = 0;
+		//every mapping of every mounted pack, replaced ones included
+		std::vector<std::unique_ptr<PackMapping>> packMappings;
+		std::mutex remapLock;
+	};
+}
+
+#endif //WF_VFS_H
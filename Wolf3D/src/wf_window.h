@@ -11,18 +11,23 @@ namespace Wolf
 		unsigned int width;
 		unsigned int height;
 		unsigned int flags;
+		//set by OnUpdate when the user or the OS asks the window to close
+		bool closeRequested = false;
 
 		Window(std::string a_title, unsigned int a_width, unsigned int a_height, unsigned int a_flags)
 			: title(a_title), width(a_width), height(a_height), flags(a_flags)
 		{}
 
 		virtual ~Window() = default;
+		//pumps the platform events, called once per frame by Application::Run
 		virtual void OnUpdate() = 0;
 
 		// Window attributes
 		virtual void SetVSync(bool enabled) = 0;
 		virtual bool IsVSync() const = 0;
 		virtual void* GetNativeWindowPtr() const = 0;
+		//no display, GL or ImGui behind it (HeadlessWindow)
+		virtual bool IsHeadless() const { return false; }
 	};
 }
 
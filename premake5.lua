@@ -1,4 +1,10 @@
 #!lua
+newoption
+{
+   trigger = "headless",
+   description = "Build Sample without SDL2, GL and ImGui backends, it can only run --headless"
+}
+
 workspace "Wolf3D"
 	architecture "x86_64"
    startproject "Sample"
@@ -26,7 +32,7 @@ project "Wolf3D"
    location "Wolf3D"
    kind "StaticLib"
    language "C++"
-   cppdialect "C++11"
+   cppdialect "C++17"
    staticruntime "on"
 
    targetdir ("bin/" .. outputdir .. "/%{prj.name}")
@@ -53,10 +59,15 @@ project "Wolf3D"
    {
       "ImGui",
       "Glad",
-      "SDL2",
-      "SDL2Main",
    }
 
+   filter "not options:headless"
+      links
+      {
+         "SDL2",
+         "SDL2Main",
+      }
+
    filter "system:windows"
       systemversion "latest"
       libdirs 
@@ -79,7 +90,7 @@ project "Sample"
    location "Sample"
    kind "ConsoleApp"
    language "C++"
-   cppdialect "C++11"
+   cppdialect "C++17"
    staticruntime "on"
 
    targetdir ("bin/" .. outputdir .. "/%{prj.name}")
@@ -114,11 +125,9 @@ project "Sample"
       links
       {
          "Wolf3D",
-         "SDL2",
-         "SDL2main",
-         "Glad",
          "ImGui",
-         "dl"
+         "dl",
+         "pthread"
       }
    filter "system:macosx"
       libdirs 
@@ -128,11 +137,335 @@ project "Sample"
       links
       {
          "Wolf3D",
+         "ImGui",
+         "dl" --TODO: CHECK IF I NEED THIS-- 
+      }
+
+   -- the windowing stack, a headless build only simulates so it links none of it
+   filter { "system:linux or macosx", "not options:headless" }
+      links
+      {
          "SDL2",
          "SDL2main",
          "Glad",
+      }
+
+   filter "options:headless"
+      defines "WF_HEADLESS"
+
+   filter "configurations:Debug"
+      defines "WF_DEBUG"
+      runtime "Debug"
+      symbols "on"
+
+   filter "configurations:Release"
+      defines "WF_RELEASE"
+      runtime "Release"
+      optimize "on"
+
+
+project "MathBench"
+   location "MathBench"
+   kind "ConsoleApp"
+   language "C++"
+   cppdialect "C++17"
+   staticruntime "on"
+
+   targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+   objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+   
+   files
+   {
+      "%{prj.name}/src/**.h",
+      "%{prj.name}/src/**.cpp"
+   }
+
+   -- wf_math.h is header only, no need to link the engine
+   includedirs
+	{
+      "Wolf3D/src",
+      "%{IncludeDir.Glad}",
+      "%{IncludeDir.Imgui}",
+      "%{IncludeDir.external}",
+   }
+
+   filter "system:windows"
+      systemversion "latest"
+
+   filter "configurations:Debug"
+      defines "WF_DEBUG"
+      runtime "Debug"
+      symbols "on"
+
+   filter "configurations:Release"
+      defines "WF_RELEASE"
+      runtime "Release"
+      optimize "on"
+
+
+project "EcsBench"
+   location "EcsBench"
+   kind "ConsoleApp"
+   language "C++"
+   cppdialect "C++17"
+   staticruntime "on"
+
+   targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+   objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+   
+   files
+   {
+      "%{prj.name}/src/**.h",
+      "%{prj.name}/src/**.cpp"
+   }
+
+   includedirs
+	{
+      "Wolf3D/src",
+      "%{IncludeDir.Glad}",
+      "%{IncludeDir.Imgui}",
+      "%{IncludeDir.external}",
+   }
+
+   -- the engine's debug panels (profiler, memory) pull in ImGui, nothing needs SDL or GL
+   filter "system:windows"
+      systemversion "latest"
+      links
+      {
+         "Wolf3D",
+         "ImGui",
+      }
+
+   filter "system:linux"
+      links
+      {
+         "Wolf3D",
+         "ImGui",
+         "pthread"
+      }
+
+   filter "system:macosx"
+      links
+      {
+         "Wolf3D",
+         "ImGui",
+      }
+
+   filter "configurations:Debug"
+      defines "WF_DEBUG"
+      runtime "Debug"
+      symbols "on"
+
+   filter "configurations:Release"
+      defines "WF_RELEASE"
+      runtime "Release"
+      optimize "on"
+
+
+project "TextureCooker"
+   location "TextureCooker"
+   kind "ConsoleApp"
+   language "C++"
+   cppdialect "C++17"
+   staticruntime "on"
+
+   targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+   objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+   
+   files
+   {
+      "%{prj.name}/src/**.h",
+      "%{prj.name}/src/**.cpp"
+   }
+
+   -- only the header only container format of the engine is used, stb_image is compiled into the tool
+   includedirs
+	{
+      "Wolf3D/src",
+      "%{IncludeDir.Glad}",
+      "%{IncludeDir.Imgui}",
+      "%{IncludeDir.external}",
+   }
+
+   filter "system:windows"
+      systemversion "latest"
+
+   filter "configurations:Debug"
+      defines "WF_DEBUG"
+      runtime "Debug"
+      symbols "on"
+
+   filter "configurations:Release"
+      defines "WF_RELEASE"
+      runtime "Release"
+      optimize "on"
+
+
+project "AssetPacker"
+   location "AssetPacker"
+   kind "ConsoleApp"
+   language "C++"
+   cppdialect "C++17"
+   staticruntime "on"
+
+   targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+   objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+   
+   files
+   {
+      "%{prj.name}/src/**.h",
+      "%{prj.name}/src/**.cpp"
+   }
+
+   includedirs
+	{
+      "Wolf3D/src",
+      "%{IncludeDir.Glad}",
+      "%{IncludeDir.Imgui}",
+      "%{IncludeDir.external}",
+   }
+
+   -- packing only uses the header only pack format, --check runs the engine's asset registry and Vfs.
+   -- Its logger and debug panels pull in ImGui, nothing needs SDL or GL
+   filter "system:windows"
+      systemversion "latest"
+      links
+      {
+         "Wolf3D",
+         "ImGui",
+      }
+
+   filter "system:linux"
+      links
+      {
+         "Wolf3D",
+         "ImGui",
+         "pthread"
+      }
+
+   filter "system:macosx"
+      links
+      {
+         "Wolf3D",
+         "ImGui",
+      }
+
+   filter "configurations:Debug"
+      defines "WF_DEBUG"
+      runtime "Debug"
+      symbols "on"
+
+   filter "configurations:Release"
+      defines "WF_RELEASE"
+      runtime "Release"
+      optimize "on"
+
+
+project "ParserBench"
+   location "ParserBench"
+   kind "ConsoleApp"
+   language "C++"
+   cppdialect "C++17"
+   staticruntime "on"
+
+   targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+   objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+   
+   files
+   {
+      "%{prj.name}/src/**.h",
+      "%{prj.name}/src/**.cpp"
+   }
+
+   includedirs
+	{
+      "Wolf3D/src",
+      "%{IncludeDir.Glad}",
+      "%{IncludeDir.Imgui}",
+      "%{IncludeDir.external}",
+   }
+
+   -- the engine's logger and debug panels pull in ImGui, nothing needs SDL or GL
+   filter "system:windows"
+      systemversion "latest"
+      links
+      {
+         "Wolf3D",
+         "ImGui",
+      }
+
+   filter "system:linux"
+      links
+      {
+         "Wolf3D",
+         "ImGui",
+         "pthread"
+      }
+
+   filter "system:macosx"
+      links
+      {
+         "Wolf3D",
+         "ImGui",
+      }
+
+   filter "configurations:Debug"
+      defines "WF_DEBUG"
+      runtime "Debug"
+      symbols "on"
+
+   filter "configurations:Release"
+      defines "WF_RELEASE"
+      runtime "Release"
+      optimize "on"
+
+
+project "MeshCooker"
+   location "MeshCooker"
+   kind "ConsoleApp"
+   language "C++"
+   cppdialect "C++17"
+   staticruntime "on"
+
+   targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+   objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+   
+   files
+   {
+      "%{prj.name}/src/**.h",
+      "%{prj.name}/src/**.cpp"
+   }
+
+   includedirs
+	{
+      "Wolf3D/src",
+      "%{IncludeDir.Glad}",
+      "%{IncludeDir.Imgui}",
+      "%{IncludeDir.external}",
+   }
+
+   -- TextParser comes from the engine, its logger and debug panels pull in ImGui, nothing needs SDL or GL
+   filter "system:windows"
+      systemversion "latest"
+      links
+      {
+         "Wolf3D",
+         "ImGui",
+      }
+
+   filter "system:linux"
+      links
+      {
+         "Wolf3D",
+         "ImGui",
+         "pthread"
+      }
+
+   filter "system:macosx"
+      links
+      {
+         "Wolf3D",
          "ImGui",
-         "dl" --TODO: CHECK IF I NEED THIS-- 
       }
 
    filter "configurations:Debug"